@@ -6,6 +6,30 @@
 #include <vector>
 #include <sstream>
 #include <map>
+#include <cstring>
+#include <cstdint>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <algorithm>
+#include <queue>
+#include <deque>
+#include <climits>
+#include <cfloat>
+
+// SIMD 컬링 (x64는 SSE2 기본, /arch:AVX 이상이면 8개씩)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CULL_SSE
+#include <emmintrin.h>
+#endif
+#if defined(__AVX__)
+#define CULL_AVX
+#include <immintrin.h>
+#endif
 
 #define WINDOWS
 #ifdef WINDOWS 
@@ -15,6 +39,18 @@
 #endif
 #include <GL/glut.h>
 
+// 파일 메모리 매핑용 (OBJ 고속 로더)
+#ifdef _WIN32
+#include <windows.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -74,11 +110,9 @@ vector<float> piggyBBoxVertices;
 glm::vec3 cubeMinBound, cubeMaxBound;
 glm::vec3 piggyMinBound, piggyMaxBound;
 
-// 개별 물체 회전
-float cubeRotationX = 0.0f;
-float cubeRotationY = 0.0f;
-float piggyRotationX = 0.0f;
-float piggyRotationY = 0.0f;
+// 창(viewport) 크기: 픽킹, LOD 화면 크기, 인스턴스 LOD, 벤치마크가 모두 이 값을 씀 (reshape 콜백이 갱신)
+int viewportWidth = 480;
+int viewportHeight = 480;
 
 // 카메라 회전
 float cameraRotationX = 63.5f;
@@ -90,6 +124,60 @@ float cameraX = -7.2f;
 float cameraY = 20.f;
 float cameraZ = 1.3f;
 
+// ===== 카메라 상태 캐시 =====
+// View, Projection은 카메라 값(회전, 거리, 위치, far plane)이 바뀐 때만 다시 계산하고 곱과 역행렬까지 같이 저장
+// 물체 model / MVP 행렬은 배치 변환(TransformBatch)에 있고, 회전이 바뀐 물체만 / 카메라가 바뀌면 전부 다시 계산
+// renderScene(그리기, 컬링)과 pickObject가 같은 값을 씀
+
+struct CameraState {
+    glm::mat4 View;
+    glm::mat4 Projection;
+    glm::mat4 ViewProjection;
+    glm::mat4 InverseView;
+    glm::mat4 InverseProjection;
+    glm::mat4 InverseViewProjection;
+    glm::vec3 position;   // 월드 좌표 카메라 위치
+    float farPlane;
+    unsigned int version; // 다시 계산할 때마다 1씩 늘어남 (0 = 아직 계산 안 함)
+    float inputs[7];      // 마지막으로 계산한 카메라 값 (회전 2, 거리, 위치 3, far plane)
+
+    CameraState() : position(0.0f), farPlane(0.0f), version(0) { memset(inputs, 0, sizeof(inputs)); }
+};
+
+CameraState sceneCamera;
+
+// 주어진 V, P로 곱과 역행렬, 카메라 위치를 채움 (벤치마크의 lookAt 카메라도 이걸로)
+void setCameraMatrices(CameraState& camera, const glm::mat4& Projection, const glm::mat4& View, float farPlane) {
+    camera.View = View;
+    camera.Projection = Projection;
+    camera.ViewProjection = camera.Projection * camera.View;
+    camera.InverseView = glm::inverse(camera.View);
+    camera.InverseProjection = glm::inverse(camera.Projection);
+    camera.InverseViewProjection = camera.InverseView * camera.InverseProjection;
+    camera.position = glm::vec3(camera.InverseView * glm::vec4(0, 0, 0, 1));
+    camera.farPlane = farPlane;
+    camera.version++;
+}
+
+// 현재 카메라 값(전역 회전 / 거리 / 위치)으로 무조건 계산
+void buildCameraState(CameraState& camera, float farPlane) {
+    glm::mat4 View = glm::mat4(1.0f);
+    View = glm::rotate(View, glm::radians(cameraRotationX), glm::vec3(1, 0, 0));
+    View = glm::rotate(View, glm::radians(cameraRotationY), glm::vec3(0, 1, 0));
+    View = glm::translate(View, glm::vec3(-cameraX, -cameraY, -(cameraDistance + cameraZ)));
+    setCameraMatrices(camera, glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, farPlane), View, farPlane);
+
+    float inputs[7] = { cameraRotationX, cameraRotationY, cameraDistance, cameraX, cameraY, cameraZ, farPlane };
+    memcpy(camera.inputs, inputs, sizeof(inputs));
+}
+
+// 카메라 값이 마지막 계산 때와 다를 때만 다시 계산
+const CameraState& updateCameraState(CameraState& camera, float farPlane) {
+    float inputs[7] = { cameraRotationX, cameraRotationY, cameraDistance, cameraX, cameraY, cameraZ, farPlane };
+    if (camera.version == 0 || memcmp(camera.inputs, inputs, sizeof(inputs)) != 0) buildCameraState(camera, farPlane);
+    return camera;
+}
+
 // 현재 선택된 물체 (0: 없음, 1: cube, 2: piggy)
 int selectedObject = 0;
 
@@ -100,7 +188,17 @@ int lastMouseY = 0;
 
 GLuint programID;
 
-GLuint LoadShaders(const char* vertex_file_path, const char* fragment_file_path)
+// C++ 상수를 셰이더와 맞추기 위한 #define 줄을 #version 줄 바로 뒤에 끼움 (#version은 맨 앞이어야 함)
+static void insertShaderDefines(string& code, const string& defines)
+{
+	if (defines.empty()) return;
+	size_t version = code.find("#version");
+	size_t lineEnd = version == string::npos ? string::npos : code.find('\n', version);
+	if (lineEnd == string::npos) code = defines + code;
+	else code.insert(lineEnd + 1, defines);
+}
+
+GLuint LoadShaders(const char* vertex_file_path, const char* fragment_file_path, const string& defines = "")
 {
 	//create the shaders
 	GLuint VertexShaderID = glCreateShader(GL_VERTEX_SHADER);
@@ -119,6 +217,7 @@ GLuint LoadShaders(const char* vertex_file_path, const char* fragment_file_path)
 			VertexShaderCode += "\n" + Line;
 		VertexShaderStream.close();
 	}
+	insertShaderDefines(VertexShaderCode, defines);
 
 	//Compile Vertex Shader
 	printf("Compiling shader : %s\n", vertex_file_path);
@@ -147,6 +246,7 @@ GLuint LoadShaders(const char* vertex_file_path, const char* fragment_file_path)
 			FragmentShaderCode += "\n" + Line;
 		FragmentShaderStream.close();
 	}
+	insertShaderDefines(FragmentShaderCode, defines);
 
 	//Compile Fragment Shader
 	printf("Compiling shader : %s\n", fragment_file_path);
@@ -191,357 +291,7355 @@ GLuint LoadShaders(const char* vertex_file_path, const char* fragment_file_path)
     return ProgramID;
 }
 
-// Texture Loading 함수 [클로드 도움: stb_image 사용법 및 OpenGL 텍스처 설정]
-GLuint loadTexture(const char* path) {
-    int width, height, channels;
-    
-    stbi_set_flip_vertically_on_load(true); // OpenGL UV 좌표계에 맞게 위 아래를 뒤집기
-    unsigned char* data = stbi_load(path, &width, &height, &channels, 0);
-    
-    if (!data) {
-        printf("Failed to load texture: %s\n", path);
-        printf("STB Error: %s\n", stbi_failure_reason());
-        return 0;
+int loaderThreadCount() {
+    unsigned int cores = thread::hardware_concurrency();
+    return cores > 0 ? (int)cores : 1;
+}
+
+double elapsedSeconds(chrono::high_resolution_clock::time_point start) {
+    return chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+}
+
+// ===== 작업 스레드 풀 (프레임마다 쓰는 병렬 작업) =====
+// 매 프레임 std::thread를 만들고 join하면 스레드 생성 비용이 작업 자체(256줄 래스터 등)와 비슷해짐
+// 처음 쓸 때 (코어 수 - 1)개 스레드를 만들어 두고 계속 재사용. 호출한 스레드도 작업을 나눠 맡음
+// 한 풀에는 한 번에 한 호출만 (renderScene은 메인 스레드에서만 부름)
+
+struct WorkerPool {
+    vector<thread> threads;
+    mutex lock;
+    condition_variable wake;     // 새 작업이 들어옴
+    condition_variable finished; // 풀 스레드가 모두 이번 작업을 끝냄
+    const function<void(int)>* task;
+    int taskCount;
+    atomic<int> nextTask;
+    int running;                 // 이번 작업을 아직 끝내지 않은 풀 스레드 수
+    unsigned int generation;     // 작업을 넣을 때마다 증가
+    bool stopping;
+
+    WorkerPool() : task(nullptr), taskCount(0), nextTask(0), running(0), generation(0), stopping(false) {}
+    ~WorkerPool() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (size_t i = 0; i < threads.size(); i++) threads[i].join();
     }
-    
-    printf("Loaded texture: %s (%dx%d, %d channels)\n", path, width, height, channels);
-    
-    GLuint textureID;
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    
-    // 텍스처 포맷 결정
-    GLenum format;
-    if (channels == 1)
-        format = GL_RED;
-    else if (channels == 3)
-        format = GL_RGB;
-    else if (channels == 4)
-        format = GL_RGBA;
-    else {
-        printf("Unsupported channel count: %d\n", channels);
-        stbi_image_free(data);
-        return 0;
+};
+
+static void workerPoolLoop(WorkerPool* pool) {
+    unsigned int seen = 0;
+    for (;;) {
+        const function<void(int)>* task;
+        int taskCount;
+        {
+            unique_lock<mutex> guard(pool->lock);
+            pool->wake.wait(guard, [pool, seen]() { return pool->stopping || pool->generation != seen; });
+            if (pool->stopping) return;
+            seen = pool->generation;
+            task = pool->task;
+            taskCount = pool->taskCount;
+        }
+        for (int i = pool->nextTask++; i < taskCount; i = pool->nextTask++) (*task)(i);
+        lock_guard<mutex> guard(pool->lock);
+        if (--pool->running == 0) pool->finished.notify_one();
     }
-    
-    // 텍스처 데이터 업로드
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    
-    // 텍스처 필터링 설정
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    
-    // 메모리 해제
-    stbi_image_free(data);
-    
-    printf("Texture loaded successfully with ID: %d\n", textureID);
-    return textureID;
 }
 
-// mtl 파일 파싱
-bool loadMTL(const char* path, map<string, Material>& materials) {
-    ifstream file(path, ios::in);
-    if (!file.is_open()) {
-        printf("Failed to open MTL file: %s\n", path);
-        return false;
+// task(0) ~ task(taskCount - 1)을 풀 스레드와 호출한 스레드가 나눠 실행하고 다 끝날 때까지 기다림
+void parallelFor(WorkerPool& pool, int taskCount, const function<void(int)>& task) {
+    if (pool.threads.empty() && taskCount > 1)
+        for (int i = 1; i < loaderThreadCount(); i++) pool.threads.push_back(thread(workerPoolLoop, &pool));
+    if (taskCount <= 1 || pool.threads.empty()) {
+        for (int i = 0; i < taskCount; i++) task(i);
+        return;
     }
-    
-    printf("Loading MTL file: %s\n", path);
-    
-    Material* currentMaterial = nullptr;
-    string line;
-    int material_count = 0;
-    
-    while (getline(file, line) && file.good()) {
-        if (line.empty() || line[0] == '#') continue;
-        
-        stringstream ss(line);
-        string command;
-        ss >> command;
-        
-        if (command == "newmtl") {
-            string materialName;
-            ss >> materialName;
-            
-            Material newMat;
-            newMat.name = materialName;
-            materials[materialName] = newMat;
-            currentMaterial = &materials[materialName];
-            material_count++;
-            printf("Found material: %s\n", materialName.c_str());
+    {
+        lock_guard<mutex> guard(pool.lock);
+        pool.task = &task;
+        pool.taskCount = taskCount;
+        pool.nextTask = 0;
+        pool.running = (int)pool.threads.size();
+        pool.generation++;
+    }
+    pool.wake.notify_all();
+    for (int i = pool.nextTask++; i < taskCount; i = pool.nextTask++) task(i);
+    unique_lock<mutex> guard(pool.lock);
+    pool.finished.wait(guard, [&pool]() { return pool.running == 0; });
+}
+
+WorkerPool frameWorkers; // 오클루더 래스터 등 프레임마다 도는 작업용
+
+// ===== 텍스처 mip 체인 (CPU) =====
+// 레벨 0부터 2x2 박스 필터로 1x1까지 만들어서 전부 올리고 GL_LINEAR_MIPMAP_LINEAR (trilinear)로 샘플링
+// 크기가 홀수인 축은 3탭 필터 (버리는 행 / 열 없이 원본 면적을 다 나눠 가져서 2의 거듭제곱이 아닌 텍스처도 색이 밀리지 않음)
+// 색상 채널은 sRGB -> 선형으로 바꿔서 평균내고 다시 sRGB로 (감마 공간 평균은 어두워짐), 알파는 그대로 평균
+// 중간 레벨은 선형 float(RGBA 4개)로 들고 다음 레벨을 만들어서 레벨마다 다시 양자화한 오차가 쌓이지 않음
+// 한 레벨 안에서 행 구간을 스레드로 나누고, 2x2 평균은 픽셀 하나(float 4개)씩 SSE
+// glGenerateMipmap에 기대지 않으므로 소프트웨어 GL에서도 같은 결과
+
+bool generateMipmaps = true; // --no-mipmaps 로 끔 (레벨 0만, GL_LINEAR)
+
+const int MIP_MIN_ROWS_PER_THREAD = 32;
+
+struct TextureLevel {
+    int width;
+    int height;
+    vector<unsigned char> pixels; // channels개씩, 행 사이 패딩 없음
+};
+
+struct TextureMipChain {
+    int channels;
+    vector<TextureLevel> levels;
+
+    TextureMipChain() : channels(0) {}
+
+    size_t byteSize() const {
+        size_t bytes = 0;
+        for (size_t i = 0; i < levels.size(); i++) bytes += levels[i].pixels.size();
+        return bytes;
+    }
+};
+
+static float srgbToLinearTable[256];
+static unsigned char linearToSrgbTable[4097]; // 선형 값 * 4096 반올림 -> sRGB 8비트
+
+static void initSRGBTables() {
+    static bool initialized = false;
+    if (initialized) return;
+    for (int i = 0; i < 256; i++) {
+        float c = i / 255.0f;
+        srgbToLinearTable[i] = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+    }
+    for (int i = 0; i <= 4096; i++) {
+        float l = i / 4096.0f;
+        float c = l <= 0.0031308f ? l * 12.92f : 1.055f * powf(l, 1.0f / 2.4f) - 0.055f;
+        linearToSrgbTable[i] = (unsigned char)min(255.0f, c * 255.0f + 0.5f);
+    }
+    initialized = true;
+}
+
+// 채널 수 1/3: 전부 색상, 2/4: 마지막 채널은 알파 (선형)
+static inline bool isAlphaChannel(int channel, int channels) {
+    return (channels == 2 || channels == 4) && channel == channels - 1;
+}
+
+// 8비트 행 하나를 선형 RGBA float로 (없는 채널은 0)
+static void decodeTextureRow(const unsigned char* row, int width, int channels, float* out) {
+    for (int x = 0; x < width; x++) {
+        for (int c = 0; c < 4; c++) {
+            if (c >= channels) { out[x * 4 + c] = 0.0f; continue; }
+            unsigned char value = row[x * channels + c];
+            out[x * 4 + c] = isAlphaChannel(c, channels) ? value / 255.0f : srgbToLinearTable[value];
         }
-        else if (currentMaterial != nullptr) {
-            if (command == "Ka") {
-                // Ambient color
-                float r, g, b;
-                if (ss >> r >> g >> b) {
-                    currentMaterial->ambient = glm::vec3(r, g, b);
-                }
-            }
-            else if (command == "Kd") {
-                // Diffuse color (main color)
-                float r, g, b;
-                if (ss >> r >> g >> b) {
-                    currentMaterial->diffuse = glm::vec3(r, g, b);
-                    printf("Material %s diffuse: (%.3f, %.3f, %.3f)\n", 
-                           currentMaterial->name.c_str(), r, g, b);
-                }
-            }
-            else if (command == "Ks") {
-                // Specular color
-                float r, g, b;
-                if (ss >> r >> g >> b) {
-                    currentMaterial->specular = glm::vec3(r, g, b);
-                }
-            }
-            else if (command == "Ns") {
-                // Shininess
-                float ns;
-                if (ss >> ns) {
-                    currentMaterial->shininess = ns;
-                }
-            }
-            else if (command == "map_Kd") {
-                // Texture map
-                string texturePath;
-                ss >> texturePath;
-                currentMaterial->texture_map = texturePath;
-                printf("Material %s texture: %s\n", 
-                       currentMaterial->name.c_str(), texturePath.c_str());
-            }
+    }
+}
+
+// 선형 RGBA float 행을 8비트로
+static void encodeTextureRow(const float* row, int width, int channels, unsigned char* out) {
+    for (int x = 0; x < width; x++) {
+        for (int c = 0; c < channels; c++) {
+            float value = min(max(row[x * 4 + c], 0.0f), 1.0f);
+            out[x * channels + c] = isAlphaChannel(c, channels) ? (unsigned char)(value * 255.0f + 0.5f) : linearToSrgbTable[(int)(value * 4096.0f + 0.5f)];
         }
     }
-    
-    file.close();
-    printf("MTL file loaded: %d materials\n", material_count);
-    return true;
 }
 
-// OBJ 파일 파싱
-bool loadOBJ(const char* path, vector<float>& vertices, vector<unsigned int>& indices, glm::vec3& actualColor, glm::vec3* centerOffset = nullptr) {
-    vector<glm::vec3> temp_vertices;
-    vector<glm::vec2> temp_texcoords;
-    vector<unsigned int> temp_indices;
-    
-    // 최종 정점 데이터 [클로드 도움: 인터리브 방식 정점 버퍼 구성법] (position + texcoord 인터리브)
-    vector<float> final_vertices;
-    
-    ifstream file(path, ios::in);
-    if (!file.is_open()) {
-        printf("Failed to open file: %s\n", path);
-        return false;
+// 한 축의 필터 탭: 원본 크기 2n -> n은 (2i, 2i+1)을 1/2씩, 2n+1 -> n은 (2i, 2i+1, 2i+2)를 (n-i, n, i+1) / (2n+1)로, 1 -> 1은 그대로
+struct MipTaps {
+    int index[3];
+    float weight[3];
+};
+
+static MipTaps mipTaps(int sourceSize, int size, int i) {
+    MipTaps taps;
+    if (sourceSize == 1) {
+        for (int k = 0; k < 3; k++) { taps.index[k] = 0; taps.weight[k] = k == 0 ? 1.0f : 0.0f; }
+    } else if (sourceSize % 2 == 0) {
+        taps.index[0] = 2 * i; taps.index[1] = taps.index[2] = 2 * i + 1;
+        taps.weight[0] = taps.weight[1] = 0.5f; taps.weight[2] = 0.0f;
+    } else {
+        float scale = 1.0f / sourceSize;
+        for (int k = 0; k < 3; k++) taps.index[k] = 2 * i + k;
+        taps.weight[0] = (size - i) * scale; taps.weight[1] = size * scale; taps.weight[2] = (i + 1) * scale;
     }
-    
-    printf("Loading OBJ file: %s\n", path);
-    
-    string line;
-    int vertex_count = 0, texcoord_count = 0, face_count = 0;
-    string currentMaterial = "";
-    string mtlFile = "";
-    
-    // 첫 번째: 정점과 텍스처 좌표 데이터 수집 + MTL 파일 로드
-    while (getline(file, line) && file.good()) {
-        if (line.empty()) continue;
-        
-        if (line.substr(0, 7) == "mtllib ") {
-            // MTL 파일 참조 발견
-            mtlFile = line.substr(7);
-            // 공백 제거
-            mtlFile.erase(mtlFile.find_last_not_of(" \t\r\n") + 1);
-            printf("Found MTL reference: %s\n", mtlFile.c_str());
-            
-            // MTL 파일 로드
-            if (loadMTL(mtlFile.c_str(), materials)) {
-                printf("Successfully loaded MTL file\n");
-            }
+    return taps;
+}
+
+// 윗 레벨 두 행 a, b(선형 RGBA)를 2x2 평균해서 out에 (두 축 다 짝수이거나 1일 때. 폭 1이면 같은 열을 두 번)
+static void downsampleRow(const float* a, const float* b, int sourceWidth, int width, float* out) {
+    for (int x = 0; x < width; x++) {
+        int x0 = min(2 * x, sourceWidth - 1), x1 = min(2 * x + 1, sourceWidth - 1);
+#ifdef CULL_SSE
+        __m128 sum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(a + x0 * 4), _mm_loadu_ps(a + x1 * 4)), _mm_add_ps(_mm_loadu_ps(b + x0 * 4), _mm_loadu_ps(b + x1 * 4)));
+        _mm_storeu_ps(out + x * 4, _mm_mul_ps(sum, _mm_set1_ps(0.25f)));
+#else
+        for (int c = 0; c < 4; c++) out[x * 4 + c] = (a[x0 * 4 + c] + a[x1 * 4 + c] + b[x0 * 4 + c] + b[x1 * 4 + c]) * 0.25f;
+#endif
+    }
+}
+
+// 홀수 크기 축이 있을 때: 윗 레벨 세 행(rowWeights 가중치)과 열 3탭으로 out에
+static void downsampleRowWeighted(const float* const rows[3], const float rowWeights[3], int sourceWidth, int width, float* out) {
+    for (int x = 0; x < width; x++) {
+        MipTaps column = mipTaps(sourceWidth, width, x);
+#ifdef CULL_SSE
+        __m128 sum = _mm_setzero_ps();
+        for (int r = 0; r < 3; r++) {
+            __m128 rowSum = _mm_setzero_ps();
+            for (int k = 0; k < 3; k++) rowSum = _mm_add_ps(rowSum, _mm_mul_ps(_mm_loadu_ps(rows[r] + column.index[k] * 4), _mm_set1_ps(column.weight[k])));
+            sum = _mm_add_ps(sum, _mm_mul_ps(rowSum, _mm_set1_ps(rowWeights[r])));
         }
-        else if (line.substr(0, 7) == "usemtl ") {
-            // Material 사용 명령
-            currentMaterial = line.substr(7);
-            currentMaterial.erase(currentMaterial.find_last_not_of(" \t\r\n") + 1);
-            printf("Using material: %s\n", currentMaterial.c_str());
-            
-            // [클로드 도움: MTL 파일에서 재질 색상을 읽어와서 actualColor에 적용]
-            if (!currentMaterial.empty() && materials.find(currentMaterial) != materials.end()) {
-                actualColor = materials[currentMaterial].diffuse;
-                printf("Loaded material color: (%.3f, %.3f, %.3f) from %s\n", 
-                       actualColor.r, actualColor.g, actualColor.b, currentMaterial.c_str());
+        _mm_storeu_ps(out + x * 4, sum);
+#else
+        for (int c = 0; c < 4; c++) {
+            float sum = 0.0f;
+            for (int r = 0; r < 3; r++) {
+                float rowSum = 0.0f;
+                for (int k = 0; k < 3; k++) rowSum += rows[r][column.index[k] * 4 + c] * column.weight[k];
+                sum += rowSum * rowWeights[r];
             }
+            out[x * 4 + c] = sum;
         }
-        else if (line.substr(0, 2) == "v ") {
-            // vertex position 파싱하고 저장
-            stringstream ss(line.substr(2));
-            float x, y, z;
-            if (ss >> x >> y >> z) {
-                temp_vertices.push_back(glm::vec3(x, y, z));
-                vertex_count++;
+#endif
+    }
+}
+
+// 윗 레벨(8비트면 source, 선형 float면 sourceLinear)에서 다음 레벨의 [rowBegin, rowEnd) 행을 만듦
+static void buildMipRows(const TextureLevel& source, const float* sourceLinear, int channels, TextureLevel& level, float* linear,
+                         int rowBegin, int rowEnd) {
+    bool oddWidth = source.width > 1 && source.width % 2 == 1, oddHeight = source.height > 1 && source.height % 2 == 1;
+    int rowTaps = oddHeight ? 3 : 2;
+    vector<float> decoded[3];
+    if (!sourceLinear)
+        for (int k = 0; k < rowTaps; k++) decoded[k].resize(source.width * 4);
+    for (int y = rowBegin; y < rowEnd; y++) {
+        MipTaps taps = mipTaps(source.height, level.height, y);
+        const float* rows[3];
+        for (int k = 0; k < rowTaps; k++) {
+            if (sourceLinear) {
+                rows[k] = sourceLinear + (size_t)taps.index[k] * source.width * 4;
+            } else {
+                decodeTextureRow(&source.pixels[(size_t)taps.index[k] * source.width * channels], source.width, channels, &decoded[k][0]);
+                rows[k] = &decoded[k][0];
             }
         }
-        else if (line.substr(0, 3) == "vt ") {
-            // Parse texture 파싱하고 저장
-            stringstream ss(line.substr(3));
-            float u, v;
-            if (ss >> u >> v) {
-                temp_texcoords.push_back(glm::vec2(u, v));
-                texcoord_count++;
+        if (rowTaps == 2) rows[2] = rows[1]; // 가중치 0
+        float* out = linear + (size_t)y * level.width * 4;
+        if (oddWidth || oddHeight) downsampleRowWeighted(rows, taps.weight, source.width, level.width, out);
+        else downsampleRow(rows[0], rows[1], source.width, level.width, out);
+        encodeTextureRow(out, level.width, channels, &level.pixels[(size_t)y * level.width * channels]);
+    }
+}
+
+// pixels(레벨 0)부터 1x1까지 mip 체인. 레벨 0도 chain에 복사해 둠
+void buildMipChain(const unsigned char* pixels, int width, int height, int channels, TextureMipChain& chain, int threadCount) {
+    initSRGBTables();
+    chain.channels = channels;
+    chain.levels.clear();
+    chain.levels.push_back(TextureLevel());
+    chain.levels[0].width = width;
+    chain.levels[0].height = height;
+    chain.levels[0].pixels.assign(pixels, pixels + (size_t)width * height * channels);
+
+    vector<float> previousLinear, linear;
+    while (chain.levels.back().width > 1 || chain.levels.back().height > 1) {
+        const TextureLevel& source = chain.levels.back();
+        TextureLevel level;
+        level.width = max(1, source.width / 2);
+        level.height = max(1, source.height / 2);
+        level.pixels.resize((size_t)level.width * level.height * channels);
+        linear.resize((size_t)level.width * level.height * 4);
+        const float* sourceLinear = previousLinear.empty() ? nullptr : &previousLinear[0];
+
+        int bands = max(1, min(threadCount, level.height / MIP_MIN_ROWS_PER_THREAD));
+        if (bands == 1) {
+            buildMipRows(source, sourceLinear, channels, level, &linear[0], 0, level.height);
+        } else {
+            vector<thread> workers;
+            for (int band = 0; band < bands; band++) {
+                int rowBegin = level.height * band / bands, rowEnd = level.height * (band + 1) / bands;
+                workers.push_back(thread([&source, sourceLinear, channels, &level, &linear, rowBegin, rowEnd]() {
+                    buildMipRows(source, sourceLinear, channels, level, &linear[0], rowBegin, rowEnd);
+                }));
             }
+            for (size_t w = 0; w < workers.size(); w++) workers[w].join();
         }
+        chain.levels.push_back(level);
+        previousLinear.swap(linear);
     }
-    
-    file.clear();
-    file.seekg(0, ios::beg);
-    
-    printf("Loaded %d vertices, %d texture coordinates\n", vertex_count, texcoord_count);
-    
-    // 인덱스를 키로 하는 정점 맵 (중복 없게)
-    map<pair<int, int>, int> vertex_map;
-    int current_vertex_index = 0;
-    
-    // 두 번째: face 데이터 처리
-    while (getline(file, line) && file.good()) {
-        if (line.empty()) continue;
-        
-        if (line.substr(0, 2) == "f ") {
-            // face (format: vertex/texture/normal) 파싱
-            stringstream ss(line.substr(2));
-            vector<int> face_vertex_indices;
-            string token;
-            
-            while (ss >> token) {
-                size_t first_slash = token.find('/');
-                size_t second_slash = token.find('/', first_slash + 1);
-                
-                int vertex_idx = -1, texcoord_idx = -1;
-                
-                if (first_slash != string::npos) {
-                    vertex_idx = stoi(token.substr(0, first_slash));
-                    
-                    if (second_slash != string::npos) {
-                        // format: vertex/texture/normal
-                        string tex_str = token.substr(first_slash + 1, second_slash - first_slash - 1);
-                        if (!tex_str.empty()) {
-                            texcoord_idx = stoi(tex_str);
-                        }
-                    } else {
-                        // format: vertex/texture
-                        string tex_str = token.substr(first_slash + 1);
-                        if (!tex_str.empty()) {
-                            texcoord_idx = stoi(tex_str);
-                        }
-                    }
+}
+
+// ===== 스테이징 링 (persistent mapped 버퍼) =====
+// GL 4.4 / ARB_buffer_storage: 한 번 매핑해 둔 버퍼(GL_MAP_PERSISTENT | COHERENT)에 CPU가 최종 데이터를 직접 쓰고,
+// 텍스처는 GL_PIXEL_UNPACK_BUFFER 오프셋으로, 정적 정점/인덱스 버퍼는 glCopyBufferSubData로 GPU가 가져감
+// -> glTexImage2D / glBufferData가 CPU 포인터에서 드라이버 메모리로 한 번 더 복사(+ RGB 재배열)하던 것이 없어지고 호출이 바로 반환
+// 구간은 링 순서로 할당하고, 제출한 구간마다 fence를 걸어서 GPU가 다 읽은 뒤에만 다시 씀
+// 할당 -> 쓰기 -> 업로드 -> fence는 메인 스레드에서 한 번에 (fence 없는 구간이 남아 뒤 구간의 회수를 막지 않도록)
+// 모자라면 이미 끝난 fence만 회수하고, GPU가 아직 읽는 중이면 기다리지 않고 CPU 포인터 경로로 (메인 스레드를 막지 않음)
+// 비동기 텍스처도 디코드가 끝나서 올릴 때 구간을 잡음
+// 지원하지 않거나 --no-staging-ring 이면 예전 경로 (CPU 포인터)
+
+bool useStagingRing = true;
+
+const size_t STAGING_RING_BYTES = (size_t)32 << 20;
+const size_t STAGING_ALIGNMENT = 16; // BC 블록 크기, 4바이트 행 정렬 둘 다 만족
+
+struct StagingRegion {
+    size_t offset;
+    size_t size;
+    GLsync fence; // 0이면 아직 제출 전 (쓰고 올리는 중)
+
+    StagingRegion() : offset(0), size(0), fence(0) {}
+};
+
+struct StagingRing {
+    GLuint buffer;
+    unsigned char* mapped;
+    size_t capacity;
+    size_t head;
+    deque<StagingRegion> inFlight; // 할당 순서 (앞이 가장 오래됨)
+    size_t uploads;
+    size_t stagedBytes;
+    size_t fallbacks; // GPU가 아직 읽는 중이라 자리가 없어서 CPU 포인터 경로로 간 횟수
+
+    StagingRing() : buffer(0), mapped(nullptr), capacity(0), head(0), uploads(0), stagedBytes(0), fallbacks(0) {}
+};
+
+StagingRing stagingRing;
+
+bool stagingRingSupported() {
+#ifdef WINDOWS
+    return GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+#else
+    return false; // macOS는 GL 4.1까지
+#endif
+}
+
+bool createStagingRing(StagingRing& ring, size_t capacity) {
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &ring.buffer);
+    glBindBuffer(GL_COPY_READ_BUFFER, ring.buffer);
+    glBufferStorage(GL_COPY_READ_BUFFER, capacity, nullptr, flags);
+    ring.mapped = (unsigned char*)glMapBufferRange(GL_COPY_READ_BUFFER, 0, capacity, flags);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    if (!ring.mapped) {
+        glDeleteBuffers(1, &ring.buffer);
+        ring.buffer = 0;
+        return false;
+    }
+    ring.capacity = capacity;
+    ring.head = 0;
+    printf("Staging ring: %.0f MB persistent mapped buffer\n", capacity / (1024.0 * 1024.0));
+    return true;
+}
+
+// 가장 오래된 구간을 돌려받음 (기다리지 않음). 제출 전이거나 GPU가 아직 읽는 중이면 false
+static bool retireOldestStaging(StagingRing& ring) {
+    StagingRegion& oldest = ring.inFlight.front();
+    if (oldest.fence == 0) return false;
+    GLenum result = glClientWaitSync(oldest.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED) return false;
+    glDeleteSync(oldest.fence);
+    ring.inFlight.pop_front();
+    return true;
+}
+
+// size바이트 구간 (메인 스레드). 링이 없거나, 너무 크거나, 겹치는 구간을 GPU가 아직 읽는 중이면 false -> 호출한 쪽은 CPU 포인터 경로
+// 받은 구간은 같은 호출 흐름 안에서 fenceStaging까지 해야 함
+bool allocateStaging(StagingRing& ring, size_t size, StagingRegion& region) {
+    if (!ring.mapped || size == 0) return false;
+    size = (size + STAGING_ALIGNMENT - 1) / STAGING_ALIGNMENT * STAGING_ALIGNMENT;
+    if (size >= ring.capacity) return false;
+    while (!ring.inFlight.empty() && retireOldestStaging(ring)) {}
+
+    // 사용 중인 범위는 가장 오래된 구간 시작(tail)부터 head까지 (끝을 넘으면 처음으로 이어짐)
+    // head가 tail을 따라잡지 않도록 같아지는 경우는 빼서, head == tail이면 항상 비어 있음
+    size_t offset = 0;
+    while (true) {
+        if (ring.inFlight.empty()) {
+            offset = 0;
+            break;
+        }
+        size_t tail = ring.inFlight.front().offset;
+        if (ring.head >= tail) {
+            if (ring.head + size <= ring.capacity) { offset = ring.head; break; }
+            if (size < tail) { offset = 0; break; }
+        } else if (ring.head + size < tail) {
+            offset = ring.head;
+            break;
+        }
+        if (!retireOldestStaging(ring)) {
+            ring.fallbacks++;
+            return false;
+        }
+    }
+
+    region = StagingRegion();
+    region.offset = offset;
+    region.size = size;
+    ring.inFlight.push_back(region);
+    ring.head = offset + size;
+    return true;
+}
+
+// region을 읽는 GL 명령을 다 넣은 뒤에 호출 (GPU가 다 읽으면 다시 쓸 수 있음)
+void fenceStaging(StagingRing& ring, const StagingRegion& region) {
+    for (size_t i = ring.inFlight.size(); i-- > 0;) {
+        if (ring.inFlight[i].offset != region.offset || ring.inFlight[i].fence != 0) continue;
+        ring.inFlight[i].fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        ring.uploads++;
+        ring.stagedBytes += region.size;
+        return;
+    }
+}
+
+// 지금 target에 바인딩된 정적 버퍼의 내용: 링에 쓰고 GPU 쪽 복사 (링에 자리가 없으면 glBufferData에 CPU 포인터)
+void uploadStaticBuffer(GLenum target, const void* data, size_t size) {
+    StagingRegion region;
+    if (!allocateStaging(stagingRing, size, region)) {
+        glBufferData(target, size, data, GL_STATIC_DRAW);
+        return;
+    }
+    memcpy(stagingRing.mapped + region.offset, data, size);
+    glBufferData(target, size, nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_READ_BUFFER, stagingRing.buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, target, region.offset, 0, size);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    fenceStaging(stagingRing, region);
+}
+
+// ===== 블록 압축 텍스처 (BC1/BC3/BC7) =====
+// mip 체인의 각 레벨을 4x4 블록 단위로 압축해서 glCompressedTexImage2D로 올림 (VRAM: RGBA8 대비 BC1 1/8, BC3/BC7 1/4)
+// BC1: 블록 색상의 주축(PCA)으로 끝점 두 개를 잡고 565 양자화 -> 인덱스 선택 -> 인덱스로 끝점 최소제곱 재계산 한 번
+// BC3: 알파는 BC4 방식 (최소/최대 + 3비트 인덱스), 색상은 BC1과 같은 블록
+// BC7: mode 6만 (RGBA 7비트 끝점 + p비트, 4비트 인덱스, 파티션 없음). 끝점 선택은 BC1과 같은 방식
+// 블록 행 구간을 스레드로 나눠서 인코딩하고, 결과는 PNG 옆 KTX2 캐시 파일에 저장 (텍스처 캐시 섹션)
+// CPU 디코더도 있어서 GPU 없이 PSNR을 잴 수 있음 (--bench-bc)
+
+enum TextureCompression {
+    TEXTURE_COMPRESSION_AUTO = -1, // 알파가 없으면 BC1, 있으면 BC3
+    TEXTURE_UNCOMPRESSED = 0,
+    TEXTURE_BC1,
+    TEXTURE_BC3,
+    TEXTURE_BC7
+};
+
+const char* TEXTURE_COMPRESSION_NAMES[] = { "none", "bc1", "bc3", "bc7" };
+
+TextureCompression textureCompression = TEXTURE_COMPRESSION_AUTO; // --texture-format none | bc1 | bc3 | bc7
+
+const int BC_MIN_BLOCK_ROWS_PER_THREAD = 8;
+
+struct CompressedLevel {
+    int width;
+    int height;
+    vector<unsigned char> blocks; // 블록 행 순서 (GL과 같이 첫 행이 t = 0)
+};
+
+struct CompressedTexture {
+    TextureCompression format;
+    int channels; // 원본 채널 수 (디코드할 때 같은 채널 수로 되돌림)
+    vector<CompressedLevel> levels;
+
+    CompressedTexture() : format(TEXTURE_UNCOMPRESSED), channels(0) {}
+
+    size_t byteSize() const {
+        size_t bytes = 0;
+        for (size_t i = 0; i < levels.size(); i++) bytes += levels[i].blocks.size();
+        return bytes;
+    }
+};
+
+TextureCompression resolveTextureCompression(TextureCompression setting, int channels) {
+    if (setting != TEXTURE_COMPRESSION_AUTO) return setting;
+    return (channels == 2 || channels == 4) ? TEXTURE_BC3 : TEXTURE_BC1;
+}
+
+static inline size_t compressedBlockBytes(TextureCompression format) {
+    return format == TEXTURE_BC1 ? 8 : 16;
+}
+
+// 비트를 LSB부터 순서대로 (bytes는 0으로 초기화돼 있어야 함)
+static inline void putBits(unsigned char* bytes, int& position, uint32_t value, int count) {
+    for (int i = 0; i < count; i++, position++)
+        if ((value >> i) & 1) bytes[position >> 3] |= (unsigned char)(1 << (position & 7));
+}
+
+static inline uint32_t getBits(const unsigned char* bytes, int& position, int count) {
+    uint32_t value = 0;
+    for (int i = 0; i < count; i++, position++) value |= (uint32_t)((bytes[position >> 3] >> (position & 7)) & 1) << i;
+    return value;
+}
+
+// 레벨의 (blockX, blockY) 블록을 RGBA 16개로 (가장자리 밖은 마지막 행/열 반복, 1채널은 회색, 알파 없으면 255)
+static void fetchBlock(const TextureLevel& level, int channels, int blockX, int blockY, unsigned char block[16][4]) {
+    for (int i = 0; i < 16; i++) {
+        int x = min(blockX * 4 + (i & 3), level.width - 1), y = min(blockY * 4 + (i >> 2), level.height - 1);
+        const unsigned char* texel = &level.pixels[((size_t)y * level.width + x) * channels];
+        if (channels <= 2) {
+            block[i][0] = block[i][1] = block[i][2] = texel[0];
+            block[i][3] = channels == 2 ? texel[1] : 255;
+        } else {
+            block[i][0] = texel[0];
+            block[i][1] = texel[1];
+            block[i][2] = texel[2];
+            block[i][3] = channels == 4 ? texel[3] : 255;
+        }
+    }
+}
+
+// 블록 값의 주축 방향으로 양 끝 (dims = 3이면 RGB, 4면 RGBA)
+static void blockEndpoints(const unsigned char block[16][4], int dims, float e0[4], float e1[4]) {
+    float mean[4] = { 0, 0, 0, 0 };
+    for (int i = 0; i < 16; i++)
+        for (int c = 0; c < dims; c++) mean[c] += block[i][c] * (1.0f / 16.0f);
+    float covariance[4][4] = {};
+    for (int i = 0; i < 16; i++)
+        for (int a = 0; a < dims; a++)
+            for (int b = 0; b < dims; b++) covariance[a][b] += (block[i][a] - mean[a]) * (block[i][b] - mean[b]);
+
+    // 거듭제곱법 (시작은 분산이 가장 큰 채널의 공분산 행, 주축과 직교한 시작을 피함)
+    int largest = 0;
+    for (int c = 1; c < dims; c++)
+        if (covariance[c][c] > covariance[largest][largest]) largest = c;
+    float axis[4] = { 0, 0, 0, 0 };
+    for (int c = 0; c < dims; c++) axis[c] = covariance[largest][c];
+    for (int iteration = 0; iteration < 8; iteration++) {
+        float next[4] = { 0, 0, 0, 0 }, length = 0.0f;
+        for (int a = 0; a < dims; a++) {
+            for (int b = 0; b < dims; b++) next[a] += covariance[a][b] * axis[b];
+            length = max(length, fabsf(next[a]));
+        }
+        if (length < 1e-6f) break;
+        for (int c = 0; c < dims; c++) axis[c] = next[c] / length;
+    }
+    float norm = 0.0f;
+    for (int c = 0; c < dims; c++) norm += axis[c] * axis[c];
+    norm = norm > 0.0f ? 1.0f / sqrtf(norm) : 0.0f;
+
+    float tMin = 0.0f, tMax = 0.0f;
+    for (int i = 0; i < 16; i++) {
+        float t = 0.0f;
+        for (int c = 0; c < dims; c++) t += (block[i][c] - mean[c]) * axis[c] * norm;
+        tMin = min(tMin, t);
+        tMax = max(tMax, t);
+    }
+    for (int c = 0; c < 4; c++) {
+        e0[c] = c < dims ? min(max(mean[c] + tMin * axis[c] * norm, 0.0f), 255.0f) : 255.0f;
+        e1[c] = c < dims ? min(max(mean[c] + tMax * axis[c] * norm, 0.0f), 255.0f) : 255.0f;
+    }
+}
+
+// 인덱스마다 보간 비율 t가 정해졌을 때 sum |(1-t)e0 + t*e1 - x|^2 최소인 끝점 (채널별로 같은 2x2 정규 방정식)
+static bool fitEndpoints(const unsigned char block[16][4], const float weights[16], int dims, float e0[4], float e1[4]) {
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f, ax[4] = { 0, 0, 0, 0 }, bx[4] = { 0, 0, 0, 0 };
+    for (int i = 0; i < 16; i++) {
+        float a = 1.0f - weights[i], b = weights[i];
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (int c = 0; c < dims; c++) {
+            ax[c] += a * block[i][c];
+            bx[c] += b * block[i][c];
+        }
+    }
+    float determinant = aa * bb - ab * ab;
+    if (fabsf(determinant) < 1e-6f) return false;
+    for (int c = 0; c < dims; c++) {
+        e0[c] = min(max((ax[c] * bb - bx[c] * ab) / determinant, 0.0f), 255.0f);
+        e1[c] = min(max((bx[c] * aa - ax[c] * ab) / determinant, 0.0f), 255.0f);
+    }
+    return true;
+}
+
+static inline uint16_t packRGB565(const float color[4]) {
+    int r = (int)(color[0] * (31.0f / 255.0f) + 0.5f), g = (int)(color[1] * (63.0f / 255.0f) + 0.5f), b = (int)(color[2] * (31.0f / 255.0f) + 0.5f);
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+static inline void unpackRGB565(uint16_t value, int rgb[3]) {
+    int r = value >> 11, g = (value >> 5) & 63, b = value & 31;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+// BC1 팔레트 (c0 > c1이거나 BC3 색상 블록이면 4색, 아니면 3색 + 투명 검정)
+static void bc1Palette(uint16_t c0, uint16_t c1, bool forceFourColor, int palette[4][4]) {
+    unpackRGB565(c0, palette[0]);
+    unpackRGB565(c1, palette[1]);
+    palette[0][3] = palette[1][3] = 255;
+    for (int c = 0; c < 3; c++) {
+        if (c0 > c1 || forceFourColor) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+        } else {
+            palette[2][c] = (palette[0][c] + palette[1][c] + 1) / 2;
+            palette[3][c] = 0;
+        }
+    }
+    palette[2][3] = 255;
+    palette[3][3] = (c0 > c1 || forceFourColor) ? 255 : 0;
+}
+
+// 색상 블록 8바이트 (항상 4색 모드로 씀: c0 > c1, 같으면 인덱스 0만)
+static void encodeBC1Block(const unsigned char block[16][4], unsigned char out[8]) {
+    static const float INDEX_WEIGHTS[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+    float e0[4], e1[4];
+    blockEndpoints(block, 3, e0, e1);
+
+    int bestError = INT_MAX;
+    for (int iteration = 0; iteration < 2; iteration++) {
+        uint16_t c0 = packRGB565(e1), c1 = packRGB565(e0);
+        if (c0 < c1) swap(c0, c1);
+        int palette[4][4];
+        bc1Palette(c0, c1, true, palette);
+        int paletteSize = c0 == c1 ? 1 : 4;
+
+        uint32_t indices = 0;
+        int error = 0;
+        float weights[16];
+        for (int i = 0; i < 16; i++) {
+            int best = 0, bestDistance = INT_MAX;
+            for (int p = 0; p < paletteSize; p++) {
+                int dr = block[i][0] - palette[p][0], dg = block[i][1] - palette[p][1], db = block[i][2] - palette[p][2];
+                int distance = dr * dr + dg * dg + db * db;
+                if (distance < bestDistance) { bestDistance = distance; best = p; }
+            }
+            indices |= (uint32_t)best << (2 * i);
+            error += bestDistance;
+            weights[i] = INDEX_WEIGHTS[best];
+        }
+        if (error < bestError) {
+            bestError = error;
+            memset(out, 0, 8);
+            int position = 0;
+            putBits(out, position, c0, 16);
+            putBits(out, position, c1, 16);
+            putBits(out, position, indices, 32);
+        }
+        // 다음 반복: 지금 인덱스에 맞춘 끝점 (e0 = c0 쪽)
+        if (bestError == 0 || paletteSize == 1) break;
+        float refinedE0[4] = { 0, 0, 0, 255 }, refinedE1[4] = { 0, 0, 0, 255 };
+        if (!fitEndpoints(block, weights, 3, refinedE0, refinedE1)) break;
+        memcpy(e1, refinedE0, sizeof(e1));
+        memcpy(e0, refinedE1, sizeof(e0));
+    }
+}
+
+// BC4 방식 알파 블록 8바이트 (a0 > a1, 8단계 보간)
+static void encodeAlphaBlock(const unsigned char block[16][4], unsigned char out[8]) {
+    int a0 = 0, a1 = 255;
+    for (int i = 0; i < 16; i++) {
+        a0 = max(a0, (int)block[i][3]);
+        a1 = min(a1, (int)block[i][3]);
+    }
+    memset(out, 0, 8);
+    out[0] = (unsigned char)a0;
+    out[1] = (unsigned char)a1;
+    if (a0 == a1) return;
+
+    int palette[8] = { a0, a1 };
+    for (int p = 2; p < 8; p++) palette[p] = ((8 - p) * a0 + (p - 1) * a1 + 3) / 7;
+    int position = 16;
+    for (int i = 0; i < 16; i++) {
+        int best = 0, bestDistance = INT_MAX;
+        for (int p = 0; p < 8; p++) {
+            int distance = abs(block[i][3] - palette[p]);
+            if (distance < bestDistance) { bestDistance = distance; best = p; }
+        }
+        putBits(out, position, (uint32_t)best, 3);
+    }
+}
+
+static const int BC7_WEIGHTS4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+// 끝점 하나를 7비트 + p비트로 (p비트는 RGBA 네 채널 공통이라 두 값 다 해 보고 오차 작은 쪽)
+static void quantizeBC7Endpoint(const float endpoint[4], int quantized[4], int& pBit) {
+    float bestError = FLT_MAX;
+    for (int p = 0; p < 2; p++) {
+        int values[4];
+        float error = 0.0f;
+        for (int c = 0; c < 4; c++) {
+            values[c] = min(max((int)floorf((endpoint[c] - p) * 0.5f + 0.5f), 0), 127);
+            float difference = endpoint[c] - (values[c] * 2 + p);
+            error += difference * difference;
+        }
+        if (error < bestError) {
+            bestError = error;
+            pBit = p;
+            memcpy(quantized, values, sizeof(values));
+        }
+    }
+}
+
+// BC7 mode 6 블록 16바이트: mode 비트 7 | R0 R1 G0 G1 B0 B1 A0 A1 각 7 | P0 P1 | 인덱스 4비트 x 16 (첫 인덱스는 MSB 생략 3비트)
+static void encodeBC7Block(const unsigned char block[16][4], unsigned char out[16]) {
+    float e0[4], e1[4];
+    blockEndpoints(block, 4, e0, e1);
+
+    int bestError = INT_MAX;
+    for (int iteration = 0; iteration < 2; iteration++) {
+        int q[2][4], pBits[2];
+        quantizeBC7Endpoint(e0, q[0], pBits[0]);
+        quantizeBC7Endpoint(e1, q[1], pBits[1]);
+        int palette[16][4];
+        for (int c = 0; c < 4; c++) {
+            int v0 = q[0][c] * 2 + pBits[0], v1 = q[1][c] * 2 + pBits[1];
+            for (int p = 0; p < 16; p++) palette[p][c] = ((64 - BC7_WEIGHTS4[p]) * v0 + BC7_WEIGHTS4[p] * v1 + 32) >> 6;
+        }
+
+        int indices[16], error = 0;
+        float weights[16];
+        for (int i = 0; i < 16; i++) {
+            int best = 0, bestDistance = INT_MAX;
+            for (int p = 0; p < 16; p++) {
+                int distance = 0;
+                for (int c = 0; c < 4; c++) distance += (block[i][c] - palette[p][c]) * (block[i][c] - palette[p][c]);
+                if (distance < bestDistance) { bestDistance = distance; best = p; }
+            }
+            indices[i] = best;
+            error += bestDistance;
+            weights[i] = BC7_WEIGHTS4[best] / 64.0f;
+        }
+        if (error < bestError) {
+            bestError = error;
+            // 첫 텍셀 인덱스의 MSB가 0이어야 함 -> 아니면 끝점을 바꾸고 인덱스를 뒤집음
+            int first = indices[0] >= 8 ? 1 : 0;
+            memset(out, 0, 16);
+            int position = 0;
+            putBits(out, position, 1u << 6, 7);
+            for (int c = 0; c < 4; c++) {
+                putBits(out, position, (uint32_t)q[first][c], 7);
+                putBits(out, position, (uint32_t)q[1 - first][c], 7);
+            }
+            putBits(out, position, (uint32_t)pBits[first], 1);
+            putBits(out, position, (uint32_t)pBits[1 - first], 1);
+            for (int i = 0; i < 16; i++) putBits(out, position, (uint32_t)(first ? 15 - indices[i] : indices[i]), i == 0 ? 3 : 4);
+        }
+        if (bestError == 0 || !fitEndpoints(block, weights, 4, e0, e1)) break;
+    }
+}
+
+static void decodeBC1Block(const unsigned char* in, bool forceFourColor, unsigned char out[16][4]) {
+    int position = 0;
+    uint16_t c0 = (uint16_t)getBits(in, position, 16), c1 = (uint16_t)getBits(in, position, 16);
+    int palette[4][4];
+    bc1Palette(c0, c1, forceFourColor, palette);
+    for (int i = 0; i < 16; i++) {
+        int index = (int)getBits(in, position, 2);
+        for (int c = 0; c < 4; c++) out[i][c] = (unsigned char)palette[index][c];
+    }
+}
+
+static void decodeAlphaBlock(const unsigned char* in, unsigned char out[16][4]) {
+    int a0 = in[0], a1 = in[1];
+    int palette[8] = { a0, a1 };
+    if (a0 > a1) {
+        for (int p = 2; p < 8; p++) palette[p] = ((8 - p) * a0 + (p - 1) * a1 + 3) / 7;
+    } else {
+        for (int p = 2; p < 6; p++) palette[p] = ((6 - p) * a0 + (p - 1) * a1 + 2) / 5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+    int position = 16;
+    for (int i = 0; i < 16; i++) out[i][3] = (unsigned char)palette[getBits(in, position, 3)];
+}
+
+// mode 6만 (인코더가 쓰는 모드). 다른 모드는 0으로
+static void decodeBC7Block(const unsigned char* in, unsigned char out[16][4]) {
+    int position = 0;
+    if (getBits(in, position, 7) != (1u << 6)) {
+        memset(out, 0, 16 * 4);
+        return;
+    }
+    int endpoints[2][4];
+    for (int c = 0; c < 4; c++) {
+        endpoints[0][c] = (int)getBits(in, position, 7) << 1;
+        endpoints[1][c] = (int)getBits(in, position, 7) << 1;
+    }
+    int p0 = (int)getBits(in, position, 1), p1 = (int)getBits(in, position, 1);
+    for (int c = 0; c < 4; c++) {
+        endpoints[0][c] |= p0;
+        endpoints[1][c] |= p1;
+    }
+    for (int i = 0; i < 16; i++) {
+        int weight = BC7_WEIGHTS4[getBits(in, position, i == 0 ? 3 : 4)];
+        for (int c = 0; c < 4; c++) out[i][c] = (unsigned char)(((64 - weight) * endpoints[0][c] + weight * endpoints[1][c] + 32) >> 6);
+    }
+}
+
+static void compressBlockRows(const TextureLevel& level, int channels, TextureCompression format, CompressedLevel& out, int rowBegin, int rowEnd) {
+    int blocksX = (level.width + 3) / 4;
+    size_t blockBytes = compressedBlockBytes(format);
+    unsigned char block[16][4];
+    for (int by = rowBegin; by < rowEnd; by++) {
+        for (int bx = 0; bx < blocksX; bx++) {
+            fetchBlock(level, channels, bx, by, block);
+            unsigned char* target = &out.blocks[((size_t)by * blocksX + bx) * blockBytes];
+            if (format == TEXTURE_BC1) {
+                encodeBC1Block(block, target);
+            } else if (format == TEXTURE_BC3) {
+                encodeAlphaBlock(block, target);
+                encodeBC1Block(block, target + 8);
+            } else {
+                encodeBC7Block(block, target);
+            }
+        }
+    }
+}
+
+// mip 체인 전체를 format으로 압축 (레벨마다 블록 행 구간을 스레드로 나눔)
+void compressMipChain(const TextureMipChain& chain, TextureCompression format, CompressedTexture& texture, int threadCount) {
+    texture.format = format;
+    texture.channels = chain.channels;
+    texture.levels.assign(chain.levels.size(), CompressedLevel());
+    for (size_t index = 0; index < chain.levels.size(); index++) {
+        const TextureLevel& level = chain.levels[index];
+        CompressedLevel& out = texture.levels[index];
+        out.width = level.width;
+        out.height = level.height;
+        int blockRows = (level.height + 3) / 4;
+        out.blocks.assign((size_t)((level.width + 3) / 4) * blockRows * compressedBlockBytes(format), 0);
+
+        int bands = max(1, min(threadCount, blockRows / BC_MIN_BLOCK_ROWS_PER_THREAD));
+        if (bands == 1) {
+            compressBlockRows(level, chain.channels, format, out, 0, blockRows);
+            continue;
+        }
+        vector<thread> workers;
+        for (int band = 0; band < bands; band++) {
+            int rowBegin = blockRows * band / bands, rowEnd = blockRows * (band + 1) / bands;
+            workers.push_back(thread([&level, &chain, format, &out, rowBegin, rowEnd]() {
+                compressBlockRows(level, chain.channels, format, out, rowBegin, rowEnd);
+            }));
+        }
+        for (size_t w = 0; w < workers.size(); w++) workers[w].join();
+    }
+}
+
+// 압축 레벨 하나를 원본 채널 수의 8비트 픽셀로 (PSNR 측정용)
+void decompressLevel(const CompressedLevel& level, TextureCompression format, int channels, TextureLevel& out) {
+    out.width = level.width;
+    out.height = level.height;
+    out.pixels.resize((size_t)level.width * level.height * channels);
+    int blocksX = (level.width + 3) / 4, blocksY = (level.height + 3) / 4;
+    size_t blockBytes = compressedBlockBytes(format);
+    unsigned char block[16][4];
+    for (int by = 0; by < blocksY; by++) {
+        for (int bx = 0; bx < blocksX; bx++) {
+            const unsigned char* source = &level.blocks[((size_t)by * blocksX + bx) * blockBytes];
+            if (format == TEXTURE_BC1) {
+                decodeBC1Block(source, false, block);
+            } else if (format == TEXTURE_BC3) {
+                decodeBC1Block(source + 8, true, block);
+                decodeAlphaBlock(source, block);
+            } else {
+                decodeBC7Block(source, block);
+            }
+            for (int i = 0; i < 16; i++) {
+                int x = bx * 4 + (i & 3), y = by * 4 + (i >> 2);
+                if (x >= level.width || y >= level.height) continue;
+                unsigned char* texel = &out.pixels[((size_t)y * level.width + x) * channels];
+                if (channels <= 2) {
+                    texel[0] = block[i][0];
+                    if (channels == 2) texel[1] = block[i][3];
                 } else {
-                    // format: vertex only
-                    vertex_idx = stoi(token);
-                }
-                
-                // [클로드 도움: OBJ 파일 파싱 시 인덱스 유효성 검증]
-                if (vertex_idx < 1 || vertex_idx > vertex_count) {
-                    printf("Invalid vertex index: %d (max: %d) in face line: %s\n", vertex_idx, vertex_count, line.c_str());
-                    face_vertex_indices.clear();
-                    break;
+                    for (int c = 0; c < channels; c++) texel[c] = block[i][c];
                 }
-                
-                if (texcoord_idx != -1 && (texcoord_idx < 1 || texcoord_idx > texcoord_count)) {
-                    printf("Invalid texture coordinate index: %d (max: %d) in face line: %s\n", texcoord_idx, texcoord_count, line.c_str());
-                    texcoord_idx = -1; // 잘못된 텍스처 인덱스는 무시
+            }
+        }
+    }
+}
+
+bool textureCompressionSupported(TextureCompression format) {
+#ifdef WINDOWS
+    if (format == TEXTURE_BC7) return GLEW_VERSION_4_2 || GLEW_ARB_texture_compression_bptc;
+    return GLEW_EXT_texture_compression_s3tc;
+#else
+    return false; // macOS 경로는 비압축 업로드
+#endif
+}
+
+static GLenum compressedGLFormat(TextureCompression format) {
+    if (format == TEXTURE_BC1) return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    if (format == TEXTURE_BC3) return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    return GL_COMPRESSED_RGBA_BPTC_UNORM;
+}
+
+// 올릴 레벨 하나 (data는 DecodedTexture가 가진 저장소 중 하나를 가리킴)
+struct TextureLevelData {
+    int width;
+    int height;
+    const unsigned char* data;
+    size_t size;
+};
+
+struct MappedFile; // OBJ 고속 로더 섹션
+
+// 디코드 결과 (GL에 올리기 직전 상태). format이 TEXTURE_UNCOMPRESSED면 channels개 8비트 텍셀, 아니면 블록
+// 레벨 데이터는 방금 만든 mips / compressed, 또는 매핑한 텍스처 캐시 파일을 그대로 가리킴 (복사 없음)
+// levels가 저장소를 가리키므로 복사하지 말 것 (이동은 버퍼가 그대로라 괜찮음)
+struct DecodedTexture {
+    TextureCompression format;
+    int channels;
+    vector<TextureLevelData> levels; // 레벨 0부터
+    TextureMipChain mips;
+    CompressedTexture compressed;
+    shared_ptr<MappedFile> mapping; // 마지막 참조가 사라질 때 unmap
+
+    DecodedTexture() : format(TEXTURE_UNCOMPRESSED), channels(0) {}
+    // levels가 mips / compressed의 힙 버퍼를 가리킴: 복사하면 원본이 사라질 때 끊기므로 막고, 이동은 버퍼째 옮겨서 그대로 유효
+    DecodedTexture(const DecodedTexture&) = delete;
+    DecodedTexture& operator=(const DecodedTexture&) = delete;
+    DecodedTexture(DecodedTexture&&) = default;
+    DecodedTexture& operator=(DecodedTexture&&) = default;
+};
+
+// 올릴 포맷 결정 (GL 확장을 보므로 메인 스레드에서)
+TextureCompression chooseTextureCompression(const char* path) {
+    int width, height, channels;
+    if (textureCompression == TEXTURE_UNCOMPRESSED || !stbi_info(path, &width, &height, &channels)) return TEXTURE_UNCOMPRESSED;
+    TextureCompression format = resolveTextureCompression(textureCompression, channels);
+    if (textureCompressionSupported(format)) return format;
+    printf("%s not supported by this GL, uploading uncompressed\n", TEXTURE_COMPRESSION_NAMES[format]);
+    return TEXTURE_UNCOMPRESSED;
+}
+
+// 텍스처 캐시 섹션 (메시 캐시의 파일 해시/매핑 함수를 씀): 캐시가 유효하면 매핑, 아니면 PNG 디코드 + mip (+ 인코딩) 후 저장
+// GL 호출 없음 -> 작업 스레드에서 돌릴 수 있음. threadCount: mip / 인코딩 스레드 수 (이미 스레드 풀 안이면 1)
+bool decodeTexture(const char* path, TextureCompression format, DecodedTexture& texture, int threadCount = loaderThreadCount());
+
+// 바인딩된 텍스처의 레벨 범위와 필터 (levelCount > 1이면 trilinear)
+static void setTextureLevelParameters(size_t levelCount) {
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)levelCount - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    
+    // 텍스처 필터링 설정
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+}
+
+// 디코드 결과를 CPU 포인터에서 textureID에 레벨별로 올림 (메인 스레드, generateMipmaps가 꺼져 있으면 레벨 0만)
+void uploadDecodedTexture(GLuint textureID, const DecodedTexture& texture) {
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    size_t levelCount = generateMipmaps ? texture.levels.size() : 1;
+    if (texture.format != TEXTURE_UNCOMPRESSED) {
+        GLenum internalFormat = compressedGLFormat(texture.format);
+        for (size_t level = 0; level < levelCount; level++) {
+            const TextureLevelData& mip = texture.levels[level];
+            glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)level, internalFormat, mip.width, mip.height, 0, (GLsizei)mip.size, mip.data);
+        }
+    } else {
+        // 텍스처 포맷 결정
+        GLenum format = texture.channels == 1 ? GL_RED : (texture.channels == 3 ? GL_RGB : GL_RGBA);
+
+        // 텍스처 데이터 업로드 (RGB는 행 길이가 4의 배수가 아닐 수 있어서 1바이트 정렬)
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for (size_t level = 0; level < levelCount; level++) {
+            const TextureLevelData& mip = texture.levels[level];
+            glTexImage2D(GL_TEXTURE_2D, (GLint)level, format, mip.width, mip.height, 0, format, GL_UNSIGNED_BYTE, mip.data);
+        }
+    }
+    setTextureLevelParameters(levelCount);
+
+    size_t uploaded = 0, rgba8 = 0;
+    for (size_t level = 0; level < levelCount; level++) {
+        uploaded += texture.levels[level].size;
+        rgba8 += (size_t)texture.levels[level].width * texture.levels[level].height * 4;
+    }
+    printf("Uploaded texture %s: %zu levels, %.2f MB (RGBA8 %.2f MB)\n", TEXTURE_COMPRESSION_NAMES[texture.format], levelCount,
+           uploaded / (1024.0 * 1024.0), rgba8 / (1024.0 * 1024.0));
+}
+
+// 스테이징 링에 올릴 텍스처 배치 (레벨마다 구간 안 오프셋)
+// 비압축 RGB는 RGBA로 넓혀서 씀: GPU 내부 포맷과 같은 4바이트 텍셀이라 드라이버가 재배열하지 않고 행도 항상 4바이트 정렬
+// 1채널은 행 끝을 4바이트로 채워서 기본 GL_UNPACK_ALIGNMENT(4) 그대로
+struct StagedLevel {
+    int width;
+    int height;
+    size_t offset;
+    size_t rowPitch; // 비압축만
+    size_t size;
+};
+
+struct StagedTexture {
+    TextureCompression format;
+    int sourceChannels;
+    int channels; // 스테이징 안의 채널 수 (RGB -> 4)
+    vector<StagedLevel> levels;
+    size_t byteSize;
+    StagingRegion region; // size가 0이면 링에 자리를 못 받음
+
+    StagedTexture() : format(TEXTURE_UNCOMPRESSED), sourceChannels(0), channels(0), byteSize(0) {}
+};
+
+static int mipLevelCount(int width, int height) {
+    int levels = 1;
+    while (width > 1 || height > 1) {
+        width = max(1, width / 2);
+        height = max(1, height / 2);
+        levels++;
+    }
+    return levels;
+}
+
+// 올릴 레벨 수(generateMipmaps)와 크기만으로 배치를 정함 (디코드 전에 구간을 예약할 수 있게)
+void planStagedTexture(TextureCompression format, int channels, int width, int height, StagedTexture& staged) {
+    staged.format = format;
+    staged.sourceChannels = channels;
+    staged.channels = (format == TEXTURE_UNCOMPRESSED && channels == 3) ? 4 : channels;
+    staged.levels.clear();
+    staged.byteSize = 0;
+    int levelCount = generateMipmaps ? mipLevelCount(width, height) : 1;
+    for (int i = 0; i < levelCount; i++) {
+        StagedLevel level;
+        level.width = max(1, width >> i);
+        level.height = max(1, height >> i);
+        level.offset = staged.byteSize;
+        if (format == TEXTURE_UNCOMPRESSED) {
+            level.rowPitch = ((size_t)level.width * staged.channels + 3) & ~(size_t)3;
+            level.size = level.rowPitch * level.height;
+        } else {
+            level.rowPitch = 0;
+            level.size = (size_t)((level.width + 3) / 4) * ((level.height + 3) / 4) * compressedBlockBytes(format);
+        }
+        staged.byteSize = (level.offset + level.size + STAGING_ALIGNMENT - 1) / STAGING_ALIGNMENT * STAGING_ALIGNMENT;
+        staged.levels.push_back(level);
+    }
+}
+
+// 디코드 결과를 배치대로 destination(매핑된 링)에 씀. GL 호출 없음 -> 작업 스레드에서. 크기가 계획과 다르면 false
+bool writeStagedTexture(const DecodedTexture& texture, const StagedTexture& staged, unsigned char* destination) {
+    if (texture.format != staged.format || texture.channels != staged.sourceChannels || texture.levels.size() < staged.levels.size())
+        return false;
+    for (size_t i = 0; i < staged.levels.size(); i++) {
+        const StagedLevel& level = staged.levels[i];
+        const TextureLevelData& source = texture.levels[i];
+        if (source.width != level.width || source.height != level.height) return false;
+        unsigned char* target = destination + level.offset;
+        if (staged.format != TEXTURE_UNCOMPRESSED) {
+            memcpy(target, source.data, level.size);
+            continue;
+        }
+        size_t sourcePitch = (size_t)level.width * staged.sourceChannels;
+        for (int y = 0; y < level.height; y++) {
+            const unsigned char* row = source.data + (size_t)y * sourcePitch;
+            unsigned char* out = target + (size_t)y * level.rowPitch;
+            if (staged.sourceChannels == 3) {
+                for (int x = 0; x < level.width; x++) {
+                    out[x * 4 + 0] = row[x * 3 + 0];
+                    out[x * 4 + 1] = row[x * 3 + 1];
+                    out[x * 4 + 2] = row[x * 3 + 2];
+                    out[x * 4 + 3] = 255;
                 }
-                
-                // 정점-텍스처 조합을 키로 사용
-                pair<int, int> vertex_key = make_pair(vertex_idx - 1, texcoord_idx - 1);
-                
-                // 이미 존재하는 정점-텍스처 조합인지 확인
-                if (vertex_map.find(vertex_key) == vertex_map.end()) {
-                    // 새로운 조합이면 추가
-                    vertex_map[vertex_key] = current_vertex_index;
-                    
-                    // 정점 위치 추가
-                    glm::vec3 pos = temp_vertices[vertex_idx - 1];
-                    final_vertices.push_back(pos.x);
-                    final_vertices.push_back(pos.y);
-                    final_vertices.push_back(pos.z);
-                    
-                    // 텍스처 좌표 추가
-                    if (texcoord_idx != -1 && texcoord_idx - 1 < temp_texcoords.size()) {
-                        glm::vec2 tex = temp_texcoords[texcoord_idx - 1];
-                        final_vertices.push_back(tex.x);
-                        final_vertices.push_back(tex.y);
-                    } else {
-                        // 기본 텍스처 좌표
-                        final_vertices.push_back(0.0f);
-                        final_vertices.push_back(0.0f);
+            } else {
+                memcpy(out, row, sourcePitch);
+            }
+        }
+    }
+    return true;
+}
+
+// 링에 써 둔 텍스처를 PBO 오프셋으로 올리고 fence (메인 스레드). 호출이 바로 반환되고 복사는 GPU가
+void uploadStagedTexture(GLuint textureID, const StagedTexture& staged) {
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, stagingRing.buffer);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    for (size_t i = 0; i < staged.levels.size(); i++) {
+        const StagedLevel& level = staged.levels[i];
+        const void* offset = (const void*)(staged.region.offset + level.offset);
+        if (staged.format != TEXTURE_UNCOMPRESSED) {
+            glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)i, compressedGLFormat(staged.format), level.width, level.height, 0, (GLsizei)level.size, offset);
+        } else {
+            GLenum internalFormat = staged.sourceChannels == 1 ? GL_RED : (staged.sourceChannels == 3 ? GL_RGB : GL_RGBA);
+            GLenum format = staged.channels == 1 ? GL_RED : GL_RGBA;
+            glTexImage2D(GL_TEXTURE_2D, (GLint)i, internalFormat, level.width, level.height, 0, format, GL_UNSIGNED_BYTE, offset);
+        }
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0); // 다른 업로드가 포인터를 오프셋으로 읽지 않도록
+    fenceStaging(stagingRing, staged.region);
+    setTextureLevelParameters(staged.levels.size());
+    printf("Uploaded texture %s through staging ring: %zu levels, %.2f MB\n", TEXTURE_COMPRESSION_NAMES[staged.format], staged.levels.size(),
+           staged.byteSize / (1024.0 * 1024.0));
+}
+
+// 메인 스레드에서 디코드한 텍스처를 링에 써서 올림. 링에 자리가 없으면 false (CPU 포인터 경로로)
+bool uploadThroughStaging(GLuint textureID, const DecodedTexture& texture) {
+    if (texture.levels.empty()) return false;
+    StagedTexture staged;
+    planStagedTexture(texture.format, texture.channels, texture.levels[0].width, texture.levels[0].height, staged);
+    if (!allocateStaging(stagingRing, staged.byteSize, staged.region)) return false;
+    if (!writeStagedTexture(texture, staged, stagingRing.mapped + staged.region.offset)) {
+        fenceStaging(stagingRing, staged.region); // 쓰지 않은 구간도 돌려줌
+        return false;
+    }
+    uploadStagedTexture(textureID, staged);
+    return true;
+}
+
+// Texture Loading 함수 [클로드 도움: stb_image 사용법 및 OpenGL 텍스처 설정]
+// 디코드와 업로드를 그 자리에서 (비동기 디코드가 꺼져 있거나 map_Kd 없이 직접 부를 때)
+GLuint loadTexture(const char* path) {
+    DecodedTexture decoded;
+    if (!decodeTexture(path, chooseTextureCompression(path), decoded)) return 0;
+
+    GLuint textureID;
+    glGenTextures(1, &textureID);
+    if (!uploadThroughStaging(textureID, decoded)) uploadDecodedTexture(textureID, decoded);
+    
+    printf("Texture loaded successfully with ID: %d\n", textureID);
+    return textureID;
+}
+
+// ===== 텍스처 배열 아틀라스 =====
+// 재질마다 텍스처 이름이 따로면 재질이 바뀔 때마다 glBindTexture가 필요하고, 풀 경로는 텍스처마다 multi-draw를 나눠야 함
+// 작은/중간 크기 map_Kd(ATLAS_MAX_ENTRY_SIZE 이하)를 GL_TEXTURE_2D_ARRAY 하나의 레이어들에 선반(shelf) 방식으로 채우고,
+// 재질은 (레이어 번호, 레이어 안 영역 scale/offset)만 가짐 -> 아틀라스 재질끼리는 바인딩 없이 uniform / 풀 draw 데이터만 다름
+// 셰이더는 UV를 fract로 영역 안에서 반복하고 미분은 fract 전 UV로 (textureGrad) -> 반복 이음새에서 mip이 튀지 않음
+// 영역 둘레 ATLAS_PADDING 텍셀은 반대쪽 가장자리 텍셀(wrap)이라 bilinear가 이웃 영역을 읽지 않음
+// mip은 텍스처마다 자기 체인을 같은 비율로 줄인 자리에 넣고, 여백이 1텍셀 이상 남는 레벨까지만 씀
+// 레이어 크기와 같은 방향은 여백 없이 레이어 폭(높이) 전체를 씀 (그 방향 반복은 배열 텍스처의 GL_REPEAT)
+// 아틀라스는 RGBA8이라 큰 텍스처는 넣지 않고 재질마다 자기 텍스처(블록 압축 그대로). --no-texture-atlas 이면 전부 자기 텍스처
+
+bool useTextureAtlas = true; // --no-texture-atlas 로 끔
+
+const int ATLAS_MAX_ENTRY_SIZE = 1024; // 가로 세로 둘 다 이 이하인 텍스처만
+const int ATLAS_MIN_LAYER_SIZE = 64;
+const int ATLAS_MAX_LAYER_SIZE = 2048;
+const int ATLAS_MAX_LAYERS = 256;      // GL 3.0 이상이 보장하는 GL_MAX_ARRAY_TEXTURE_LAYERS
+const int ATLAS_PADDING = 16;          // 자리도 이 단위로 맞춤 -> 레벨 4까지 위치가 정확히 절반씩
+const int ATLAS_MAX_LEVELS = 5;        // 여백 16 -> 1텍셀이 되는 레벨 4까지
+
+// 아틀라스 안 텍스처 하나
+struct AtlasEntry {
+    string path;
+    int width;
+    int height;
+    int layer;      // -1이면 못 넣음
+    int x;          // 여백 포함 자리의 왼쪽 아래 (레벨 0 텍셀, 위 아래는 디코드할 때 이미 뒤집힘)
+    int y;
+    int paddingX;   // 레이어 폭 전체를 쓰면 0
+    int paddingY;
+    glm::vec4 rect; // xy: scale, zw: offset (영역 UV 0~1 -> 레이어 UV)
+
+    AtlasEntry() : width(0), height(0), layer(-1), x(0), y(0), paddingX(0), paddingY(0), rect(1.0f, 1.0f, 0.0f, 0.0f) {}
+};
+
+struct TextureAtlas {
+    GLuint textureID; // GL_TEXTURE_2D_ARRAY, 0이면 아틀라스 없음
+    int layerSize;
+    int layers;
+    int levels;
+    vector<AtlasEntry> entries;
+    map<string, size_t> entryIndex; // path -> entries 번호 (올라간 것만)
+
+    TextureAtlas() : textureID(0), layerSize(0), layers(0), levels(0) {}
+};
+
+TextureAtlas textureAtlas;
+
+// planTextureAtlas가 아틀라스에 넣기로 한 텍스처인지 (빌드 전에도 씀)
+bool isPlannedAtlasEntry(const TextureAtlas& atlas, const string& path) {
+    for (size_t i = 0; i < atlas.entries.size(); i++)
+        if (atlas.entries[i].path == path) return true;
+    return false;
+}
+
+// 아틀라스에 넣을 크기인지 (PNG 헤더만 읽음). 크기가 16의 배수가 아니면 mip 레벨 4까지 영역이 정확히 절반이 안 돼서 따로
+bool isAtlasCandidate(const string& path, int& width, int& height) {
+    int channels;
+    if (!stbi_info(path.c_str(), &width, &height, &channels) || channels == 2) return false;
+    int alignment = 1 << (ATLAS_MAX_LEVELS - 1);
+    return width <= ATLAS_MAX_ENTRY_SIZE && height <= ATLAS_MAX_ENTRY_SIZE && width % alignment == 0 && height % alignment == 0;
+}
+
+// 여백 포함 자리 크기 (레이어 크기와 같으면 여백 없이 그대로)
+static int atlasSlotSize(int size, int layerSize) {
+    if (size == layerSize) return size;
+    return (size + 2 * ATLAS_PADDING + ATLAS_PADDING - 1) / ATLAS_PADDING * ATLAS_PADDING;
+}
+
+// 선반 채우기: 자리 높이 순으로 정렬해서, 들어가는 첫 선반의 오른쪽에 넣거나 어느 레이어든 위에 새 선반을 쌓음
+// 반환값: 쓴 레이어 수 (못 넣은 것은 layer -1)
+int packTextureAtlas(vector<AtlasEntry>& entries, int layerSize) {
+    struct Shelf {
+        int layer;
+        int y;
+        int height;
+        int x; // 다음 자리
+    };
+    vector<size_t> order(entries.size());
+    for (size_t i = 0; i < order.size(); i++) order[i] = i;
+    stable_sort(order.begin(), order.end(), [&entries](size_t a, size_t b) {
+        if (entries[a].height != entries[b].height) return entries[a].height > entries[b].height;
+        return entries[a].width > entries[b].width;
+    });
+
+    vector<Shelf> shelves;
+    vector<int> layerTops; // 레이어마다 쌓인 선반 높이
+    for (size_t i = 0; i < order.size(); i++) {
+        AtlasEntry& entry = entries[order[i]];
+        entry.layer = -1;
+        int slotWidth = atlasSlotSize(entry.width, layerSize), slotHeight = atlasSlotSize(entry.height, layerSize);
+        if (slotWidth > layerSize || slotHeight > layerSize) continue;
+
+        Shelf* shelf = nullptr;
+        for (size_t s = 0; s < shelves.size() && !shelf; s++)
+            if (shelves[s].height >= slotHeight && shelves[s].x + slotWidth <= layerSize) shelf = &shelves[s];
+        if (!shelf) {
+            int layer = 0;
+            while (layer < (int)layerTops.size() && layerTops[layer] + slotHeight > layerSize) layer++;
+            if (layer == (int)layerTops.size()) {
+                if (layer >= ATLAS_MAX_LAYERS) continue;
+                layerTops.push_back(0);
+            }
+            Shelf created = { layer, layerTops[layer], slotHeight, 0 };
+            layerTops[layer] += slotHeight;
+            shelves.push_back(created);
+            shelf = &shelves.back();
+        }
+        entry.layer = shelf->layer;
+        entry.x = shelf->x;
+        entry.y = shelf->y;
+        entry.paddingX = slotWidth == entry.width ? 0 : ATLAS_PADDING;
+        entry.paddingY = slotHeight == entry.height ? 0 : ATLAS_PADDING;
+        shelf->x += slotWidth;
+        entry.rect = glm::vec4((float)entry.width / layerSize, (float)entry.height / layerSize, (float)(entry.x + entry.paddingX) / layerSize,
+                               (float)(entry.y + entry.paddingY) / layerSize);
+    }
+    return (int)layerTops.size();
+}
+
+// 넣는 텍스처가 가장 많고, 그다음 전체 텍셀 수(레이어 수 * 크기^2)가 가장 작은 레이어 크기로 채움. 반환값: 레이어 크기
+int packTextureAtlasBestSize(vector<AtlasEntry>& entries, int& layers) {
+    int bestSize = 0, bestPlaced = -1;
+    uint64_t bestTexels = 0;
+    for (int size = ATLAS_MIN_LAYER_SIZE; size <= ATLAS_MAX_LAYER_SIZE; size *= 2) {
+        int used = packTextureAtlas(entries, size), placed = 0;
+        for (size_t i = 0; i < entries.size(); i++) placed += entries[i].layer >= 0 ? 1 : 0;
+        uint64_t texels = (uint64_t)used * size * size;
+        if (placed > bestPlaced || (placed == bestPlaced && texels < bestTexels)) {
+            bestSize = size;
+            bestPlaced = placed;
+            bestTexels = texels;
+        }
+    }
+    layers = packTextureAtlas(entries, bestSize);
+    return bestSize;
+}
+
+// 쓸 mip 레벨 수: 여백이 남는 레벨까지, 그리고 모든 텍스처 크기가 2^(레벨)로 나눠떨어지는 레벨까지 (영역이 정확히 절반씩)
+int atlasLevelCount(const vector<AtlasEntry>& entries) {
+    int levels = generateMipmaps ? ATLAS_MAX_LEVELS : 1;
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (entries[i].layer < 0) continue;
+        while (levels > 1 && ((entries[i].width | entries[i].height) & ((1 << (levels - 1)) - 1)) != 0) levels--;
+    }
+    return levels;
+}
+
+// 텍스처 하나의 레벨 level을 자기 자리에 RGBA8로 씀 (여백은 반대쪽 가장자리 텍셀)
+// 1채널은 (r, 0, 0, 255), 3채널은 알파 255 -> 따로 올릴 때 GL_RED / GL_RGB를 샘플링한 값과 같음
+// levelPixels: 이 레벨의 레이어 전체 (레이어마다 levelSize^2 * 4). 텍스처마다 자리가 겹치지 않아서 스레드끼리 나눠 써도 됨
+void writeAtlasEntryLevel(const AtlasEntry& entry, int level, const TextureLevelData& source, int channels, unsigned char* levelPixels, int levelSize) {
+    int width = source.width, height = source.height, paddingX = entry.paddingX >> level, paddingY = entry.paddingY >> level;
+    int originX = (entry.x + entry.paddingX) >> level, originY = (entry.y + entry.paddingY) >> level;
+    unsigned char* layer = levelPixels + (size_t)entry.layer * levelSize * levelSize * 4;
+    for (int y = -paddingY; y < height + paddingY; y++) {
+        const unsigned char* row = source.data + (size_t)((y + height) % height) * width * channels;
+        unsigned char* out = layer + ((size_t)(originY + y) * levelSize + originX - paddingX) * 4;
+        for (int x = -paddingX; x < width + paddingX; x++, out += 4) {
+            const unsigned char* texel = row + (size_t)((x + width) % width) * channels;
+            out[0] = texel[0];
+            out[1] = channels >= 3 ? texel[1] : 0;
+            out[2] = channels >= 3 ? texel[2] : 0;
+            out[3] = channels == 4 ? texel[3] : 255;
+        }
+    }
+}
+
+// 레벨 하나 (레이어 전부)를 올림: 스테이징 링에 자리가 있으면 PBO 오프셋으로
+static void uploadAtlasLevel(int level, int levelSize, int layers, const vector<unsigned char>& pixels) {
+    StagingRegion region;
+    if (allocateStaging(stagingRing, pixels.size(), region)) {
+        memcpy(stagingRing.mapped + region.offset, &pixels[0], pixels.size());
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, stagingRing.buffer);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, levelSize, levelSize, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, (const void*)region.offset);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        fenceStaging(stagingRing, region);
+        return;
+    }
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, levelSize, levelSize, layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+}
+
+// 아틀라스에 넣을 텍스처를 디코드 전에 정함 (PNG 헤더만): paths 중 아틀라스 크기이고 아직 없는 것을 entries에 더함
+// 후보가 2개 미만이면 아틀라스를 만들지 않으므로 비움 -> 그 텍스처는 다른 텍스처처럼 비동기 디코드
+// 반환값: 아틀라스에 넣기로 한 텍스처 수
+int planTextureAtlas(TextureAtlas& atlas, const vector<string>& paths) {
+    for (size_t i = 0; i < paths.size(); i++) {
+        if (isPlannedAtlasEntry(atlas, paths[i])) continue;
+        AtlasEntry entry;
+        entry.path = paths[i];
+        if (isAtlasCandidate(entry.path, entry.width, entry.height)) atlas.entries.push_back(entry);
+    }
+    if (atlas.entries.size() < 2) atlas.entries.clear();
+    return (int)atlas.entries.size();
+}
+
+// planTextureAtlas로 정한 텍스처를 배열 하나로 묶어 올림 (텍스처마다 디코드 + 자리 채우기를 스레드로 나눔)
+// 반환값: 아틀라스에 들어간 텍스처 수 (나머지는 loadTextureCached로 따로)
+int buildTextureAtlas(TextureAtlas& atlas, int threadCount) {
+    chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+    vector<AtlasEntry> planned;
+    planned.swap(atlas.entries);
+    atlas = TextureAtlas();
+    atlas.entries.swap(planned);
+    if (atlas.entries.size() < 2) {
+        atlas.entries.clear();
+        return 0;
+    }
+
+    atlas.layerSize = packTextureAtlasBestSize(atlas.entries, atlas.layers);
+    atlas.levels = atlasLevelCount(atlas.entries);
+    vector<vector<unsigned char>> levelPixels(atlas.levels);
+    for (int level = 0; level < atlas.levels; level++) {
+        int levelSize = atlas.layerSize >> level;
+        levelPixels[level].assign((size_t)atlas.layers * levelSize * levelSize * 4, 0);
+    }
+
+    // 캐시가 있으면 매핑만, 없으면 PNG 디코드 + mip (비압축 KTX2 캐시로 저장)
+    // 텍스처 단위로 이미 나눠 돌리므로 텍스처 하나의 mip은 스레드 하나로 (스레드마다 또 loaderThreadCount()개를 띄우지 않음)
+    atomic<size_t> next(0);
+    vector<thread> workers;
+    int workerCount = max(1, min(threadCount, (int)atlas.entries.size()));
+    for (int w = 0; w < workerCount; w++) {
+        workers.push_back(thread([&atlas, &levelPixels, &next]() {
+            for (size_t i = next++; i < atlas.entries.size(); i = next++) {
+                AtlasEntry& entry = atlas.entries[i];
+                if (entry.layer < 0) continue;
+                DecodedTexture decoded;
+                bool valid = decodeTexture(entry.path.c_str(), TEXTURE_UNCOMPRESSED, decoded, 1) && (int)decoded.levels.size() >= atlas.levels;
+                for (int level = 0; level < atlas.levels && valid; level++)
+                    valid = decoded.levels[level].width == max(1, entry.width >> level) && decoded.levels[level].height == max(1, entry.height >> level);
+                if (!valid) {
+                    entry.layer = -1; // 빈 자리로 두고 따로 로드
+                    continue;
+                }
+                for (int level = 0; level < atlas.levels; level++)
+                    writeAtlasEntryLevel(entry, level, decoded.levels[level], decoded.channels, &levelPixels[level][0], atlas.layerSize >> level);
+            }
+        }));
+    }
+    for (size_t w = 0; w < workers.size(); w++) workers[w].join();
+
+    uint64_t usedTexels = 0;
+    for (size_t i = 0; i < atlas.entries.size(); i++) {
+        if (atlas.entries[i].layer < 0) continue;
+        atlas.entryIndex[atlas.entries[i].path] = i;
+        usedTexels += (uint64_t)atlas.entries[i].width * atlas.entries[i].height;
+    }
+    if (atlas.entryIndex.size() < 2) {
+        atlas = TextureAtlas();
+        return 0;
+    }
+
+    glGenTextures(1, &atlas.textureID);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, atlas.textureID);
+    size_t bytes = 0;
+    for (int level = 0; level < atlas.levels; level++) {
+        uploadAtlasLevel(level, atlas.layerSize >> level, atlas.layers, levelPixels[level]);
+        bytes += levelPixels[level].size();
+    }
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, atlas.levels - 1);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, atlas.levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    printf("Texture atlas: %zu of %zu planned textures in %d layer(s) of %dx%d, %d levels, %.2f MB (%.0f%% of level 0 used), built in %.1f ms\n",
+           atlas.entryIndex.size(), atlas.entries.size(), atlas.layers, atlas.layerSize, atlas.layerSize, atlas.levels, bytes / (1024.0 * 1024.0),
+           100.0 * usedTexels / ((double)atlas.layers * atlas.layerSize * atlas.layerSize), elapsedSeconds(start) * 1e3);
+    return (int)atlas.entryIndex.size();
+}
+
+// path가 아틀라스에 있으면 그 자리
+const AtlasEntry* findAtlasEntry(const TextureAtlas& atlas, const string& path) {
+    map<string, size_t>::const_iterator it = atlas.entryIndex.find(path);
+    return it != atlas.entryIndex.end() ? &atlas.entries[it->second] : nullptr;
+}
+
+// ===== 비동기 텍스처 디코드 =====
+// main이 OBJ를 파싱하기 전에 mtllib → map_Kd를 미리 찾아 작업 스레드에서 디코드(+ mip 체인 / 압축 캐시)를 시작해서 OBJ 파싱, 메시 최적화와 겹침
+// (미리 못 찾은 map_Kd는 loadMTL이 찾는 즉시 시작)
+// GL 호출은 메인 스레드에서만: loadTextureCached가 텍스처 이름을 바로 만들고 1x1 재질 색상(Kd)으로 채워 두었다가,
+// 디코드가 끝나면 idle 콜백에서 같은 이름에 전체 레벨을 올림 -> 그리는 쪽 코드는 그대로, 그 사이에는 재질 색상만 보임
+// 첫 프레임까지 시간은 메시 준비와 텍스처 디코드 중 느린 쪽이 아니라 메시 준비만 (텍스처는 그 뒤에 나타남)
+// --sync-textures 이면 예전처럼 loadTextureCached에서 디코드 + 업로드
+// planTextureAtlas가 아틀라스에 넣기로 한 텍스처만 여기서 시작하지 않음 (buildTextureAtlas가 비압축으로 디코드, 아틀라스가 안 만들어지면 동기 로드)
+// 스테이징 링이 있으면 올릴 때 구간을 잡아서 최종 레벨을 쓰고 PBO 오프셋으로 (디코드 중에는 링 구간을 잡지 않음)
+
+bool asyncTextureDecode = false; // main이 GL 초기화 후 켬 (벤치마크의 loadMTL은 디코드를 시작하지 않음)
+
+chrono::high_resolution_clock::time_point startupTime = chrono::high_resolution_clock::now();
+
+// 작업 스레드와 공유 (스레드는 detach: 창을 닫을 때 디코드 중이어도 기다리지 않음)
+struct AsyncTextureJob {
+    string path;
+    TextureCompression format;
+    DecodedTexture decoded;
+    bool succeeded;
+    double decodeSeconds;
+    atomic<bool> finished; // true가 된 뒤에만 메인 스레드가 위 값을 읽음
+
+    AsyncTextureJob() : format(TEXTURE_UNCOMPRESSED), succeeded(false), decodeSeconds(0.0), finished(false) {}
+};
+
+struct AsyncTexture {
+    shared_ptr<AsyncTextureJob> job;
+    GLuint textureID; // loadTextureCached가 만든 이름 (0이면 아직 쓰는 곳 없음)
+    bool uploaded;
+
+    AsyncTexture() : textureID(0), uploaded(false) {}
+};
+
+map<string, AsyncTexture> asyncTextures;
+
+void requestTextureDecode(const string& path) {
+    if (!asyncTextureDecode || asyncTextures.find(path) != asyncTextures.end()) return;
+    if (useTextureAtlas && isPlannedAtlasEntry(textureAtlas, path)) return;
+    shared_ptr<AsyncTextureJob> job = make_shared<AsyncTextureJob>();
+    job->path = path;
+    job->format = chooseTextureCompression(path.c_str());
+    asyncTextures[path].job = job;
+    printf("Texture decode started on worker thread: %s\n", path.c_str());
+    thread([job]() {
+        chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+        job->succeeded = decodeTexture(job->path.c_str(), job->format, job->decoded);
+        job->decodeSeconds = elapsedSeconds(start);
+        job->finished.store(true, memory_order_release);
+    }).detach();
+}
+
+// 디코드가 끝날 때까지 보일 1x1 텍스처 (흰색 * 텍스처로 그리므로 재질 색상 그대로)
+GLuint createPlaceholderTexture(const glm::vec3& color) {
+    unsigned char texel[4] = { (unsigned char)(min(max(color.r, 0.0f), 1.0f) * 255.0f + 0.5f), (unsigned char)(min(max(color.g, 0.0f), 1.0f) * 255.0f + 0.5f),
+                               (unsigned char)(min(max(color.b, 0.0f), 1.0f) * 255.0f + 0.5f), 255 };
+    GLuint textureID;
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, texel);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    return textureID;
+}
+
+// 디코드가 끝난 텍스처를 자기 이름에 올림 (메인 스레드). 올린 개수
+int pollAsyncTextures() {
+    int uploaded = 0;
+    for (map<string, AsyncTexture>::iterator it = asyncTextures.begin(); it != asyncTextures.end(); ++it) {
+        AsyncTexture& entry = it->second;
+        if (entry.uploaded || entry.textureID == 0 || !entry.job->finished.load(memory_order_acquire)) continue;
+        if (entry.job->succeeded) {
+            // 링 구간은 지금 잡아서 바로 올리고 fence (자리가 없으면 CPU 포인터 경로)
+            if (!uploadThroughStaging(entry.textureID, entry.job->decoded)) uploadDecodedTexture(entry.textureID, entry.job->decoded);
+            printf("Async texture ready: %s (ID %d, decode %.1f ms, %.1f ms after startup)\n", it->first.c_str(), entry.textureID,
+                   entry.job->decodeSeconds * 1e3, elapsedSeconds(startupTime) * 1e3);
+        } else {
+            printf("Async texture failed: %s, keeping material color\n", it->first.c_str());
+        }
+        entry.job->decoded = DecodedTexture(); // CPU 쪽 사본 해제
+        entry.uploaded = true;
+        uploaded++;
+    }
+    return uploaded;
+}
+
+bool asyncTexturesPending() {
+    for (map<string, AsyncTexture>::const_iterator it = asyncTextures.begin(); it != asyncTextures.end(); ++it)
+        if (it->second.textureID != 0 && !it->second.uploaded) return true;
+    return false;
+}
+
+// 남은 텍스처가 있는 동안만 등록되는 GLUT idle 콜백
+void asyncTextureIdle() {
+    if (pollAsyncTextures() > 0) glutPostRedisplay();
+    if (!asyncTexturesPending()) glutIdleFunc(NULL);
+    else this_thread::sleep_for(chrono::milliseconds(1));
+}
+
+// mtl 파일 파싱
+bool loadMTL(const char* path, map<string, Material>& materials) {
+    ifstream file(path, ios::in);
+    if (!file.is_open()) {
+        printf("Failed to open MTL file: %s\n", path);
+        return false;
+    }
+    
+    printf("Loading MTL file: %s\n", path);
+    
+    Material* currentMaterial = nullptr;
+    string line;
+    int material_count = 0;
+    
+    while (getline(file, line) && file.good()) {
+        if (line.empty() || line[0] == '#') continue;
+        
+        stringstream ss(line);
+        string command;
+        ss >> command;
+        
+        if (command == "newmtl") {
+            string materialName;
+            ss >> materialName;
+            
+            Material newMat;
+            newMat.name = materialName;
+            materials[materialName] = newMat;
+            currentMaterial = &materials[materialName];
+            material_count++;
+            printf("Found material: %s\n", materialName.c_str());
+        }
+        else if (currentMaterial != nullptr) {
+            if (command == "Ka") {
+                // Ambient color
+                float r, g, b;
+                if (ss >> r >> g >> b) {
+                    currentMaterial->ambient = glm::vec3(r, g, b);
+                }
+            }
+            else if (command == "Kd") {
+                // Diffuse color (main color)
+                float r, g, b;
+                if (ss >> r >> g >> b) {
+                    currentMaterial->diffuse = glm::vec3(r, g, b);
+                    printf("Material %s diffuse: (%.3f, %.3f, %.3f)\n", 
+                           currentMaterial->name.c_str(), r, g, b);
+                }
+            }
+            else if (command == "Ks") {
+                // Specular color
+                float r, g, b;
+                if (ss >> r >> g >> b) {
+                    currentMaterial->specular = glm::vec3(r, g, b);
+                }
+            }
+            else if (command == "Ns") {
+                // Shininess
+                float ns;
+                if (ss >> ns) {
+                    currentMaterial->shininess = ns;
+                }
+            }
+            else if (command == "map_Kd") {
+                // Texture map
+                string texturePath;
+                ss >> texturePath;
+                currentMaterial->texture_map = texturePath;
+                printf("Material %s texture: %s\n", 
+                       currentMaterial->name.c_str(), texturePath.c_str());
+                requestTextureDecode(texturePath); // 나머지 파싱과 겹쳐서 디코드
+            }
+        }
+    }
+    
+    file.close();
+    printf("MTL file loaded: %d materials\n", material_count);
+    return true;
+}
+
+// 정점 중복 제거용 해시 테이블 (open addressing + linear probing)
+// (position, texcoord) 인덱스를 64비트 키 하나로 묶어서 슬롯 배열에 바로 저장 → 노드 할당/트리 탐색 없음
+struct VertexDedupTable {
+    struct Slot {
+        uint64_t key;
+        uint32_t value;
+    };
+    static const uint64_t EMPTY_KEY = ~0ull;
+
+    vector<Slot> slots;
+    uint64_t mask;
+    size_t count;
+
+    // expectedVertices: 파싱 중 센 정점/텍스처 좌표 수로 미리 크기를 잡음 (load factor 0.5 이하)
+    explicit VertexDedupTable(size_t expectedVertices) : mask(0), count(0) {
+        rehash(expectedVertices * 2);
+    }
+
+    static uint64_t packKey(int positionIndex, int texcoordIndex) {
+        // texcoord 없음(-1 이하)은 0, 나머지는 +1 해서 음수가 안 나오게
+        uint32_t tex = texcoordIndex < 0 ? 0u : (uint32_t)texcoordIndex + 1u;
+        return ((uint64_t)(uint32_t)positionIndex << 32) | tex;
+    }
+
+    // position 인덱스를 그대로 슬롯 위치로 사용 (2배 간격) + texcoord는 작은 범위로 섞음
+    // face는 보통 가까운 정점을 참조하므로 탐색이 메모리를 순서대로 훑게 되어 캐시 미스가 적음
+    size_t slotOf(uint64_t key) const {
+        uint32_t position = (uint32_t)(key >> 32);
+        uint32_t tex = (uint32_t)key;
+        return (size_t)(((uint64_t)position * 2 + ((tex * 0x9E3779B1u) >> 29)) & mask);
+    }
+
+    void rehash(size_t minCapacity) {
+        size_t capacity = 16;
+        while (capacity < minCapacity) capacity <<= 1;
+
+        vector<Slot> old;
+        old.swap(slots);
+        Slot empty = { EMPTY_KEY, 0 };
+        slots.assign(capacity, empty);
+        mask = capacity - 1;
+
+        for (size_t i = 0; i < old.size(); i++) {
+            if (old[i].key == EMPTY_KEY) continue;
+            size_t s = slotOf(old[i].key);
+            while (slots[s].key != EMPTY_KEY) s = (s + 1) & mask;
+            slots[s] = old[i];
+        }
+    }
+
+    // 메모리는 그대로 두고 내용만 비움 (스트리밍 페이지마다 재사용)
+    void clear() {
+        Slot empty = { EMPTY_KEY, 0 };
+        fill(slots.begin(), slots.end(), empty);
+        count = 0;
+    }
+
+    // 있으면 기존 인덱스, 없으면 newIndex를 넣고 그대로 반환 (탐색 한 번으로 끝)
+    int findOrInsert(int positionIndex, int texcoordIndex, int newIndex) {
+        if ((count + 1) * 2 > slots.size()) rehash(slots.size() * 2);
+
+        uint64_t key = packKey(positionIndex, texcoordIndex);
+        size_t s = slotOf(key);
+        while (true) {
+            Slot& slot = slots[s];
+            if (slot.key == key) return (int)slot.value;
+            if (slot.key == EMPTY_KEY) {
+                slot.key = key;
+                slot.value = (uint32_t)newIndex;
+                count++;
+                return newIndex;
+            }
+            s = (s + 1) & mask;
+        }
+    }
+};
+
+// 기존 std::map 방식 (벤치마크 비교용)
+struct MapDedupTable {
+    map<pair<int, int>, int> vertex_map;
+
+    explicit MapDedupTable(size_t) {}
+
+    int findOrInsert(int positionIndex, int texcoordIndex, int newIndex) {
+        pair<int, int> vertex_key = make_pair(positionIndex, texcoordIndex);
+        map<pair<int, int>, int>::iterator it = vertex_map.lower_bound(vertex_key);
+        if (it != vertex_map.end() && it->first == vertex_key) return it->second;
+        vertex_map.insert(it, make_pair(vertex_key, newIndex));
+        return newIndex;
+    }
+};
+
+// OBJ 파일 파싱
+bool loadOBJ(const char* path, vector<float>& vertices, vector<unsigned int>& indices, glm::vec3& actualColor, glm::vec3* centerOffset = nullptr) {
+    vector<glm::vec3> temp_vertices;
+    vector<glm::vec2> temp_texcoords;
+    vector<unsigned int> temp_indices;
+    
+    // 최종 정점 데이터 [클로드 도움: 인터리브 방식 정점 버퍼 구성법] (position + texcoord 인터리브)
+    vector<float> final_vertices;
+    
+    ifstream file(path, ios::in);
+    if (!file.is_open()) {
+        printf("Failed to open file: %s\n", path);
+        return false;
+    }
+    
+    printf("Loading OBJ file: %s\n", path);
+    
+    string line;
+    int vertex_count = 0, texcoord_count = 0, face_count = 0;
+    string currentMaterial = "";
+    string mtlFile = "";
+    
+    // 첫 번째: 정점과 텍스처 좌표 데이터 수집 + MTL 파일 로드
+    while (getline(file, line) && file.good()) {
+        if (line.empty()) continue;
+        
+        if (line.substr(0, 7) == "mtllib ") {
+            // MTL 파일 참조 발견
+            mtlFile = line.substr(7);
+            // 공백 제거
+            mtlFile.erase(mtlFile.find_last_not_of(" \t\r\n") + 1);
+            printf("Found MTL reference: %s\n", mtlFile.c_str());
+            
+            // MTL 파일 로드
+            if (loadMTL(mtlFile.c_str(), materials)) {
+                printf("Successfully loaded MTL file\n");
+            }
+        }
+        else if (line.substr(0, 7) == "usemtl ") {
+            // Material 사용 명령
+            currentMaterial = line.substr(7);
+            currentMaterial.erase(currentMaterial.find_last_not_of(" \t\r\n") + 1);
+            printf("Using material: %s\n", currentMaterial.c_str());
+            
+            // [클로드 도움: MTL 파일에서 재질 색상을 읽어와서 actualColor에 적용]
+            if (!currentMaterial.empty() && materials.find(currentMaterial) != materials.end()) {
+                actualColor = materials[currentMaterial].diffuse;
+                printf("Loaded material color: (%.3f, %.3f, %.3f) from %s\n", 
+                       actualColor.r, actualColor.g, actualColor.b, currentMaterial.c_str());
+            }
+        }
+        else if (line.substr(0, 2) == "v ") {
+            // vertex position 파싱하고 저장
+            stringstream ss(line.substr(2));
+            float x, y, z;
+            if (ss >> x >> y >> z) {
+                temp_vertices.push_back(glm::vec3(x, y, z));
+                vertex_count++;
+            }
+        }
+        else if (line.substr(0, 3) == "vt ") {
+            // Parse texture 파싱하고 저장
+            stringstream ss(line.substr(3));
+            float u, v;
+            if (ss >> u >> v) {
+                temp_texcoords.push_back(glm::vec2(u, v));
+                texcoord_count++;
+            }
+        }
+    }
+    
+    file.clear();
+    file.seekg(0, ios::beg);
+    
+    printf("Loaded %d vertices, %d texture coordinates\n", vertex_count, texcoord_count);
+    
+    // 인덱스를 키로 하는 정점 해시 테이블 (중복 없게), 정점/텍스처 좌표 수로 미리 크기 지정
+    VertexDedupTable vertex_map(max(vertex_count, texcoord_count));
+    int current_vertex_index = 0;
+    
+    // 두 번째: face 데이터 처리
+    while (getline(file, line) && file.good()) {
+        if (line.empty()) continue;
+        
+        if (line.substr(0, 2) == "f ") {
+            // face (format: vertex/texture/normal) 파싱
+            stringstream ss(line.substr(2));
+            vector<int> face_vertex_indices;
+            string token;
+            
+            while (ss >> token) {
+                size_t first_slash = token.find('/');
+                size_t second_slash = token.find('/', first_slash + 1);
+                
+                int vertex_idx = -1, texcoord_idx = -1;
+                
+                if (first_slash != string::npos) {
+                    vertex_idx = stoi(token.substr(0, first_slash));
+                    
+                    if (second_slash != string::npos) {
+                        // format: vertex/texture/normal
+                        string tex_str = token.substr(first_slash + 1, second_slash - first_slash - 1);
+                        if (!tex_str.empty()) {
+                            texcoord_idx = stoi(tex_str);
+                        }
+                    } else {
+                        // format: vertex/texture
+                        string tex_str = token.substr(first_slash + 1);
+                        if (!tex_str.empty()) {
+                            texcoord_idx = stoi(tex_str);
+                        }
+                    }
+                } else {
+                    // format: vertex only
+                    vertex_idx = stoi(token);
+                }
+                
+                // [클로드 도움: OBJ 파일 파싱 시 인덱스 유효성 검증]
+                if (vertex_idx < 1 || vertex_idx > vertex_count) {
+                    printf("Invalid vertex index: %d (max: %d) in face line: %s\n", vertex_idx, vertex_count, line.c_str());
+                    face_vertex_indices.clear();
+                    break;
+                }
+                
+                if (texcoord_idx != -1 && (texcoord_idx < 1 || texcoord_idx > texcoord_count)) {
+                    printf("Invalid texture coordinate index: %d (max: %d) in face line: %s\n", texcoord_idx, texcoord_count, line.c_str());
+                    texcoord_idx = -1; // 잘못된 텍스처 인덱스는 무시
+                }
+                
+                // 정점-텍스처 조합을 키로 사용, 이미 존재하는 조합인지 확인
+                int vertex_id = vertex_map.findOrInsert(vertex_idx - 1, texcoord_idx - 1, current_vertex_index);
+                if (vertex_id == current_vertex_index) {
+                    // 새로운 조합이면 추가
+                    // 정점 위치 추가
+                    glm::vec3 pos = temp_vertices[vertex_idx - 1];
+                    final_vertices.push_back(pos.x);
+                    final_vertices.push_back(pos.y);
+                    final_vertices.push_back(pos.z);
+                    
+                    // 텍스처 좌표 추가
+                    if (texcoord_idx != -1 && texcoord_idx - 1 < temp_texcoords.size()) {
+                        glm::vec2 tex = temp_texcoords[texcoord_idx - 1];
+                        final_vertices.push_back(tex.x);
+                        final_vertices.push_back(tex.y);
+                    } else {
+                        // 기본 텍스처 좌표
+                        final_vertices.push_back(0.0f);
+                        final_vertices.push_back(0.0f);
+                    }
+                    
+                    current_vertex_index++;
+                }
+                
+                face_vertex_indices.push_back(vertex_id);
+            }
+            
+            // 삼각형 생성
+            if (face_vertex_indices.size() >= 3) {
+                if (face_vertex_indices.size() == 3) {
+                    temp_indices.push_back(face_vertex_indices[0]);
+                    temp_indices.push_back(face_vertex_indices[1]);
+                    temp_indices.push_back(face_vertex_indices[2]);
+                    face_count++;
+                }
+                else if (face_vertex_indices.size() == 4) {
+                    // 두 개의 삼각형으로 분할해서 저장
+                    temp_indices.push_back(face_vertex_indices[0]);
+                    temp_indices.push_back(face_vertex_indices[1]);
+                    temp_indices.push_back(face_vertex_indices[2]);
+                    
+                    temp_indices.push_back(face_vertex_indices[0]);
+                    temp_indices.push_back(face_vertex_indices[2]);
+                    temp_indices.push_back(face_vertex_indices[3]);
+                    face_count += 2;
+                }
+                else {
+                    // [클로드 도움: 다각형을 삼각형으로 분할하는 방법 (fan triangulation)]
+                    for (size_t i = 1; i < face_vertex_indices.size() - 1; i++) {
+                        temp_indices.push_back(face_vertex_indices[0]);
+                        temp_indices.push_back(face_vertex_indices[i]);
+                        temp_indices.push_back(face_vertex_indices[i + 1]);
+                        face_count++;
+                    }
+                }
+            }
+        }
+    }
+    
+    file.close();
+    
+    // 바운딩 박스 계산
+    if (centerOffset != nullptr && !temp_vertices.empty()) {
+        glm::vec3 minBound = temp_vertices[0];
+        glm::vec3 maxBound = temp_vertices[0];
+        
+        for (const auto& vertex : temp_vertices) {
+            minBound.x = min(minBound.x, vertex.x);
+            minBound.y = min(minBound.y, vertex.y);
+            minBound.z = min(minBound.z, vertex.z);
+            maxBound.x = max(maxBound.x, vertex.x);
+            maxBound.y = max(maxBound.y, vertex.y);
+            maxBound.z = max(maxBound.z, vertex.z);
+        }
+        
+        *centerOffset = (minBound + maxBound) * 0.5f;
+        printf("Bounding box: min(%.3f, %.3f, %.3f), max(%.3f, %.3f, %.3f)\n", 
+               minBound.x, minBound.y, minBound.z, maxBound.x, maxBound.y, maxBound.z);
+        printf("Center offset: (%.3f, %.3f, %.3f)\n", 
+               centerOffset->x, centerOffset->y, centerOffset->z);
+    }
+    
+    // 결과 저장
+    vertices = final_vertices;
+    indices = temp_indices;
+    
+    printf("OBJ file loaded: %d unique vertices (pos+tex), %d triangles, %zu indices\n", 
+           current_vertex_index, face_count, indices.size());
+    
+    return true;
+}
+
+// ===== OBJ 고속 로더 (메모리 매핑 + 단일 패스 토크나이저) =====
+// loadOBJ는 getline/stringstream/substr/stoi 때문에 큰 파일에서 할당과 iostream 비용이 대부분을 차지함
+// 파일을 메모리에 매핑해서 한 번만 앞으로 읽고, 숫자는 버퍼 위에서 바로 파싱함 (임시 string 없음)
+
+// 메모리 매핑된 파일 (읽기 전용)
+struct MappedFile {
+    const char* data;
+    size_t size;
+#ifdef _WIN32
+    HANDLE fileHandle;
+    HANDLE mappingHandle;
+#else
+    int fd;
+#endif
+
+    MappedFile() : data(nullptr), size(0) {
+#ifdef _WIN32
+        fileHandle = INVALID_HANDLE_VALUE;
+        mappingHandle = NULL;
+#else
+        fd = -1;
+#endif
+    }
+};
+
+void unmapFile(MappedFile& file) {
+#ifdef _WIN32
+    if (file.data) UnmapViewOfFile(file.data);
+    if (file.mappingHandle) CloseHandle(file.mappingHandle);
+    if (file.fileHandle != INVALID_HANDLE_VALUE) CloseHandle(file.fileHandle);
+    file.fileHandle = INVALID_HANDLE_VALUE;
+    file.mappingHandle = NULL;
+#else
+    if (file.data) munmap((void*)file.data, file.size);
+    if (file.fd >= 0) close(file.fd);
+    file.fd = -1;
+#endif
+    file.data = nullptr;
+    file.size = 0;
+}
+
+bool mapFile(const char* path, MappedFile& file) {
+    unmapFile(file);
+#ifdef _WIN32
+    file.fileHandle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file.fileHandle == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file.fileHandle, &fileSize)) { unmapFile(file); return false; }
+    file.size = (size_t)fileSize.QuadPart;
+    if (file.size == 0) return true; // 빈 파일은 매핑할 수 없음
+
+    file.mappingHandle = CreateFileMappingA(file.fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (file.mappingHandle == NULL) { unmapFile(file); return false; }
+    file.data = (const char*)MapViewOfFile(file.mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    if (file.data == nullptr) { unmapFile(file); return false; }
+#else
+    file.fd = open(path, O_RDONLY);
+    if (file.fd < 0) return false;
+
+    struct stat st;
+    if (fstat(file.fd, &st) != 0) { unmapFile(file); return false; }
+    file.size = (size_t)st.st_size;
+    if (file.size == 0) return true;
+
+    void* ptr = mmap(nullptr, file.size, PROT_READ, MAP_PRIVATE, file.fd, 0);
+    if (ptr == MAP_FAILED) { file.size = 0; unmapFile(file); return false; }
+    madvise(ptr, file.size, MADV_SEQUENTIAL);
+    file.data = (const char*)ptr;
+#endif
+    return true;
+}
+
+// 토크나이저 보조 함수들 (p ~ end 범위만 읽음, 널 종료 필요 없음)
+static inline bool isSpaceChar(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+}
+
+static inline const char* skipSpaces(const char* p, const char* end) {
+    while (p < end && isSpaceChar(*p)) p++;
+    return p;
+}
+
+// 정수 파싱 (stoi처럼 부호 허용). 숫자가 없으면 nullptr
+static inline const char* parseIntFast(const char* p, const char* end, int& out) {
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        p++;
+    }
+    const char* digitsStart = p;
+    long long value = 0;
+    while (p < end && (unsigned)(*p - '0') < 10) {
+        if (value < 0x7fffffff) value = value * 10 + (*p - '0');
+        p++;
+    }
+    if (p == digitsStart) return nullptr;
+    out = (int)(negative ? -value : value);
+    return p;
+}
+
+// float 파싱 (from_chars 방식: 버퍼 위에서 바로 변환)
+// 가수가 2^24 이하이고 10의 지수가 ±10 이내면 float 한 번의 곱/나눗셈으로 정확히 반올림됨 (Clinger fast path)
+// OBJ의 "%.6f" 값은 거의 전부 여기서 끝나고, 나머지는 strtof로 넘겨서 stringstream과 같은 결과를 보장
+static inline const char* parseFloatFast(const char* p, const char* end, float& out) {
+    static const float powersOf10[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+
+    const char* start = p;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = (*p == '-');
+        p++;
+    }
+
+    uint64_t mantissa = 0;
+    int significantDigits = 0;
+    int exponent10 = 0;
+    bool anyDigits = false;
+    bool exact = true;
+
+    // 정수부
+    while (p < end && (unsigned)(*p - '0') < 10) {
+        if (significantDigits < 19) {
+            mantissa = mantissa * 10 + (*p - '0');
+            if (mantissa != 0) significantDigits++;
+        } else {
+            exponent10++;
+            exact = false;
+        }
+        anyDigits = true;
+        p++;
+    }
+    // 소수부
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && (unsigned)(*p - '0') < 10) {
+            if (significantDigits < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                if (mantissa != 0) significantDigits++;
+                exponent10--;
+            } else if (*p != '0') {
+                exact = false;
+            }
+            anyDigits = true;
+            p++;
+        }
+    }
+    if (!anyDigits) return nullptr;
+
+    // 지수부 (1.5e-3)
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char* expStart = p;
+        p++;
+        int expValue = 0;
+        const char* expEnd = parseIntFast(p, end, expValue);
+        if (expEnd != nullptr) {
+            exponent10 += expValue;
+            p = expEnd;
+        } else {
+            p = expStart; // 'e' 뒤에 숫자가 없으면 지수부 아님
+        }
+    }
+
+    if (exact && mantissa <= (1u << 24) && exponent10 >= -10 && exponent10 <= 10) {
+        float value = (float)mantissa;
+        value = exponent10 < 0 ? value / powersOf10[-exponent10] : value * powersOf10[exponent10];
+        out = negative ? -value : value;
+        return p;
+    }
+
+    // 느린 경로: 토큰만 잘라서 strtof
+    char buffer[64];
+    size_t length = (size_t)(p - start);
+    if (length < sizeof(buffer)) {
+        memcpy(buffer, start, length);
+        buffer[length] = '\0';
+        out = strtof(buffer, nullptr);
+    } else {
+        string token(start, p);
+        out = strtof(token.c_str(), nullptr);
+    }
+    return p;
+}
+
+// 한 줄씩 파싱한 OBJ 원본 데이터 (인덱스 해석 전)
+struct OBJCorner {
+    int vertex;   // 1-based, 파싱 실패 시 0
+    int texcoord; // 1-based, 없으면 0
+};
+
+// mtllib/usemtl은 파싱 중에 바로 처리하지 않고 기록만 해둠 (청크 병렬 파싱에서도 순서 유지)
+struct OBJDirective {
+    bool isMaterialLib; // true: mtllib, false: usemtl
+    string name;
+    size_t faceIndex;   // 이 명령 앞에 나온 face 수
+};
+
+struct OBJRawData {
+    vector<glm::vec3> positions;
+    vector<glm::vec2> texcoords;
+    vector<OBJCorner> corners; // 모든 face의 꼭짓점을 순서대로
+    vector<int> faceSizes;     // face마다 꼭짓점 개수
+    vector<OBJDirective> directives;
+};
+
+// usemtl 그룹 하나 = 인덱스 버퍼의 연속 구간 하나 (같은 재질의 face는 한 구간으로 모음)
+struct SubMesh {
+    string materialName;
+    unsigned int firstIndex;
+    unsigned int indexCount;
+    glm::vec3 diffuse;   // MTL의 Kd (재질이 없으면 Material 기본값)
+    string texturePath;  // MTL의 map_Kd
+    GLuint textureID;    // 텍스처 로드 후 채움 (0이면 색상만, 아틀라스에 있으면 textureAtlas.textureID)
+    int atlasLayer;      // 아틀라스 레이어 (-1이면 자기 텍스처)
+    glm::vec4 atlasRect; // 아틀라스 안 영역 (xy: scale, zw: offset)
+    unsigned int firstMeshlet; // buildMeshlets 후 이 구간의 meshlet (0개면 구간 전체를 한 번에 그림)
+    unsigned int meshletCount;
+
+    SubMesh() : firstIndex(0), indexCount(0), diffuse(Material().diffuse), textureID(0), atlasLayer(-1), atlasRect(1.0f, 1.0f, 0.0f, 0.0f),
+                firstMeshlet(0), meshletCount(0) {}
+};
+
+// 재질 구간 안의 연속된 삼각형 묶음 (정점 64개 / 삼각형 124개 이하) + 컬링용 경계
+struct Meshlet {
+    unsigned int firstIndex;
+    unsigned int indexCount;
+    glm::vec3 center;     // 바운딩 구 (모델 공간)
+    float radius;
+    glm::vec3 coneApex;   // 법선 콘: 카메라가 apex에서 본 방향이 모든 삼각형의 뒷면이면 컬링
+    glm::vec3 coneAxis;
+    float coneCutoff;     // sin(콘 반각). 1보다 크면 콘 컬링 안 함
+};
+
+// 한 줄 처리 (line ~ lineEnd, 개행 문자 제외). loadOBJ와 같은 접두사 규칙을 따름
+static void parseOBJLine(const char* line, const char* lineEnd, OBJRawData& raw) {
+    size_t length = (size_t)(lineEnd - line);
+    if (length < 2) return;
+
+    if (line[0] == 'v' && line[1] == ' ') {
+        // vertex position
+        const char* p = line + 2;
+        float xyz[3];
+        for (int i = 0; i < 3; i++) {
+            p = skipSpaces(p, lineEnd);
+            p = parseFloatFast(p, lineEnd, xyz[i]);
+            if (p == nullptr) return;
+        }
+        raw.positions.push_back(glm::vec3(xyz[0], xyz[1], xyz[2]));
+    }
+    else if (line[0] == 'v' && line[1] == 't' && length >= 3 && line[2] == ' ') {
+        // texture coordinate
+        const char* p = line + 3;
+        float uv[2];
+        for (int i = 0; i < 2; i++) {
+            p = skipSpaces(p, lineEnd);
+            p = parseFloatFast(p, lineEnd, uv[i]);
+            if (p == nullptr) return;
+        }
+        raw.texcoords.push_back(glm::vec2(uv[0], uv[1]));
+    }
+    else if (line[0] == 'f' && line[1] == ' ') {
+        // face (format: v, v/vt, v/vt/vn, v//vn)
+        const char* p = line + 2;
+        int cornerCount = 0;
+        while (true) {
+            p = skipSpaces(p, lineEnd);
+            if (p >= lineEnd) break;
+
+            OBJCorner corner;
+            corner.vertex = 0;
+            corner.texcoord = 0;
+            const char* next = parseIntFast(p, lineEnd, corner.vertex);
+            p = next ? next : p;
+            if (p < lineEnd && *p == '/') {
+                p++;
+                next = parseIntFast(p, lineEnd, corner.texcoord);
+                p = next ? next : p;
+            }
+            // 나머지 (/normal 등)는 건너뜀
+            while (p < lineEnd && !isSpaceChar(*p)) p++;
+
+            raw.corners.push_back(corner);
+            cornerCount++;
+        }
+        raw.faceSizes.push_back(cornerCount);
+    }
+    else if (length > 7 && (memcmp(line, "mtllib ", 7) == 0 || memcmp(line, "usemtl ", 7) == 0)) {
+        const char* nameEnd = lineEnd;
+        while (nameEnd > line + 7 && isSpaceChar(nameEnd[-1])) nameEnd--;
+
+        OBJDirective directive;
+        directive.isMaterialLib = (line[0] == 'm');
+        directive.name.assign(line + 7, nameEnd);
+        directive.faceIndex = raw.faceSizes.size();
+        raw.directives.push_back(directive);
+    }
+}
+
+// 기록해둔 mtllib/usemtl을 파일 순서대로 적용 (loadOBJ와 같은 결과: 마지막 usemtl 색상)
+static void applyOBJDirectives(const OBJRawData& raw, glm::vec3& actualColor) {
+    for (size_t i = 0; i < raw.directives.size(); i++) {
+        const OBJDirective& directive = raw.directives[i];
+        if (directive.isMaterialLib) {
+            printf("Found MTL reference: %s\n", directive.name.c_str());
+            if (loadMTL(directive.name.c_str(), materials)) {
+                printf("Successfully loaded MTL file\n");
+            }
+            continue;
+        }
+
+        printf("Using material: %s\n", directive.name.c_str());
+        map<string, Material>::iterator it = materials.find(directive.name);
+        if (!directive.name.empty() && it != materials.end()) {
+            actualColor = it->second.diffuse;
+            printf("Loaded material color: (%.3f, %.3f, %.3f) from %s\n",
+                   actualColor.r, actualColor.g, actualColor.b, directive.name.c_str());
+        }
+    }
+}
+
+// 바이트 범위 전체를 한 번에 훑음. 개행 찾기는 memchr (CRT에서 SIMD로 구현됨)
+static void parseOBJBuffer(const char* data, size_t size, OBJRawData& raw) {
+    const char* p = data;
+    const char* end = data + size;
+    while (p < end) {
+        const char* lineEnd = (const char*)memchr(p, '\n', (size_t)(end - p));
+        if (lineEnd == nullptr) lineEnd = end;
+        parseOBJLine(p, lineEnd, raw);
+        p = lineEnd + 1;
+    }
+}
+
+// 청크 병렬 파싱
+// 바이트 범위를 개행 기준으로 나눠서 스레드마다 OBJRawData를 채운 뒤, 청크 순서대로 이어붙임
+// OBJ 인덱스는 파일 전체 기준 1-based 절대값이라 이어붙이기만 하면 그대로 유효함
+// (음수 상대 인덱스는 loadOBJ처럼 잘못된 인덱스로 처리 → 직렬 로더와 결과 동일)
+static const size_t OBJ_MIN_CHUNK_BYTES = 1 << 20; // 1MB보다 작은 청크는 스레드 비용이 더 큼
+
+template <typename T>
+static void appendChunkArrays(vector<T> OBJRawData::* member, const vector<OBJRawData>& chunks, OBJRawData& raw, vector<thread>& workers) {
+    // prefix sum으로 각 청크가 들어갈 위치를 구하고, 복사는 청크별로 병렬
+    vector<size_t> offsets(chunks.size() + 1, 0);
+    for (size_t i = 0; i < chunks.size(); i++)
+        offsets[i + 1] = offsets[i] + (chunks[i].*member).size();
+
+    vector<T>& dst = raw.*member;
+    dst.resize(offsets.back());
+    for (size_t i = 0; i < chunks.size(); i++) {
+        const vector<T>& src = chunks[i].*member;
+        if (src.empty()) continue;
+        T* out = &dst[offsets[i]];
+        workers.push_back(thread([&src, out]() { memcpy(out, &src[0], src.size() * sizeof(T)); }));
+    }
+}
+
+static void parseOBJBufferParallel(const char* data, size_t size, OBJRawData& raw, int threadCount) {
+    size_t chunkCount = max<size_t>(1, min<size_t>((size_t)max(threadCount, 1), size / OBJ_MIN_CHUNK_BYTES));
+    if (chunkCount == 1) {
+        parseOBJBuffer(data, size, raw);
+        return;
+    }
+
+    // 청크 경계를 다음 개행 뒤로 맞춤
+    vector<size_t> bounds(chunkCount + 1, size);
+    bounds[0] = 0;
+    for (size_t i = 1; i < chunkCount; i++) {
+        size_t pos = max(size * i / chunkCount, bounds[i - 1]);
+        const char* newline = pos < size ? (const char*)memchr(data + pos, '\n', size - pos) : nullptr;
+        bounds[i] = newline ? (size_t)(newline - data) + 1 : size;
+    }
+
+    vector<OBJRawData> chunks(chunkCount);
+    vector<thread> workers;
+    for (size_t i = 0; i < chunkCount; i++) {
+        workers.push_back(thread([&, i]() {
+            OBJRawData& chunk = chunks[i];
+            size_t bytes = bounds[i + 1] - bounds[i];
+            chunk.positions.reserve(bytes / 96);
+            chunk.texcoords.reserve(bytes / 96);
+            chunk.corners.reserve(bytes / 24);
+            chunk.faceSizes.reserve(bytes / 96);
+            parseOBJBuffer(data + bounds[i], bytes, chunk);
+        }));
+    }
+    for (size_t i = 0; i < workers.size(); i++) workers[i].join();
+    workers.clear();
+
+    appendChunkArrays(&OBJRawData::positions, chunks, raw, workers);
+    appendChunkArrays(&OBJRawData::texcoords, chunks, raw, workers);
+    appendChunkArrays(&OBJRawData::corners, chunks, raw, workers);
+    appendChunkArrays(&OBJRawData::faceSizes, chunks, raw, workers);
+    for (size_t i = 0; i < workers.size(); i++) workers[i].join();
+
+    // mtllib/usemtl의 face 위치도 전체 기준으로 변환
+    size_t faceOffset = 0;
+    for (size_t i = 0; i < chunkCount; i++) {
+        for (size_t d = 0; d < chunks[i].directives.size(); d++) {
+            OBJDirective directive = chunks[i].directives[d];
+            directive.faceIndex += faceOffset;
+            raw.directives.push_back(directive);
+        }
+        faceOffset += chunks[i].faceSizes.size();
+    }
+}
+
+// 파싱된 face 꼭짓점을 (position, texcoord) 조합으로 중복 제거해서 인터리브 버퍼/인덱스를 만듦
+// 검증/중복 제거/삼각형 분할 순서는 loadOBJ와 동일 → 결과가 비트 단위로 같음
+// DedupTable: VertexDedupTable (기본) 또는 MapDedupTable (비교용)
+// submeshes가 있으면 usemtl이 바뀌는 위치마다 구간을 기록 (파일 순서, 같은 재질이 여러 번 나올 수 있음)
+template <typename DedupTable>
+static int buildIndexedMeshWith(const OBJRawData& raw, vector<float>& vertices, vector<unsigned int>& indices, int& face_count,
+                                vector<SubMesh>* submeshes = nullptr) {
+    int vertex_count = (int)raw.positions.size();
+    int texcoord_count = (int)raw.texcoords.size();
+
+    vertices.clear();
+    indices.clear();
+    face_count = 0;
+
+    DedupTable vertex_map(max(raw.positions.size(), raw.texcoords.size()));
+    int current_vertex_index = 0;
+    vector<int> face_vertex_indices;
+
+    // 출력 크기도 미리 예약 (정점은 대략 position 수, 인덱스는 꼭짓점 수 기준)
+    vertices.reserve(max(raw.positions.size(), raw.texcoords.size()) * 5);
+    indices.reserve(raw.corners.size() * 3 / 2);
+
+    if (submeshes) {
+        submeshes->clear();
+        submeshes->push_back(SubMesh()); // 첫 usemtl 전의 face (재질 없음)
+    }
+    size_t nextDirective = 0;
+
+    size_t cornerOffset = 0;
+    for (size_t f = 0; f < raw.faceSizes.size(); f++) {
+        int faceSize = raw.faceSizes[f];
+        face_vertex_indices.clear();
+
+        // 이 face 앞에 있는 usemtl → 새 구간 시작
+        for (; submeshes && nextDirective < raw.directives.size() && raw.directives[nextDirective].faceIndex <= f; nextDirective++) {
+            if (raw.directives[nextDirective].isMaterialLib) continue;
+            SubMesh segment;
+            segment.materialName = raw.directives[nextDirective].name;
+            segment.firstIndex = (unsigned int)indices.size();
+            submeshes->push_back(segment);
+        }
+
+        for (int c = 0; c < faceSize; c++) {
+            const OBJCorner& corner = raw.corners[cornerOffset + c];
+            int vertex_idx = corner.vertex;
+            int texcoord_idx = corner.texcoord == 0 ? -1 : corner.texcoord;
+
+            if (vertex_idx < 1 || vertex_idx > vertex_count) {
+                printf("Invalid vertex index: %d (max: %d) in face #%zu\n", vertex_idx, vertex_count, f + 1);
+                face_vertex_indices.clear();
+                break;
+            }
+            if (texcoord_idx != -1 && (texcoord_idx < 1 || texcoord_idx > texcoord_count)) {
+                printf("Invalid texture coordinate index: %d (max: %d) in face #%zu\n", texcoord_idx, texcoord_count, f + 1);
+                texcoord_idx = -1;
+            }
+
+            int vertex_id = vertex_map.findOrInsert(vertex_idx - 1, texcoord_idx - 1, current_vertex_index);
+            if (vertex_id == current_vertex_index) {
+                const glm::vec3& pos = raw.positions[vertex_idx - 1];
+                vertices.push_back(pos.x);
+                vertices.push_back(pos.y);
+                vertices.push_back(pos.z);
+                if (texcoord_idx != -1) {
+                    const glm::vec2& tex = raw.texcoords[texcoord_idx - 1];
+                    vertices.push_back(tex.x);
+                    vertices.push_back(tex.y);
+                } else {
+                    vertices.push_back(0.0f);
+                    vertices.push_back(0.0f);
+                }
+                current_vertex_index++;
+            }
+            face_vertex_indices.push_back(vertex_id);
+        }
+        cornerOffset += faceSize;
+
+        // fan triangulation (삼각형/사각형도 같은 순서)
+        for (size_t i = 1; i + 1 < face_vertex_indices.size(); i++) {
+            indices.push_back(face_vertex_indices[0]);
+            indices.push_back(face_vertex_indices[i]);
+            indices.push_back(face_vertex_indices[i + 1]);
+            face_count++;
+        }
+    }
+
+    // 구간 길이 채우기
+    if (submeshes) {
+        for (size_t i = 0; i < submeshes->size(); i++) {
+            size_t end = i + 1 < submeshes->size() ? (*submeshes)[i + 1].firstIndex : indices.size();
+            (*submeshes)[i].indexCount = (unsigned int)(end - (*submeshes)[i].firstIndex);
+        }
+    }
+    return current_vertex_index;
+}
+
+// 같은 재질 구간을 하나로 모음 (재질이 처음 나온 순서대로, 재질 안에서는 파일 순서 유지)
+// 이미 재질별로 모여 있으면 인덱스는 그대로 두고 빈 구간만 제거
+static void groupSubMeshesByMaterial(vector<unsigned int>& indices, vector<SubMesh>& submeshes) {
+    vector<SubMesh> grouped;
+    map<string, size_t> groupOf;
+    vector<vector<size_t> > members;
+    for (size_t i = 0; i < submeshes.size(); i++) {
+        if (submeshes[i].indexCount == 0) continue;
+        map<string, size_t>::iterator it = groupOf.find(submeshes[i].materialName);
+        if (it == groupOf.end()) {
+            it = groupOf.insert(make_pair(submeshes[i].materialName, grouped.size())).first;
+            grouped.push_back(submeshes[i]);
+            members.push_back(vector<size_t>());
+        }
+        members[it->second].push_back(i);
+    }
+
+    bool alreadyGrouped = true;
+    for (size_t g = 0; g < members.size(); g++)
+        alreadyGrouped = alreadyGrouped && members[g].size() == 1;
+
+    if (!alreadyGrouped) {
+        vector<unsigned int> reordered;
+        reordered.reserve(indices.size());
+        for (size_t g = 0; g < grouped.size(); g++) {
+            grouped[g].firstIndex = (unsigned int)reordered.size();
+            for (size_t m = 0; m < members[g].size(); m++) {
+                const SubMesh& segment = submeshes[members[g][m]];
+                reordered.insert(reordered.end(), indices.begin() + segment.firstIndex,
+                                 indices.begin() + segment.firstIndex + segment.indexCount);
+            }
+            grouped[g].indexCount = (unsigned int)(reordered.size() - grouped[g].firstIndex);
+        }
+        indices.swap(reordered);
+    }
+    submeshes.swap(grouped);
+}
+
+// MTL에서 읽은 재질 값 채우기 (applyOBJDirectives로 materials가 로드된 뒤 호출)
+void resolveSubMeshMaterials(vector<SubMesh>& submeshes) {
+    for (size_t i = 0; i < submeshes.size(); i++) {
+        map<string, Material>::iterator it = materials.find(submeshes[i].materialName);
+        if (it == materials.end()) continue;
+        submeshes[i].diffuse = it->second.diffuse;
+        submeshes[i].texturePath = it->second.texture_map;
+    }
+}
+
+// 각 모델의 재질별 구간 (main에서 로드 후 텍스처까지 채움)
+vector<SubMesh> cubeSubMeshes;
+vector<SubMesh> piggySubMeshes;
+
+// 같은 이미지 파일은 한 번만 로드 (재질 여러 개가 같은 map_Kd를 쓰는 경우)
+map<string, GLuint> loadedTextures;
+
+// 작업 스레드에서 디코드 중인 파일이면 placeholderColor로 채운 이름을 먼저 돌려줌 (디코드가 끝나면 같은 이름에 올림)
+GLuint loadTextureCached(const string& path, const glm::vec3& placeholderColor = glm::vec3(1.0f)) {
+    map<string, GLuint>::iterator it = loadedTextures.find(path);
+    if (it != loadedTextures.end()) return it->second;
+    map<string, AsyncTexture>::iterator pending = asyncTextures.find(path);
+    GLuint textureID;
+    if (pending != asyncTextures.end()) {
+        textureID = createPlaceholderTexture(placeholderColor);
+        pending->second.textureID = textureID;
+        pollAsyncTextures();
+    } else {
+        textureID = loadTexture(path.c_str());
+    }
+    loadedTextures[path] = textureID;
+    return textureID;
+}
+
+// map_Kd가 있는 구간의 텍스처를 로드하고(아틀라스에 있으면 그 자리), 텍스처 → 색상 순으로 정렬해서 그릴 때 상태 변경을 줄임
+void loadSubMeshTextures(vector<SubMesh>& submeshes) {
+    for (size_t i = 0; i < submeshes.size(); i++) {
+        SubMesh& submesh = submeshes[i];
+        if (submesh.texturePath.empty()) continue;
+        const AtlasEntry* entry = findAtlasEntry(textureAtlas, submesh.texturePath);
+        if (entry) {
+            submesh.textureID = textureAtlas.textureID;
+            submesh.atlasLayer = entry->layer;
+            submesh.atlasRect = entry->rect;
+        } else {
+            submesh.textureID = loadTextureCached(submesh.texturePath, submesh.diffuse);
+        }
+    }
+    stable_sort(submeshes.begin(), submeshes.end(), [](const SubMesh& a, const SubMesh& b) {
+        if (a.textureID != b.textureID) return a.textureID < b.textureID;
+        if (a.atlasLayer != b.atlasLayer) return a.atlasLayer < b.atlasLayer;
+        if (a.diffuse.r != b.diffuse.r) return a.diffuse.r < b.diffuse.r;
+        if (a.diffuse.g != b.diffuse.g) return a.diffuse.g < b.diffuse.g;
+        return a.diffuse.b < b.diffuse.b;
+    });
+}
+
+static int buildIndexedMesh(const OBJRawData& raw, vector<float>& vertices, vector<unsigned int>& indices, int& face_count,
+                            vector<SubMesh>* submeshes = nullptr) {
+    int unique_vertices = buildIndexedMeshWith<VertexDedupTable>(raw, vertices, indices, face_count, submeshes);
+    if (submeshes) groupSubMeshesByMaterial(indices, *submeshes);
+    return unique_vertices;
+}
+
+// 원본 position 전체의 바운딩 박스 (loadOBJ의 centerOffset 계산과 동일)
+static bool computePositionBounds(const vector<glm::vec3>& positions, glm::vec3& minBound, glm::vec3& maxBound) {
+    if (positions.empty()) return false;
+
+    minBound = positions[0];
+    maxBound = positions[0];
+    for (const auto& vertex : positions) {
+        minBound.x = min(minBound.x, vertex.x);
+        minBound.y = min(minBound.y, vertex.y);
+        minBound.z = min(minBound.z, vertex.z);
+        maxBound.x = max(maxBound.x, vertex.x);
+        maxBound.y = max(maxBound.y, vertex.y);
+        maxBound.z = max(maxBound.z, vertex.z);
+    }
+    return true;
+}
+
+static void applyCenterOffset(const glm::vec3& minBound, const glm::vec3& maxBound, glm::vec3* centerOffset) {
+    if (centerOffset == nullptr) return;
+
+    *centerOffset = (minBound + maxBound) * 0.5f;
+    printf("Bounding box: min(%.3f, %.3f, %.3f), max(%.3f, %.3f, %.3f)\n",
+           minBound.x, minBound.y, minBound.z, maxBound.x, maxBound.y, maxBound.z);
+    printf("Center offset: (%.3f, %.3f, %.3f)\n",
+           centerOffset->x, centerOffset->y, centerOffset->z);
+}
+
+// ===== 바이너리 메시 캐시 (.meshbin) =====
+// 처음 loadOBJFast가 성공하면 최종 인터리브 정점/인덱스 배열, 바운딩 박스, 재질 정보를 OBJ 옆에 저장
+// 다음 실행부터는 파싱 없이 캐시를 메모리 매핑해서 배열을 그대로 복사 (memcpy 속도)
+// 원본 파일의 크기 + 수정 시간 + 내용 해시가 모두 같아야 유효
+
+bool useMeshCache = true;
+
+static const char MESHBIN_MAGIC[8] = { 'M', 'E', 'S', 'H', 'B', 'I', 'N', '\0' };
+static const uint32_t MESHBIN_VERSION = 3; // 레이아웃이 바뀌면 올릴 것 (이전 캐시는 자동 무효화)
+
+// 파일 앞부분 고정 헤더 (뒤에 재질 명령, 서브메시, 정점, 인덱스 순서로 저장, 오프셋은 8바이트 정렬)
+struct MeshBinHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t floatsPerVertex;  // 현재 5 (x, y, z, u, v)
+    uint64_t sourceSize;
+    int64_t sourceMtime;
+    uint64_t sourceHash;
+    uint64_t vertexFloatCount;
+    uint64_t indexCount;
+    uint64_t directiveCount;
+    uint64_t submeshCount;
+    uint64_t directiveOffset;  // 재질 명령 다음에 바로 서브메시 항목
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+    uint32_t hasBounds;
+    float boundsMin[3];
+    float boundsMax[3];
+    uint32_t groupedByMaterial; // 1이면 인덱스가 재질별로 모인 순서 (+ 서브메시 표), 0이면 파일 순서 (loadOBJ와 같음)
+};
+
+// 재질 명령 항목 (뒤에 이름 문자열이 nameLength 바이트 붙음)
+struct MeshBinDirective {
+    uint32_t isMaterialLib;
+    uint32_t nameLength;
+    uint64_t faceIndex;
+};
+
+// 서브메시 항목 (뒤에 재질 이름이 nameLength 바이트 붙음)
+struct MeshBinSubMesh {
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    uint32_t nameLength;
+    uint32_t reserved;
+};
+
+string meshCachePath(const char* objPath) {
+    return string(objPath) + ".meshbin";
+}
+
+// 원본 파일 크기와 수정 시간
+static bool statSourceFile(const char* path, uint64_t& size, int64_t& mtime) {
+#ifdef _WIN32
+    struct _stat64 st;
+    if (_stat64(path, &st) != 0) return false;
+#else
+    struct stat st;
+    if (stat(path, &st) != 0) return false;
+#endif
+    size = (uint64_t)st.st_size;
+    mtime = (int64_t)st.st_mtime;
+    return true;
+}
+
+// 내용 해시 (8바이트 단위 multiply-xor, 파싱보다 수십 배 빠름)
+uint64_t hashBytes(const char* data, size_t size) {
+    uint64_t h = 0xcbf29ce484222325ull ^ (uint64_t)size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        h = (h ^ word) * 0x100000001b3ull;
+        h ^= h >> 29;
+    }
+    for (; i < size; i++)
+        h = (h ^ (uint8_t)data[i]) * 0x100000001b3ull;
+    return h;
+}
+
+static size_t alignTo8(size_t offset) {
+    return (offset + 7) & ~(size_t)7;
+}
+
+// 고정 크기 항목 + 이름 문자열을 8바이트 정렬로 이어붙임
+static void appendMeshBinEntry(vector<char>& bytes, const void* entry, size_t entrySize, const string& name) {
+    const char* entryBytes = (const char*)entry;
+    bytes.insert(bytes.end(), entryBytes, entryBytes + entrySize);
+    bytes.insert(bytes.end(), name.begin(), name.end());
+    bytes.resize(alignTo8(bytes.size()), 0);
+}
+
+// appendMeshBinEntry로 쓴 항목 읽기: 고정 크기 부분 → 이름 순서 (limit를 넘으면 false)
+static bool readMeshBinEntry(const MappedFile& cache, size_t& offset, size_t limit, void* entry, size_t entrySize) {
+    if (offset + entrySize > limit) return false;
+    memcpy(entry, cache.data + offset, entrySize);
+    offset += entrySize;
+    return true;
+}
+
+static bool readMeshBinName(const MappedFile& cache, size_t& offset, size_t limit, uint32_t nameLength, string& name) {
+    if (offset + nameLength > limit) return false;
+    name.assign(cache.data + offset, nameLength);
+    offset = alignTo8(offset + nameLength);
+    return true;
+}
+
+// 캐시 저장: 임시 파일에 쓰고 rename (중간에 실패해도 깨진 캐시가 남지 않게)
+bool writeMeshCache(const char* objPath, uint64_t sourceHash, const vector<float>& vertices, const vector<unsigned int>& indices,
+                    const vector<OBJDirective>& directives, const vector<SubMesh>& submeshes, bool groupedByMaterial,
+                    bool hasBounds, const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+    MeshBinHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MESHBIN_MAGIC, sizeof(header.magic));
+    header.version = MESHBIN_VERSION;
+    header.floatsPerVertex = 5;
+    if (!statSourceFile(objPath, header.sourceSize, header.sourceMtime)) return false;
+    header.sourceHash = sourceHash;
+    header.vertexFloatCount = vertices.size();
+    header.indexCount = indices.size();
+    header.directiveCount = directives.size();
+    header.submeshCount = submeshes.size();
+    header.hasBounds = hasBounds ? 1 : 0;
+    header.groupedByMaterial = groupedByMaterial ? 1 : 0;
+    for (int i = 0; i < 3; i++) {
+        header.boundsMin[i] = boundsMin[i];
+        header.boundsMax[i] = boundsMax[i];
+    }
+
+    // 재질 명령 + 서브메시 영역 직렬화
+    vector<char> directiveBytes;
+    for (size_t i = 0; i < directives.size(); i++) {
+        MeshBinDirective entry;
+        entry.isMaterialLib = directives[i].isMaterialLib ? 1 : 0;
+        entry.nameLength = (uint32_t)directives[i].name.size();
+        entry.faceIndex = directives[i].faceIndex;
+        appendMeshBinEntry(directiveBytes, &entry, sizeof(entry), directives[i].name);
+    }
+    for (size_t i = 0; i < submeshes.size(); i++) {
+        MeshBinSubMesh entry;
+        entry.firstIndex = submeshes[i].firstIndex;
+        entry.indexCount = submeshes[i].indexCount;
+        entry.nameLength = (uint32_t)submeshes[i].materialName.size();
+        entry.reserved = 0;
+        appendMeshBinEntry(directiveBytes, &entry, sizeof(entry), submeshes[i].materialName);
+    }
+
+    header.directiveOffset = alignTo8(sizeof(MeshBinHeader));
+    header.vertexOffset = header.directiveOffset + directiveBytes.size();
+    header.indexOffset = alignTo8(header.vertexOffset + vertices.size() * sizeof(float));
+
+    string cachePath = meshCachePath(objPath);
+    string tempPath = cachePath + ".tmp";
+    FILE* fp = fopen(tempPath.c_str(), "wb");
+    if (!fp) return false;
+
+    static const char zeros[8] = { 0 };
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1;
+    ok = ok && fwrite(zeros, 1, header.directiveOffset - sizeof(header), fp) == header.directiveOffset - sizeof(header);
+    if (ok && !directiveBytes.empty())
+        ok = fwrite(&directiveBytes[0], 1, directiveBytes.size(), fp) == directiveBytes.size();
+    if (ok && !vertices.empty())
+        ok = fwrite(&vertices[0], sizeof(float), vertices.size(), fp) == vertices.size();
+    size_t padding = (size_t)(header.indexOffset - (header.vertexOffset + vertices.size() * sizeof(float)));
+    ok = ok && fwrite(zeros, 1, padding, fp) == padding;
+    if (ok && !indices.empty())
+        ok = fwrite(&indices[0], sizeof(unsigned int), indices.size(), fp) == indices.size();
+    ok = (fclose(fp) == 0) && ok;
+
+    if (!ok) {
+        remove(tempPath.c_str());
+        return false;
+    }
+    remove(cachePath.c_str()); // Windows의 rename은 덮어쓰지 않음
+    if (rename(tempPath.c_str(), cachePath.c_str()) != 0) {
+        remove(tempPath.c_str());
+        return false;
+    }
+    printf("Mesh cache written: %s\n", cachePath.c_str());
+    return true;
+}
+
+// 캐시 읽기: 유효하지 않으면 false (호출한 쪽에서 OBJ 파싱으로 넘어감)
+// submeshes를 넘기면 재질별로 모인 캐시만, 안 넘기면 파일 순서 캐시만 씀 (다른 순서면 다시 파싱해서 덮어씀)
+bool loadMeshCache(const char* objPath, vector<float>& vertices, vector<unsigned int>& indices, glm::vec3& actualColor, glm::vec3* centerOffset = nullptr,
+                   vector<SubMesh>* submeshes = nullptr) {
+    string cachePath = meshCachePath(objPath);
+    MappedFile cache;
+    if (!mapFile(cachePath.c_str(), cache)) return false;
+
+    // 헤더와 각 영역이 파일 안에 있는지 먼저 확인
+    MeshBinHeader header;
+    bool valid = cache.size >= sizeof(header);
+    if (valid) {
+        memcpy(&header, cache.data, sizeof(header));
+        valid = memcmp(header.magic, MESHBIN_MAGIC, sizeof(header.magic)) == 0 &&
+                header.version == MESHBIN_VERSION && header.floatsPerVertex == 5 &&
+                header.directiveOffset <= header.vertexOffset &&
+                header.vertexOffset + header.vertexFloatCount * sizeof(float) <= header.indexOffset &&
+                header.indexOffset + header.indexCount * sizeof(unsigned int) <= cache.size &&
+                header.groupedByMaterial == (submeshes ? 1u : 0u);
+    }
+
+    // 원본 크기/수정 시간 → 같을 때만 내용 해시까지 비교
+    uint64_t sourceSize = 0;
+    int64_t sourceMtime = 0;
+    valid = valid && statSourceFile(objPath, sourceSize, sourceMtime) &&
+            sourceSize == header.sourceSize && sourceMtime == header.sourceMtime;
+    if (valid) {
+        MappedFile source;
+        valid = mapFile(objPath, source) && hashBytes(source.data, source.size) == header.sourceHash;
+        unmapFile(source);
+    }
+    if (!valid) {
+        printf("Mesh cache missing or stale: %s\n", cachePath.c_str());
+        unmapFile(cache);
+        return false;
+    }
+
+    printf("Loading mesh cache: %s\n", cachePath.c_str());
+
+    // 재질 명령 복원 → MTL 로드 및 색상 적용은 파싱할 때와 같은 함수로
+    OBJRawData materialsOnly;
+    vector<SubMesh> cachedSubMeshes;
+    size_t offset = (size_t)header.directiveOffset;
+    size_t limit = (size_t)header.vertexOffset;
+    for (uint64_t i = 0; i < header.directiveCount && valid; i++) {
+        MeshBinDirective entry;
+        OBJDirective directive;
+        if (!readMeshBinEntry(cache, offset, limit, &entry, sizeof(entry))) {
+            valid = false;
+            break;
+        }
+        valid = readMeshBinName(cache, offset, limit, entry.nameLength, directive.name);
+        directive.isMaterialLib = entry.isMaterialLib != 0;
+        directive.faceIndex = (size_t)entry.faceIndex;
+        materialsOnly.directives.push_back(directive);
+    }
+    for (uint64_t i = 0; i < header.submeshCount && valid; i++) {
+        MeshBinSubMesh entry;
+        SubMesh submesh;
+        if (!readMeshBinEntry(cache, offset, limit, &entry, sizeof(entry))) {
+            valid = false;
+            break;
+        }
+        valid = readMeshBinName(cache, offset, limit, entry.nameLength, submesh.materialName) &&
+                (uint64_t)entry.firstIndex + entry.indexCount <= header.indexCount;
+        submesh.firstIndex = entry.firstIndex;
+        submesh.indexCount = entry.indexCount;
+        cachedSubMeshes.push_back(submesh);
+    }
+    if (!valid) {
+        printf("Mesh cache corrupted: %s\n", cachePath.c_str());
+        unmapFile(cache);
+        return false;
+    }
+    applyOBJDirectives(materialsOnly, actualColor);
+    if (submeshes) {
+        submeshes->swap(cachedSubMeshes);
+        resolveSubMeshMaterials(*submeshes);
+    }
+
+    const float* cachedVertices = (const float*)(cache.data + header.vertexOffset);
+    const unsigned int* cachedIndices = (const unsigned int*)(cache.data + header.indexOffset);
+    vertices.assign(cachedVertices, cachedVertices + header.vertexFloatCount);
+    indices.assign(cachedIndices, cachedIndices + header.indexCount);
+    unmapFile(cache);
+
+    if (header.hasBounds) {
+        glm::vec3 minBound(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+        glm::vec3 maxBound(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+        applyCenterOffset(minBound, maxBound, centerOffset);
+    }
+
+    printf("Mesh cache loaded: %zu vertices (pos+tex), %zu indices\n", vertices.size() / 5, indices.size());
+    return true;
+}
+
+// OBJ 파일 파싱 (메모리 매핑 버전). 출력은 loadOBJ와 같음
+// threadCount > 1이면 청크 병렬 파싱 (중복 제거는 정점 순서를 지키기 위해 직렬)
+// submeshes가 있으면 usemtl 기준으로 face를 재질별로 모으고 구간 표를 채움
+bool loadOBJFast(const char* path, vector<float>& vertices, vector<unsigned int>& indices, glm::vec3& actualColor, glm::vec3* centerOffset = nullptr,
+                 int threadCount = 1, vector<SubMesh>* submeshes = nullptr) {
+    MappedFile file;
+    if (!mapFile(path, file)) {
+        printf("Failed to open file: %s\n", path);
+        return false;
+    }
+
+    printf("Loading OBJ file (mmap): %s\n", path);
+
+    OBJRawData raw;
+    if (threadCount > 1) {
+        parseOBJBufferParallel(file.data, file.size, raw, threadCount);
+    } else {
+        // 대략적인 크기 예측으로 재할당 줄이기 (한 줄 평균 30바이트 이상)
+        raw.positions.reserve(file.size / 96);
+        raw.texcoords.reserve(file.size / 96);
+        raw.corners.reserve(file.size / 24);
+        raw.faceSizes.reserve(file.size / 96);
+        parseOBJBuffer(file.data, file.size, raw);
+    }
+    // 캐시 저장용 내용 해시 (파일이 매핑되어 있을 때 계산)
+    uint64_t sourceHash = useMeshCache ? hashBytes(file.data, file.size) : 0;
+    unmapFile(file);
+
+    applyOBJDirectives(raw, actualColor);
+
+    printf("Loaded %zu vertices, %zu texture coordinates\n", raw.positions.size(), raw.texcoords.size());
+
+    // 재질별로 모으는 것은 구간 표를 달라고 할 때만 (아니면 loadOBJ와 같은 파일 순서). 캐시에는 어느 순서인지 같이 저장
+    vector<SubMesh> localSubMeshes;
+    vector<SubMesh>& meshSubMeshes = submeshes ? *submeshes : localSubMeshes;
+    bool groupByMaterial = submeshes != nullptr;
+
+    int face_count = 0;
+    int unique_vertices = buildIndexedMesh(raw, vertices, indices, face_count, groupByMaterial ? &meshSubMeshes : nullptr);
+    resolveSubMeshMaterials(meshSubMeshes);
+
+    glm::vec3 minBound(0.0f), maxBound(0.0f);
+    bool hasBounds = computePositionBounds(raw.positions, minBound, maxBound);
+    if (hasBounds) applyCenterOffset(minBound, maxBound, centerOffset);
+
+    printf("OBJ file loaded: %d unique vertices (pos+tex), %d triangles, %zu indices\n",
+           unique_vertices, face_count, indices.size());
+
+    if (useMeshCache && !writeMeshCache(path, sourceHash, vertices, indices, raw.directives, meshSubMeshes, groupByMaterial, hasBounds, minBound, maxBound))
+        printf("Failed to write mesh cache for %s\n", path);
+    return true;
+}
+
+// 로더 선택 (iostream: 기존 loadOBJ, mmap: loadOBJFast, parallel: loadOBJFast + 모든 코어)
+enum OBJLoaderMode {
+    OBJ_LOADER_IOSTREAM = 0,
+    OBJ_LOADER_MMAP = 1,
+    OBJ_LOADER_PARALLEL = 2
+};
+OBJLoaderMode objLoaderMode = OBJ_LOADER_PARALLEL;
+
+// submeshes: 재질별 인덱스 구간 (iostream 로더는 전체를 마지막 재질 색상 구간 하나로)
+bool loadMesh(const char* path, vector<float>& vertices, vector<unsigned int>& indices, glm::vec3& actualColor, glm::vec3* centerOffset = nullptr,
+              vector<SubMesh>* submeshes = nullptr) {
+    if (objLoaderMode == OBJ_LOADER_IOSTREAM) {
+        if (!loadOBJ(path, vertices, indices, actualColor, centerOffset)) return false;
+        if (submeshes) {
+            SubMesh whole;
+            whole.indexCount = (unsigned int)indices.size();
+            whole.diffuse = actualColor;
+            submeshes->assign(1, whole);
+        }
+        return true;
+    }
+    if (useMeshCache && loadMeshCache(path, vertices, indices, actualColor, centerOffset, submeshes))
+        return true;
+    if (objLoaderMode == OBJ_LOADER_PARALLEL)
+        return loadOBJFast(path, vertices, indices, actualColor, centerOffset, loaderThreadCount(), submeshes);
+    return loadOBJFast(path, vertices, indices, actualColor, centerOffset, 1, submeshes);
+}
+
+// OBJ를 파싱하기 전에 mtllib이 가리키는 MTL의 map_Kd 경로를 모음 (중복 없이 paths 뒤에 추가)
+// mtllib은 보통 첫 face 앞에 있으므로 거기까지만 훑음. 그 뒤에 나오는 것은 파싱 후 loadMTL이 예전처럼 디코드를 시작
+void collectOBJTexturePaths(const char* objPath, vector<string>& paths) {
+    MappedFile file;
+    if (!mapFile(objPath, file)) return;
+    vector<string> libraries;
+    const char* p = file.data;
+    const char* end = file.data + file.size;
+    while (p < end) {
+        const char* lineEnd = (const char*)memchr(p, '\n', (size_t)(end - p));
+        if (lineEnd == nullptr) lineEnd = end;
+        const char* line = skipSpaces(p, lineEnd);
+        if (lineEnd - line > 1 && line[0] == 'f' && isSpaceChar(line[1])) break;
+        if (lineEnd - line > 7 && memcmp(line, "mtllib ", 7) == 0) {
+            const char* nameEnd = lineEnd;
+            while (nameEnd > line + 7 && isSpaceChar(nameEnd[-1])) nameEnd--;
+            libraries.push_back(string(line + 7, nameEnd));
+        }
+        p = lineEnd + 1;
+    }
+    unmapFile(file);
+
+    for (size_t i = 0; i < libraries.size(); i++) {
+        ifstream mtl(libraries[i].c_str(), ios::in);
+        string line;
+        while (getline(mtl, line)) {
+            stringstream ss(line);
+            string command, texturePath;
+            ss >> command;
+            if (command != "map_Kd" || !(ss >> texturePath)) continue;
+            if (find(paths.begin(), paths.end(), texturePath) == paths.end()) paths.push_back(texturePath);
+        }
+    }
+}
+
+// ===== 텍스처 캐시 (KTX2 컨테이너) =====
+// 디코드 + 뒤집기 + mip 체인 (+ 블록 압축)까지 끝난 레벨을 PNG 옆에 KTX2 파일로 저장
+// (비압축 PiggyBankUVTex.png.ktx2, 압축 PiggyBankUVTex.png.bc1.ktx2)
+// 다음 실행부터는 stb_image의 inflate / 필터 복원, mip 생성, 인코딩 없이 파일을 매핑해서 레벨마다 매핑된 메모리를 그대로 업로드
+// 메시 캐시와 같이 원본 PNG의 크기 + 수정 시간 + 내용 해시가 모두 같아야 유효 (키/값 항목 "ACGsource"에 저장)
+// KTX2 규칙: 레벨 인덱스는 레벨 0부터, 데이터는 작은 레벨부터, 행 패딩 없음, 레벨 시작은 lcm(텍셀 블록 크기, 4) 정렬
+// 행이 아래부터 저장돼 있으므로 (GL 방향) KTXorientation = "ru"
+
+bool useTextureCache = true;
+
+static const unsigned char KTX2_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+static const char* KTX2_SOURCE_KEY = "ACGsource";
+static const uint32_t KTX2_CACHE_VERSION = 2; // ACGsource 값에 같이 저장, 인코더나 mip 필터가 바뀌면 올릴 것
+
+// 파일 앞 80바이트 (헤더 + 인덱스). 뒤에 레벨 인덱스 levelCount개, DFD, 키/값, 레벨 데이터
+struct KTX2Header {
+    unsigned char identifier[12];
+    uint32_t vkFormat;
+    uint32_t typeSize;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;
+    uint32_t layerCount;
+    uint32_t faceCount;
+    uint32_t levelCount;
+    uint32_t supercompressionScheme;
+    uint32_t dfdByteOffset;
+    uint32_t dfdByteLength;
+    uint32_t kvdByteOffset;
+    uint32_t kvdByteLength;
+    uint64_t sgdByteOffset;
+    uint64_t sgdByteLength;
+};
+
+struct KTX2LevelIndex {
+    uint64_t byteOffset;
+    uint64_t byteLength;
+    uint64_t uncompressedByteLength;
+};
+
+// 원본 PNG 정보 (ACGsource 값)
+struct KTX2SourceInfo {
+    uint32_t version;
+    uint32_t channels;
+    uint64_t sourceSize;
+    int64_t sourceMtime;
+    uint64_t sourceHash;
+};
+
+string textureCachePath(const char* path, TextureCompression format) {
+    if (format == TEXTURE_UNCOMPRESSED) return string(path) + ".ktx2";
+    return string(path) + "." + TEXTURE_COMPRESSION_NAMES[format] + ".ktx2";
+}
+
+// VkFormat 값 (GL에 올리는 형식과 같이 전부 UNORM)
+static uint32_t ktx2VkFormat(TextureCompression format, int channels) {
+    if (format == TEXTURE_BC1) return 131; // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+    if (format == TEXTURE_BC3) return 137; // VK_FORMAT_BC3_UNORM_BLOCK
+    if (format == TEXTURE_BC7) return 145; // VK_FORMAT_BC7_UNORM_BLOCK
+    if (channels == 1) return 9;           // VK_FORMAT_R8_UNORM
+    if (channels == 3) return 23;          // VK_FORMAT_R8G8B8_UNORM
+    return 37;                             // VK_FORMAT_R8G8B8A8_UNORM
+}
+
+// 텍셀 블록 하나의 바이트 수 (비압축이면 텍셀 하나)
+static size_t ktx2BlockBytes(TextureCompression format, int channels) {
+    return format == TEXTURE_UNCOMPRESSED ? (size_t)channels : compressedBlockBytes(format);
+}
+
+static size_t ktx2LevelBytes(TextureCompression format, int channels, int width, int height) {
+    if (format == TEXTURE_UNCOMPRESSED) return (size_t)width * height * channels;
+    return (size_t)((width + 3) / 4) * ((height + 3) / 4) * compressedBlockBytes(format);
+}
+
+static size_t alignTo(size_t offset, size_t alignment) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+// Khronos Data Format 기본 블록 하나 (샘플: 비압축은 채널마다 8비트, BC는 64/128비트 블록)
+static vector<uint32_t> buildKTX2DFD(TextureCompression format, int channels) {
+    struct Sample { uint32_t channel, bitOffset, bitLength, upper; };
+    vector<Sample> samples;
+    uint32_t colorModel = 1; // KHR_DF_MODEL_RGBSDA
+    if (format == TEXTURE_UNCOMPRESSED) {
+        for (int c = 0; c < channels; c++) samples.push_back(Sample{ isAlphaChannel(c, channels) ? 15u : (uint32_t)c, (uint32_t)c * 8, 7, 255 });
+    } else if (format == TEXTURE_BC1) {
+        colorModel = 128; // KHR_DF_MODEL_BC1A
+        samples.push_back(Sample{ 0, 0, 63, 0xFFFFFFFFu });
+    } else if (format == TEXTURE_BC3) {
+        colorModel = 130; // KHR_DF_MODEL_BC3
+        samples.push_back(Sample{ 15, 0, 63, 0xFFFFFFFFu });
+        samples.push_back(Sample{ 0, 64, 63, 0xFFFFFFFFu });
+    } else {
+        colorModel = 134; // KHR_DF_MODEL_BC7
+        samples.push_back(Sample{ 0, 0, 127, 0xFFFFFFFFu });
+    }
+
+    uint32_t blockSize = 24 + 16 * (uint32_t)samples.size();
+    vector<uint32_t> words;
+    words.push_back(4 + blockSize);                        // dfdTotalSize
+    words.push_back(0);                                    // vendorId 0 (Khronos), descriptorType 0 (basic)
+    words.push_back(2 | (blockSize << 16));                // versionNumber 2, descriptorBlockSize
+    words.push_back(colorModel | (1u << 8) | (1u << 16)); // primaries BT709, transfer linear, flags 0
+    words.push_back(format == TEXTURE_UNCOMPRESSED ? 0 : (3u | (3u << 8))); // texel block 1x1 또는 4x4 (값 - 1)
+    words.push_back((uint32_t)ktx2BlockBytes(format, channels)); // bytesPlane0
+    words.push_back(0);
+    for (size_t i = 0; i < samples.size(); i++) {
+        words.push_back(samples[i].bitOffset | (samples[i].bitLength << 16) | (samples[i].channel << 24));
+        words.push_back(0);                 // samplePosition
+        words.push_back(0);                 // sampleLower
+        words.push_back(samples[i].upper);  // sampleUpper
+    }
+    return words;
+}
+
+// 키/값 항목 하나 (길이 + 키 + NUL + 값, 4바이트 정렬). 키는 코드 포인트 순서로 넣어야 함
+static void appendKTX2KeyValue(vector<unsigned char>& bytes, const char* key, const void* value, size_t valueSize) {
+    uint32_t length = (uint32_t)(strlen(key) + 1 + valueSize);
+    const unsigned char* lengthBytes = (const unsigned char*)&length;
+    bytes.insert(bytes.end(), lengthBytes, lengthBytes + 4);
+    bytes.insert(bytes.end(), key, key + strlen(key) + 1);
+    bytes.insert(bytes.end(), (const unsigned char*)value, (const unsigned char*)value + valueSize);
+    bytes.resize(alignTo(bytes.size(), 4), 0);
+}
+
+bool writeTextureCache(const char* path, const KTX2SourceInfo& source, const DecodedTexture& texture) {
+    vector<uint32_t> dfd = buildKTX2DFD(texture.format, texture.channels);
+    vector<unsigned char> kvd;
+    appendKTX2KeyValue(kvd, KTX2_SOURCE_KEY, &source, sizeof(source));
+    appendKTX2KeyValue(kvd, "KTXorientation", "ru", 3);
+    appendKTX2KeyValue(kvd, "KTXwriter", "ACG_HW2", 8);
+
+    KTX2Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.identifier, KTX2_IDENTIFIER, sizeof(header.identifier));
+    header.vkFormat = ktx2VkFormat(texture.format, texture.channels);
+    header.typeSize = 1;
+    header.pixelWidth = (uint32_t)texture.levels[0].width;
+    header.pixelHeight = (uint32_t)texture.levels[0].height;
+    header.faceCount = 1;
+    header.levelCount = (uint32_t)texture.levels.size();
+    header.dfdByteOffset = (uint32_t)(sizeof(header) + texture.levels.size() * sizeof(KTX2LevelIndex));
+    header.dfdByteLength = (uint32_t)(dfd.size() * sizeof(uint32_t));
+    header.kvdByteOffset = header.dfdByteOffset + header.dfdByteLength;
+    header.kvdByteLength = (uint32_t)kvd.size();
+
+    // 레벨 데이터는 작은 레벨부터, lcm(블록 바이트, 4) 정렬 (RGB8이면 12)
+    size_t alignment = 4;
+    while (alignment % ktx2BlockBytes(texture.format, texture.channels) != 0) alignment += 4;
+    vector<KTX2LevelIndex> levelIndex(texture.levels.size());
+    size_t offset = header.kvdByteOffset + header.kvdByteLength;
+    for (size_t i = texture.levels.size(); i-- > 0;) {
+        offset = alignTo(offset, alignment);
+        levelIndex[i].byteOffset = offset;
+        levelIndex[i].byteLength = texture.levels[i].size;
+        levelIndex[i].uncompressedByteLength = texture.levels[i].size;
+        offset += texture.levels[i].size;
+    }
+
+    string cachePath = textureCachePath(path, texture.format);
+    string tempPath = cachePath + ".tmp";
+    FILE* fp = fopen(tempPath.c_str(), "wb");
+    if (!fp) return false;
+
+    static const char zeros[16] = { 0 };
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+              fwrite(&levelIndex[0], sizeof(KTX2LevelIndex), levelIndex.size(), fp) == levelIndex.size() &&
+              fwrite(&dfd[0], sizeof(uint32_t), dfd.size(), fp) == dfd.size() &&
+              fwrite(&kvd[0], 1, kvd.size(), fp) == kvd.size();
+    size_t written = header.kvdByteOffset + header.kvdByteLength;
+    for (size_t i = texture.levels.size(); i-- > 0 && ok;) {
+        size_t padding = (size_t)levelIndex[i].byteOffset - written;
+        ok = fwrite(zeros, 1, padding, fp) == padding &&
+             fwrite(texture.levels[i].data, 1, texture.levels[i].size, fp) == texture.levels[i].size;
+        written = (size_t)(levelIndex[i].byteOffset + levelIndex[i].byteLength);
+    }
+    ok = (fclose(fp) == 0) && ok;
+
+    if (!ok) {
+        remove(tempPath.c_str());
+        return false;
+    }
+    remove(cachePath.c_str()); // Windows의 rename은 덮어쓰지 않음
+    if (rename(tempPath.c_str(), cachePath.c_str()) != 0) {
+        remove(tempPath.c_str());
+        return false;
+    }
+    printf("Texture cache written: %s (%.2f MB)\n", cachePath.c_str(), written / (1024.0 * 1024.0));
+    return true;
+}
+
+// 키/값 영역에서 key의 값 (없으면 nullptr)
+static const unsigned char* findKTX2Value(const char* kvd, size_t kvdSize, const char* key, size_t& valueSize) {
+    size_t offset = 0, keySize = strlen(key) + 1;
+    while (offset + 4 <= kvdSize) {
+        uint32_t length;
+        memcpy(&length, kvd + offset, 4);
+        if (length > kvdSize - offset - 4) return nullptr;
+        if (length >= keySize && memcmp(kvd + offset + 4, key, keySize) == 0) {
+            valueSize = length - keySize;
+            return (const unsigned char*)kvd + offset + 4 + keySize;
+        }
+        offset = alignTo(offset + 4 + length, 4);
+    }
+    return nullptr;
+}
+
+// 캐시 매핑: 유효하지 않으면 false (호출한 쪽에서 PNG 디코드로 넘어감). 성공하면 texture.levels가 매핑을 가리킴
+static bool readTextureCache(const char* path, TextureCompression format, DecodedTexture& texture) {
+    string cachePath = textureCachePath(path, format);
+    shared_ptr<MappedFile> cache(new MappedFile(), [](MappedFile* file) {
+        unmapFile(*file);
+        delete file;
+    });
+    if (!mapFile(cachePath.c_str(), *cache)) return false;
+
+    // 헤더, 레벨 인덱스, 키/값이 파일 안에 있는지
+    KTX2Header header;
+    bool valid = cache->size >= sizeof(header);
+    if (valid) {
+        memcpy(&header, cache->data, sizeof(header));
+        valid = memcmp(header.identifier, KTX2_IDENTIFIER, sizeof(header.identifier)) == 0 && header.levelCount > 0 &&
+                header.pixelWidth > 0 && header.pixelHeight > 0 && header.supercompressionScheme == 0 &&
+                sizeof(header) + (uint64_t)header.levelCount * sizeof(KTX2LevelIndex) <= cache->size &&
+                (uint64_t)header.kvdByteOffset + header.kvdByteLength <= cache->size;
+    }
+
+    // 원본 PNG 정보 -> 크기/수정 시간이 같을 때만 내용 해시까지 비교
+    KTX2SourceInfo source;
+    size_t valueSize = 0;
+    const unsigned char* value = valid ? findKTX2Value(cache->data + header.kvdByteOffset, header.kvdByteLength, KTX2_SOURCE_KEY, valueSize) : nullptr;
+    valid = value != nullptr && valueSize == sizeof(source);
+    if (valid) {
+        memcpy(&source, value, sizeof(source));
+        valid = source.version == KTX2_CACHE_VERSION && header.vkFormat == ktx2VkFormat(format, (int)source.channels);
+    }
+    uint64_t sourceSize = 0;
+    int64_t sourceMtime = 0;
+    valid = valid && statSourceFile(path, sourceSize, sourceMtime) &&
+            sourceSize == source.sourceSize && sourceMtime == source.sourceMtime;
+    if (valid) {
+        MappedFile png;
+        valid = mapFile(path, png) && hashBytes(png.data, png.size) == source.sourceHash;
+        unmapFile(png);
+    }
+
+    // 레벨 크기가 텍셀/블록 수와 맞고 파일 안에 있는지
+    texture.levels.clear();
+    for (uint32_t i = 0; i < header.levelCount && valid; i++) {
+        KTX2LevelIndex entry;
+        memcpy(&entry, cache->data + sizeof(header) + i * sizeof(KTX2LevelIndex), sizeof(entry));
+        TextureLevelData level;
+        level.width = max(1, (int)(header.pixelWidth >> i));
+        level.height = max(1, (int)(header.pixelHeight >> i));
+        level.size = ktx2LevelBytes(format, (int)source.channels, level.width, level.height);
+        valid = entry.byteLength == level.size && entry.byteOffset + entry.byteLength <= cache->size;
+        level.data = (const unsigned char*)cache->data + entry.byteOffset;
+        texture.levels.push_back(level);
+    }
+    if (!valid) {
+        printf("Texture cache missing or stale: %s\n", cachePath.c_str());
+        texture.levels.clear();
+        return false;
+    }
+    texture.format = format;
+    texture.channels = (int)source.channels;
+    texture.mapping = cache;
+    printf("Mapped texture cache: %s (%u levels)\n", cachePath.c_str(), header.levelCount);
+    return true;
+}
+
+bool decodeTexture(const char* path, TextureCompression format, DecodedTexture& texture, int threadCount) {
+    chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+    if (useTextureCache && readTextureCache(path, format, texture)) {
+        printf("Texture cache hit: %s in %.1f ms\n", path, elapsedSeconds(start) * 1e3);
+        return true;
+    }
+
+    // PNG는 한 번만 읽음: 매핑해서 해시 + 메모리에서 디코드
+    KTX2SourceInfo source;
+    memset(&source, 0, sizeof(source));
+    source.version = KTX2_CACHE_VERSION;
+    MappedFile png;
+    if (!statSourceFile(path, source.sourceSize, source.sourceMtime) || !mapFile(path, png)) {
+        printf("Failed to load texture: %s\n", path);
+        return false;
+    }
+    source.sourceHash = useTextureCache ? hashBytes(png.data, png.size) : 0;
+
+    int width, height, channels;
+    stbi_set_flip_vertically_on_load_thread(true); // OpenGL UV 좌표계에 맞게 위 아래를 뒤집기 (스레드별 설정, 벤치마크가 전역 값을 바꿈)
+    unsigned char* data = stbi_load_from_memory((const stbi_uc*)png.data, (int)png.size, &width, &height, &channels, 0);
+    unmapFile(png);
+
+    if (!data) {
+        printf("Failed to load texture: %s\n", path);
+        printf("STB Error: %s\n", stbi_failure_reason());
+        return false;
+    }
+
+    printf("Loaded texture: %s (%dx%d, %d channels)\n", path, width, height, channels);
+    if (channels == 2) {
+        printf("Unsupported channel count: %d\n", channels);
+        stbi_image_free(data);
+        return false;
+    }
+    source.channels = (uint32_t)channels;
+
+    // 캐시에는 항상 1x1까지 전부 (--no-mipmaps는 올릴 때 레벨 0만)
+    if (generateMipmaps || useTextureCache) {
+        chrono::high_resolution_clock::time_point mipStart = chrono::high_resolution_clock::now();
+        buildMipChain(data, width, height, channels, texture.mips, threadCount);
+        printf("Mip chain: %zu levels, %.2f MB (level 0: %.2f MB), built in %.1f ms\n", texture.mips.levels.size(), texture.mips.byteSize() / (1024.0 * 1024.0),
+               texture.mips.levels[0].pixels.size() / (1024.0 * 1024.0), elapsedSeconds(mipStart) * 1e3);
+    } else {
+        texture.mips.channels = channels;
+        texture.mips.levels.assign(1, TextureLevel());
+        texture.mips.levels[0].width = width;
+        texture.mips.levels[0].height = height;
+        texture.mips.levels[0].pixels.assign(data, data + (size_t)width * height * channels);
+    }
+
+    // 메모리 해제
+    stbi_image_free(data);
+
+    texture.format = format;
+    texture.channels = channels;
+    texture.levels.clear();
+    if (format == TEXTURE_UNCOMPRESSED) {
+        for (size_t i = 0; i < texture.mips.levels.size(); i++) {
+            const TextureLevel& mip = texture.mips.levels[i];
+            TextureLevelData level = { mip.width, mip.height, &mip.pixels[0], mip.pixels.size() };
+            texture.levels.push_back(level);
+        }
+    } else {
+        chrono::high_resolution_clock::time_point encodeStart = chrono::high_resolution_clock::now();
+        compressMipChain(texture.mips, format, texture.compressed, threadCount);
+        texture.mips = TextureMipChain();
+        printf("Encoded %s to %s in %.1f ms\n", path, TEXTURE_COMPRESSION_NAMES[format], elapsedSeconds(encodeStart) * 1e3);
+        for (size_t i = 0; i < texture.compressed.levels.size(); i++) {
+            const CompressedLevel& mip = texture.compressed.levels[i];
+            TextureLevelData level = { mip.width, mip.height, &mip.blocks[0], mip.blocks.size() };
+            texture.levels.push_back(level);
+        }
+    }
+    printf("Texture decoded: %s in %.1f ms\n", path, elapsedSeconds(start) * 1e3);
+
+    if (useTextureCache && !writeTextureCache(path, source, texture))
+        printf("Failed to write texture cache: %s\n", textureCachePath(path, format).c_str());
+    return true;
+}
+
+// ===== 정점 포맷 (GPU 버퍼 레이아웃) =====
+// CPU 쪽 정점 배열은 항상 pos(3) + uv(2) float. GPU에 올릴 때 포맷을 골라 양자화할 수 있음
+// 셰이더는 position * positionScale + positionOffset, uv * texcoordScale + texcoordOffset 으로 복원
+
+struct VertexAttribute {
+    GLint size;
+    GLenum type;
+    GLboolean normalized;
+    size_t offset;
+};
+
+struct VertexFormat {
+    const char* name;
+    GLsizei stride;
+    VertexAttribute position;  // location = 0
+    VertexAttribute texcoord;  // location = 1
+};
+
+// float 20 bytes / 양자화 12 bytes (position 6 + 패딩 2 + uv 4, 4바이트 정렬 유지)
+const VertexFormat FLOAT_VERTEX_FORMAT = { "float32", 5 * sizeof(float), { 3, GL_FLOAT, GL_FALSE, 0 }, { 2, GL_FLOAT, GL_FALSE, 3 * sizeof(float) } };
+const VertexFormat SNORM16_VERTEX_FORMAT = { "snorm16", 12, { 3, GL_SHORT, GL_TRUE, 0 }, { 2, GL_UNSIGNED_SHORT, GL_TRUE, 8 } };
+const VertexFormat HALF_VERTEX_FORMAT = { "half", 12, { 3, GL_HALF_FLOAT, GL_FALSE, 0 }, { 2, GL_UNSIGNED_SHORT, GL_TRUE, 8 } };
+
+// 로드 시 옵션: 양자화는 손실이 있으므로 기본은 float 그대로
+const VertexFormat* meshVertexFormat = &FLOAT_VERTEX_FORMAT;
+
+// 메시마다 다른 복원 값 (양자화 기준은 메시의 AABB / UV 범위)
+struct VertexLayout {
+    const VertexFormat* format;
+    glm::vec3 positionScale;
+    glm::vec3 positionOffset;
+    glm::vec2 texcoordScale;
+    glm::vec2 texcoordOffset;
+
+    VertexLayout() : format(&FLOAT_VERTEX_FORMAT), positionScale(1.0f), positionOffset(0.0f), texcoordScale(1.0f), texcoordOffset(0.0f) {}
+};
+
+// float 버퍼(좌표축, 바운딩 박스, 스트리밍 페이지)용
+const VertexLayout FLOAT_VERTEX_LAYOUT;
+
+VertexLayout cubeVertexLayout;
+VertexLayout piggyVertexLayout;
+
+struct VertexFormatUniforms {
+    GLint positionScale;
+    GLint positionOffset;
+    GLint texcoordScale;
+    GLint texcoordOffset;
+};
+
+VertexFormatUniforms getVertexFormatUniforms(GLuint program) {
+    VertexFormatUniforms uniforms;
+    uniforms.positionScale = glGetUniformLocation(program, "positionScale");
+    uniforms.positionOffset = glGetUniformLocation(program, "positionOffset");
+    uniforms.texcoordScale = glGetUniformLocation(program, "texcoordScale");
+    uniforms.texcoordOffset = glGetUniformLocation(program, "texcoordOffset");
+    return uniforms;
+}
+
+// 현재 GL_ARRAY_BUFFER에 대해 속성 포인터를 설정하고 복원 uniform을 넘김
+void bindVertexLayout(const VertexLayout& layout, const VertexFormatUniforms& uniforms) {
+    const VertexFormat& format = *layout.format;
+    glVertexAttribPointer(0, format.position.size, format.position.type, format.position.normalized, format.stride, (void*)format.position.offset);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, format.texcoord.size, format.texcoord.type, format.texcoord.normalized, format.stride, (void*)format.texcoord.offset);
+    glEnableVertexAttribArray(1);
+
+    glUniform3fv(uniforms.positionScale, 1, &layout.positionScale[0]);
+    glUniform3fv(uniforms.positionOffset, 1, &layout.positionOffset[0]);
+    glUniform2fv(uniforms.texcoordScale, 1, &layout.texcoordScale[0]);
+    glUniform2fv(uniforms.texcoordOffset, 1, &layout.texcoordOffset[0]);
+}
+
+// IEEE half 변환 (round to nearest even, 지수 범위 밖은 inf/0)
+uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000;
+    int exponent = (int)((bits >> 23) & 0xff) - 127 + 15;
+    uint32_t mantissa = bits & 0x7fffff;
+
+    if (exponent >= 31) return (uint16_t)(sign | 0x7c00);
+    if (exponent <= 0) {
+        if (exponent < -10) return (uint16_t)sign;
+        mantissa |= 0x800000;
+        int shift = 14 - exponent;
+        uint32_t half = mantissa >> shift;
+        uint32_t rest = mantissa & ((1u << shift) - 1);
+        uint32_t midpoint = 1u << (shift - 1);
+        if (rest > midpoint || (rest == midpoint && (half & 1))) half++;
+        return (uint16_t)(sign | half);
+    }
+    uint32_t half = sign | ((uint32_t)exponent << 10) | (mantissa >> 13);
+    uint32_t rest = mantissa & 0x1fff;
+    if (rest > 0x1000 || (rest == 0x1000 && (half & 1))) half++; // 올림이 지수로 넘어가도 올바른 값
+    return (uint16_t)half;
+}
+
+float halfToFloat(uint16_t half) {
+    uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+    int exponent = (half >> 10) & 0x1f;
+    uint32_t mantissa = half & 0x3ff;
+    uint32_t bits;
+    if (exponent == 0) {
+        float value = (float)mantissa / 1024.0f / 16384.0f; // subnormal: m * 2^-24
+        return sign ? -value : value;
+    }
+    if (exponent == 31) bits = sign | 0x7f800000 | (mantissa << 13);
+    else bits = sign | ((uint32_t)(exponent - 15 + 127) << 23) | (mantissa << 13);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// 양자화 오차: 이론 상한과 실제 최대값 (position은 정점 위치 차이의 길이, uv는 성분별)
+struct QuantizationError {
+    float positionBound;
+    float positionMax;
+    float texcoordBound;
+    float texcoordMax;
+};
+
+static inline int16_t quantizeSnorm16(float value) {
+    value = max(-1.0f, min(1.0f, value));
+    return (int16_t)floor(value * 32767.0f + 0.5f);
+}
+
+static inline uint16_t quantizeUnorm16(float value) {
+    value = max(0.0f, min(1.0f, value));
+    return (uint16_t)floor(value * 65535.0f + 0.5f);
+}
+
+// vertices (pos3 + uv2 float)를 format으로 변환. position은 AABB 중심/반 크기, uv는 UV 범위 기준
+void quantizeVertices(const vector<float>& vertices, const VertexFormat& format, vector<unsigned char>& data, VertexLayout& layout,
+                      QuantizationError* error = nullptr) {
+    size_t vertexCount = vertices.size() / 5;
+    layout = VertexLayout();
+    layout.format = &format;
+    data.assign(vertices.empty() ? 0 : vertexCount * format.stride, 0);
+    if (error) *error = QuantizationError();
+    if (vertexCount == 0) return;
+
+    if (format.position.type == GL_FLOAT) {
+        memcpy(&data[0], &vertices[0], vertices.size() * sizeof(float));
+        return;
+    }
+
+    glm::vec3 minPosition(vertices[0], vertices[1], vertices[2]), maxPosition = minPosition;
+    glm::vec2 minTexcoord(vertices[3], vertices[4]), maxTexcoord = minTexcoord;
+    for (size_t v = 1; v < vertexCount; v++) {
+        const float* vertex = &vertices[v * 5];
+        minPosition = glm::min(minPosition, glm::vec3(vertex[0], vertex[1], vertex[2]));
+        maxPosition = glm::max(maxPosition, glm::vec3(vertex[0], vertex[1], vertex[2]));
+        minTexcoord = glm::vec2(min(minTexcoord.x, vertex[3]), min(minTexcoord.y, vertex[4]));
+        maxTexcoord = glm::vec2(max(maxTexcoord.x, vertex[3]), max(maxTexcoord.y, vertex[4]));
+    }
+
+    // 크기가 0인 축은 scale 1 (나눗셈 방지, 값은 전부 offset)
+    glm::vec3 halfExtent = (maxPosition - minPosition) * 0.5f;
+    for (int a = 0; a < 3; a++) layout.positionScale[a] = halfExtent[a] > 0.0f ? halfExtent[a] : 1.0f;
+    layout.positionOffset = (minPosition + maxPosition) * 0.5f;
+    glm::vec2 texcoordExtent = maxTexcoord - minTexcoord;
+    layout.texcoordScale = glm::vec2(texcoordExtent.x > 0.0f ? texcoordExtent.x : 1.0f, texcoordExtent.y > 0.0f ? texcoordExtent.y : 1.0f);
+    layout.texcoordOffset = minTexcoord;
+
+    bool half = format.position.type == GL_HALF_FLOAT;
+    float positionMax = 0.0f, texcoordMax = 0.0f;
+    for (size_t v = 0; v < vertexCount; v++) {
+        const float* vertex = &vertices[v * 5];
+        unsigned char* out = &data[v * format.stride];
+        int16_t* position = (int16_t*)(out + format.position.offset);
+        uint16_t* texcoord = (uint16_t*)(out + format.texcoord.offset);
+
+        glm::vec3 decoded;
+        for (int a = 0; a < 3; a++) {
+            float normalized = (vertex[a] - layout.positionOffset[a]) / layout.positionScale[a];
+            if (half) {
+                uint16_t h = floatToHalf(normalized);
+                memcpy(&position[a], &h, sizeof(h));
+                decoded[a] = halfToFloat(h);
+            } else {
+                position[a] = quantizeSnorm16(normalized);
+                decoded[a] = max(position[a] / 32767.0f, -1.0f);
+            }
+            decoded[a] = decoded[a] * layout.positionScale[a] + layout.positionOffset[a];
+        }
+        for (int a = 0; a < 2; a++) {
+            texcoord[a] = quantizeUnorm16((vertex[3 + a] - layout.texcoordOffset[a]) / layout.texcoordScale[a]);
+            float decodedTexcoord = texcoord[a] / 65535.0f * layout.texcoordScale[a] + layout.texcoordOffset[a];
+            texcoordMax = max(texcoordMax, fabs(decodedTexcoord - vertex[3 + a]));
+        }
+        positionMax = max(positionMax, glm::length(decoded - glm::vec3(vertex[0], vertex[1], vertex[2])));
+    }
+
+    if (error) {
+        // snorm16: 반 스텝 = scale / 65534, half: [0.5, 1) 구간의 반 ulp = 2^-12 (정규화 범위 [-1, 1])
+        // 복원 계산의 float 반올림 (값 크기 * 2 ulp) 만큼 여유를 더함
+        float positionStep = half ? 1.0f / 4096.0f : 1.0f / 65534.0f;
+        glm::vec3 positionMagnitude = glm::max(glm::abs(minPosition), glm::abs(maxPosition));
+        error->positionBound = glm::length(halfExtent) * positionStep + glm::length(positionMagnitude) * 2.0f * FLT_EPSILON;
+        error->positionMax = positionMax;
+        float texcoordMagnitude = max(max(fabs(minTexcoord.x), fabs(maxTexcoord.x)), max(fabs(minTexcoord.y), fabs(maxTexcoord.y)));
+        error->texcoordBound = max(texcoordExtent.x, texcoordExtent.y) / 131070.0f + texcoordMagnitude * 2.0f * FLT_EPSILON;
+        error->texcoordMax = texcoordMax;
+    }
+}
+
+void printQuantization(const char* name, const vector<float>& vertices, const vector<unsigned char>& data, const VertexLayout& layout,
+                       const QuantizationError& error) {
+    if (layout.format == &FLOAT_VERTEX_FORMAT) return;
+    printf("%s vertex format %s: %zu -> %zu bytes, position error %.3g (bound %.3g), uv error %.3g (bound %.3g)\n",
+           name, layout.format->name, vertices.size() * sizeof(float), data.size(),
+           error.positionMax, error.positionBound, error.texcoordMax, error.texcoordBound);
+}
+
+// main에서 정점 버퍼 업로드 (meshVertexFormat으로 양자화, layout에 복원 값 기록)
+void uploadVertexBuffer(const char* name, const vector<float>& vertices, GLuint& buffer, VertexLayout& layout) {
+    vector<unsigned char> data;
+    QuantizationError error;
+    quantizeVertices(vertices, *meshVertexFormat, data, layout, &error);
+
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    uploadStaticBuffer(GL_ARRAY_BUFFER, data.empty() ? nullptr : &data[0], data.size());
+    printQuantization(name, vertices, data, layout, error);
+}
+
+// ===== 스트리밍 OBJ 로더 (페이지 단위 출력) =====
+// loadOBJ/loadOBJFast는 원본 배열, 최종 배열, 중복 제거 테이블을 모두 들고 있어서 최대 메모리가 메시 크기의 몇 배가 됨
+// 스트리밍 모드는 파일을 고정 크기 블록으로 읽고, 결과를 고정 크기 페이지(정점 + 인덱스) 단위로 내보냄
+// 페이지마다 인덱스는 페이지 안에서만 유효 (정점 중복 제거도 페이지 단위) → 페이지 하나가 draw call 하나
+// 읽기 블록, 페이지, 중복 제거 테이블은 고정 크기지만 position/texcoord 배열은 face가 아무 정점이나 참조할 수 있어서
+// 파일 크기에 비례해 계속 자람 (메모리 사용량이 고정되는 것은 아님). memoryBudget은 이 배열까지 합친 사용량이
+// 넘으면 로딩을 중단하는 상한일 뿐
+// 주의: face는 앞에서 이미 나온 정점만 참조할 수 있음 (뒤쪽 정점을 참조하면 잘못된 인덱스로 처리)
+
+struct MeshPage {
+    const float* vertices;       // 인터리브 pos+uv (5 floats)
+    size_t vertexCount;
+    const unsigned int* indices; // 페이지 안의 정점 번호
+    size_t indexCount;
+    size_t pageIndex;
+};
+
+// 페이지를 받는 콜백 (데이터는 콜백이 끝나면 재사용되므로 필요하면 복사/업로드할 것)
+typedef void (*MeshPageCallback)(const MeshPage& page, void* userData);
+
+struct OBJStreamSettings {
+    size_t memoryBudget;      // 로더 전체가 사용할 수 있는 최대 바이트
+    size_t readBlockBytes;    // 파일 읽기 블록 크기
+    size_t pageVertexCount;   // 페이지당 최대 정점 수
+    size_t pageIndexCount;    // 페이지당 최대 인덱스 수
+
+    OBJStreamSettings() : memoryBudget((size_t)512 << 20), readBlockBytes((size_t)1 << 20),
+                          pageVertexCount(65536), pageIndexCount(65536 * 6) {}
+};
+
+struct OBJStreamStats {
+    size_t pageCount;
+    size_t vertexCount;
+    size_t indexCount;
+    size_t peakBytes;       // 로더가 잡고 있던 최대 메모리 (추적 가능한 버퍼 기준)
+    glm::vec3 minBound;
+    glm::vec3 maxBound;
+};
+
+// 페이지 버퍼 + 페이지 단위 중복 제거 상태
+struct OBJStreamPage {
+    vector<float> vertices;
+    vector<unsigned int> indices;
+    VertexDedupTable dedup;
+    size_t pageIndex;
+
+    explicit OBJStreamPage(const OBJStreamSettings& settings) : dedup(settings.pageVertexCount), pageIndex(0) {
+        vertices.reserve(settings.pageVertexCount * 5);
+        indices.reserve(settings.pageIndexCount);
+    }
+
+    size_t bytes() const {
+        return vertices.capacity() * sizeof(float) + indices.capacity() * sizeof(unsigned int) +
+               dedup.slots.capacity() * sizeof(VertexDedupTable::Slot);
+    }
+};
+
+static void flushStreamPage(OBJStreamPage& page, MeshPageCallback callback, void* userData, OBJStreamStats& stats) {
+    if (page.indices.empty()) return;
+
+    MeshPage out;
+    out.vertices = &page.vertices[0];
+    out.vertexCount = page.vertices.size() / 5;
+    out.indices = &page.indices[0];
+    out.indexCount = page.indices.size();
+    out.pageIndex = page.pageIndex;
+    callback(out, userData);
+
+    stats.pageCount++;
+    stats.vertexCount += out.vertexCount;
+    stats.indexCount += out.indexCount;
+
+    page.vertices.clear();
+    page.indices.clear();
+    page.dedup.clear();
+    page.pageIndex++;
+}
+
+// 블록에서 모인 face들을 현재 페이지에 넣음 (꽉 차면 내보내고 새 페이지)
+static void streamFacesToPages(OBJRawData& raw, OBJStreamPage& page, const OBJStreamSettings& settings,
+                               MeshPageCallback callback, void* userData, OBJStreamStats& stats) {
+    int vertex_count = (int)raw.positions.size();
+    int texcoord_count = (int)raw.texcoords.size();
+
+    size_t cornerOffset = 0;
+    for (size_t f = 0; f < raw.faceSizes.size(); f++) {
+        int faceSize = raw.faceSizes[f];
+        const OBJCorner* corners = &raw.corners[cornerOffset];
+        cornerOffset += faceSize;
+        if (faceSize < 3) continue;
+
+        bool valid = true;
+        for (int c = 0; c < faceSize && valid; c++)
+            valid = corners[c].vertex >= 1 && corners[c].vertex <= vertex_count;
+        if (!valid) {
+            printf("Invalid vertex index in streamed face (max: %d)\n", vertex_count);
+            continue;
+        }
+
+        // face 하나가 페이지에 안 들어가면 먼저 비움 (최악의 경우: 꼭짓점 모두 새 정점)
+        size_t triangleIndices = (size_t)(faceSize - 2) * 3;
+        if (page.vertices.size() / 5 + faceSize > settings.pageVertexCount ||
+            page.indices.size() + triangleIndices > settings.pageIndexCount) {
+            flushStreamPage(page, callback, userData, stats);
+        }
+
+        unsigned int firstCorner = 0, previousCorner = 0;
+        for (int c = 0; c < faceSize; c++) {
+            int texcoord_idx = corners[c].texcoord;
+            if (texcoord_idx != 0 && (texcoord_idx < 1 || texcoord_idx > texcoord_count)) texcoord_idx = 0;
+
+            int newIndex = (int)(page.vertices.size() / 5);
+            int vertex_id = page.dedup.findOrInsert(corners[c].vertex - 1, texcoord_idx - 1, newIndex);
+            if (vertex_id == newIndex) {
+                const glm::vec3& pos = raw.positions[corners[c].vertex - 1];
+                glm::vec2 tex = texcoord_idx != 0 ? raw.texcoords[texcoord_idx - 1] : glm::vec2(0.0f, 0.0f);
+                float vertex[5] = { pos.x, pos.y, pos.z, tex.x, tex.y };
+                page.vertices.insert(page.vertices.end(), vertex, vertex + 5);
+            }
+
+            // fan triangulation (loadOBJ와 같은 순서)
+            if (c == 0) firstCorner = (unsigned int)vertex_id;
+            if (c >= 2) {
+                page.indices.push_back(firstCorner);
+                page.indices.push_back(previousCorner);
+                page.indices.push_back((unsigned int)vertex_id);
+            }
+            previousCorner = (unsigned int)vertex_id;
+        }
+    }
+    raw.corners.clear();
+    raw.faceSizes.clear();
+}
+
+// 메모리 상한 안에서 배열이 자랄 수 있는지 확인하고 용량을 늘림 (2배씩, 상한을 넘으면 false)
+// otherBytes: 이 배열을 제외하고 이미 사용 중인 바이트
+template <typename T>
+static bool reserveWithinBudget(vector<T>& array, size_t otherBytes, size_t budget) {
+    if (array.size() < array.capacity()) return true;
+    size_t used = otherBytes;
+    if (used >= budget) return false;
+    size_t maxCapacity = (budget - used) / sizeof(T);
+    size_t wanted = max<size_t>(1024, array.capacity() * 2);
+    if (array.size() >= maxCapacity) return false;
+    array.reserve(min(wanted, maxCapacity));
+    return true;
+}
+
+bool streamOBJ(const char* path, const OBJStreamSettings& settings, MeshPageCallback callback, void* userData,
+               glm::vec3& actualColor, OBJStreamStats& stats) {
+    stats = OBJStreamStats();
+
+    FILE* fp = fopen(path, "rb");
+    if (!fp) {
+        printf("Failed to open file: %s\n", path);
+        return false;
+    }
+    printf("Streaming OBJ file: %s (budget %.1f MB)\n", path, settings.memoryBudget / (1024.0 * 1024.0));
+
+    vector<char> block(settings.readBlockBytes);
+    OBJStreamPage page(settings);
+    OBJRawData raw;
+    // 한 블록에 들어갈 수 있는 최대 개수로 미리 잡음 ("1 "이 꼭짓점 최소 2바이트, "f 1 2 3\n"이 face 최소 8바이트)
+    raw.corners.reserve(settings.readBlockBytes / 2);
+    raw.faceSizes.reserve(settings.readBlockBytes / 8);
+
+    // position/texcoord 배열을 제외한 고정 사용량
+    size_t fixedBytes = block.capacity() + page.bytes() +
+                        raw.corners.capacity() * sizeof(OBJCorner) + raw.faceSizes.capacity() * sizeof(int);
+    if (fixedBytes > settings.memoryBudget) {
+        printf("Streaming buffers (%zu bytes) exceed memory budget\n", fixedBytes);
+        fclose(fp);
+        return false;
+    }
+
+    bool ok = true;
+    size_t carried = 0; // 이전 블록에서 잘린 줄
+    while (ok) {
+        size_t readBytes = fread(&block[carried], 1, block.size() - carried, fp);
+        size_t filled = carried + readBytes;
+        bool atEnd = readBytes == 0;
+        if (filled == 0) break;
+
+        // 마지막 개행까지만 처리하고 나머지는 다음 블록 앞으로 옮김 (파일 끝이면 전부 처리)
+        size_t usable = filled;
+        if (!atEnd) {
+            while (usable > 0 && block[usable - 1] != '\n') usable--;
+            if (usable == 0) {
+                printf("Line longer than stream block (%zu bytes)\n", block.size());
+                ok = false;
+                break;
+            }
+        }
+
+        const char* p = &block[0];
+        const char* end = p + usable;
+        while (p < end) {
+            const char* lineEnd = (const char*)memchr(p, '\n', (size_t)(end - p));
+            if (lineEnd == nullptr) lineEnd = end;
+
+            // position/texcoord가 늘어날 때만 상한 검사
+            if (lineEnd - p > 2 && p[0] == 'v') {
+                size_t positionBytes = raw.positions.capacity() * sizeof(glm::vec3);
+                size_t texcoordBytes = raw.texcoords.capacity() * sizeof(glm::vec2);
+                bool fits = true;
+                if (p[1] == ' ')
+                    fits = reserveWithinBudget(raw.positions, fixedBytes + texcoordBytes, settings.memoryBudget);
+                else if (p[1] == 't')
+                    fits = reserveWithinBudget(raw.texcoords, fixedBytes + positionBytes, settings.memoryBudget);
+                if (!fits) {
+                    printf("OBJ vertex data exceeds memory budget (%zu positions, %zu texcoords)\n", raw.positions.size(), raw.texcoords.size());
+                    ok = false;
+                    break;
+                }
+            }
+            parseOBJLine(p, lineEnd, raw);
+            p = lineEnd + 1;
+        }
+        if (!ok) break;
+
+        streamFacesToPages(raw, page, settings, callback, userData, stats);
+        stats.peakBytes = max(stats.peakBytes, fixedBytes + raw.positions.capacity() * sizeof(glm::vec3) +
+                                               raw.texcoords.capacity() * sizeof(glm::vec2) + raw.directives.capacity() * sizeof(OBJDirective));
+
+        carried = filled - usable;
+        if (carried > 0) memmove(&block[0], &block[usable], carried);
+        if (atEnd) break;
+    }
+    fclose(fp);
+    if (!ok) return false;
+
+    flushStreamPage(page, callback, userData, stats);
+    applyOBJDirectives(raw, actualColor);
+    if (!computePositionBounds(raw.positions, stats.minBound, stats.maxBound)) {
+        stats.minBound = glm::vec3(0.0f);
+        stats.maxBound = glm::vec3(0.0f);
+    }
+
+    printf("OBJ streamed: %zu pages, %zu vertices (pos+tex), %zu indices, peak %.1f MB\n",
+           stats.pageCount, stats.vertexCount, stats.indexCount, stats.peakBytes / (1024.0 * 1024.0));
+    return true;
+}
+
+// 페이지를 바로 GPU 버퍼로 올리는 콜백 (페이지마다 VBO/IBO 한 쌍)
+struct StreamedMesh {
+    vector<GLuint> vertexBuffers;
+    vector<GLuint> indexBuffers;
+    vector<GLsizei> indexCounts;
+};
+
+// 이 크기보다 큰 OBJ는 main에서 스트리밍으로 로드
+size_t streamingThresholdBytes = (size_t)1 << 30;
+
+// PiggyBank를 스트리밍으로 올렸을 때의 페이지 버퍼들
+StreamedMesh piggyStreamedMesh;
+
+void uploadMeshPage(const MeshPage& page, void* userData) {
+    StreamedMesh* mesh = (StreamedMesh*)userData;
+
+    GLuint buffers[2];
+    glGenBuffers(2, buffers);
+    glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+    uploadStaticBuffer(GL_ARRAY_BUFFER, page.vertices, page.vertexCount * FLOAT_VERTEX_FORMAT.stride);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[1]);
+    uploadStaticBuffer(GL_ELEMENT_ARRAY_BUFFER, page.indices, page.indexCount * sizeof(unsigned int));
+
+    mesh->vertexBuffers.push_back(buffers[0]);
+    mesh->indexBuffers.push_back(buffers[1]);
+    mesh->indexCounts.push_back((GLsizei)page.indexCount);
+}
+
+// 스트리밍으로 올린 메시 그리기 (MVP, 재질 uniform은 호출 전에 설정). 페이지는 float 포맷 그대로
+void drawStreamedMesh(const StreamedMesh& mesh, const VertexFormatUniforms& formatUniforms) {
+    for (size_t i = 0; i < mesh.indexCounts.size(); i++) {
+        glBindBuffer(GL_ARRAY_BUFFER, mesh.vertexBuffers[i]);
+        bindVertexLayout(FLOAT_VERTEX_LAYOUT, formatUniforms);
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.indexBuffers[i]);
+        glDrawElements(GL_TRIANGLES, mesh.indexCounts[i], GL_UNSIGNED_INT, 0);
+    }
+}
+
+void deleteStreamedMesh(StreamedMesh& mesh) {
+    if (!mesh.vertexBuffers.empty()) glDeleteBuffers((GLsizei)mesh.vertexBuffers.size(), &mesh.vertexBuffers[0]);
+    if (!mesh.indexBuffers.empty()) glDeleteBuffers((GLsizei)mesh.indexBuffers.size(), &mesh.indexBuffers[0]);
+    mesh = StreamedMesh();
+}
+
+// ===== 메시 최적화: 정점 캐시 순서 (Tipsify) =====
+// loadOBJ의 인덱스는 파일 순서 + fan 분할 그대로라 GPU의 post-transform 정점 캐시를 잘 못 씀
+// Tipsify (Sander et al. 2007): 캐시에 남아있을 정점 주위로 삼각형을 부채꼴로 내보내는 선형 시간 알고리즘
+// 재질 구간(SubMesh) 안에서만 순서를 바꾸므로 구간 표는 그대로 유효함
+
+bool optimizeMeshes = true;              // main에서 업로드 전에 최적화 단계 실행
+const int VERTEX_CACHE_SIZE = 16;        // 최적화/측정에 쓰는 FIFO 캐시 크기
+
+struct VertexCacheStats {
+    float acmr; // average cache miss ratio: 삼각형당 캐시 미스 (최소 0.5, 최악 3)
+    float atvr; // average transform to vertex ratio: 사용된 정점당 변환 횟수 (최소 1)
+};
+
+// FIFO 캐시 시뮬레이션 (미스 카운터를 타임스탬프로 써서 정점마다 O(1))
+VertexCacheStats measureVertexCache(const vector<unsigned int>& indices, size_t vertexCount, int cacheSize = VERTEX_CACHE_SIZE) {
+    VertexCacheStats stats = { 0.0f, 0.0f };
+    if (indices.empty()) return stats;
+
+    vector<long long> insertedAt(vertexCount, LLONG_MIN / 2);
+    vector<char> used(vertexCount, 0);
+    long long misses = 0;
+    size_t usedCount = 0;
+    for (size_t i = 0; i < indices.size(); i++) {
+        unsigned int v = indices[i];
+        if (misses - insertedAt[v] >= cacheSize) {
+            insertedAt[v] = misses;
+            misses++;
+        }
+        if (!used[v]) {
+            used[v] = 1;
+            usedCount++;
+        }
+    }
+    stats.acmr = (float)misses / (float)(indices.size() / 3);
+    stats.atvr = usedCount > 0 ? (float)misses / (float)usedCount : 0.0f;
+    return stats;
+}
+
+// 삼각형 범위 [firstIndex, firstIndex + indexCount) 를 Tipsify 순서로 다시 씀
+static void tipsifyRange(vector<unsigned int>& indices, size_t firstIndex, size_t indexCount, size_t vertexCount, int cacheSize,
+                         vector<int>& liveTriangles, vector<int>& cacheTime, vector<unsigned int>& adjacencyOffsets) {
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0) return;
+    const unsigned int* input = &indices[firstIndex];
+
+    // 정점 → 삼각형 인접 리스트 (CSR)
+    fill(liveTriangles.begin(), liveTriangles.end(), 0);
+    for (size_t i = 0; i < triangleCount * 3; i++) liveTriangles[input[i]]++;
+    adjacencyOffsets[0] = 0;
+    for (size_t v = 0; v < vertexCount; v++) adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangles[v];
+    vector<unsigned int> adjacency(triangleCount * 3);
+    vector<unsigned int> fillPos(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for (size_t t = 0; t < triangleCount; t++)
+        for (int c = 0; c < 3; c++) adjacency[fillPos[input[t * 3 + c]]++] = (unsigned int)t;
+
+    fill(cacheTime.begin(), cacheTime.end(), 0);
+    vector<char> emitted(triangleCount, 0);
+    vector<unsigned int> deadEnd;
+    vector<unsigned int> candidates;
+    vector<unsigned int> output;
+    output.reserve(triangleCount * 3);
+
+    int timeStamp = cacheSize + 1;
+    size_t cursor = 0;
+    long long fanning = input[0];
+
+    while (fanning >= 0) {
+        candidates.clear();
+        // fanning 정점에 붙은 삼각형을 모두 내보냄
+        for (unsigned int a = adjacencyOffsets[fanning]; a < adjacencyOffsets[fanning + 1]; a++) {
+            unsigned int t = adjacency[a];
+            if (emitted[t]) continue;
+            emitted[t] = 1;
+            for (int c = 0; c < 3; c++) {
+                unsigned int v = input[t * 3 + c];
+                output.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                liveTriangles[v]--;
+                if (timeStamp - cacheTime[v] > cacheSize) cacheTime[v] = timeStamp++;
+            }
+        }
+
+        // 다음 fanning 정점: 아직 캐시에 있고 남은 삼각형을 다 내보내도 밀려나지 않을 정점 중 가장 오래된 것
+        long long next = -1;
+        int bestPriority = -1;
+        for (size_t i = 0; i < candidates.size(); i++) {
+            unsigned int v = candidates[i];
+            if (liveTriangles[v] <= 0) continue;
+            int priority = 0;
+            if (timeStamp - cacheTime[v] + 2 * liveTriangles[v] <= cacheSize) priority = timeStamp - cacheTime[v];
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                next = v;
+            }
+        }
+
+        // 막다른 곳: 최근 정점 스택 → 그래도 없으면 입력 순서대로 다음 삼각형
+        if (next < 0) {
+            while (!deadEnd.empty() && next < 0) {
+                unsigned int v = deadEnd.back();
+                deadEnd.pop_back();
+                if (liveTriangles[v] > 0) next = v;
+            }
+            while (next < 0 && cursor < triangleCount) {
+                if (!emitted[cursor]) next = input[cursor * 3];
+                cursor++;
+            }
+        }
+        fanning = next;
+    }
+
+    memcpy(&indices[firstIndex], &output[0], output.size() * sizeof(unsigned int));
+}
+
+// 인덱스 버퍼 전체를 재질 구간별로 최적화 (submeshes가 비어 있으면 전체를 한 구간으로)
+void optimizeVertexCache(vector<unsigned int>& indices, size_t vertexCount, const vector<SubMesh>& submeshes, int cacheSize = VERTEX_CACHE_SIZE) {
+    if (indices.empty() || vertexCount == 0) return;
+
+    vector<int> liveTriangles(vertexCount);
+    vector<int> cacheTime(vertexCount);
+    vector<unsigned int> adjacencyOffsets(vertexCount + 1);
+
+    if (submeshes.empty()) {
+        tipsifyRange(indices, 0, indices.size(), vertexCount, cacheSize, liveTriangles, cacheTime, adjacencyOffsets);
+        return;
+    }
+    for (size_t i = 0; i < submeshes.size(); i++)
+        tipsifyRange(indices, submeshes[i].firstIndex, submeshes[i].indexCount, vertexCount, cacheSize, liveTriangles, cacheTime, adjacencyOffsets);
+}
+
+// ===== 메시 최적화: 오버드로 순서 =====
+// Tipsify 순서를 캐시 효율이 유지되는 지점에서 클러스터로 자르고, 바깥을 향한 클러스터를 먼저 그림
+// (Sander et al. 2007의 2단계) → 닫힌 메시는 어느 방향에서 봐도 앞면이 먼저 깊이 버퍼를 채움
+// 지금 렌더러는 GL_CULL_FACE를 안 켜서 이득이 거의 없고 ACMR은 나빠지므로 (--bench-overdraw) 기본은 꺼 둠
+
+bool optimizeOverdrawEnabled = false;         // --optimize-overdraw 로 켬
+const float OVERDRAW_CACHE_THRESHOLD = 1.05f; // 클러스터 ACMR이 구간 ACMR의 이 배수 이하일 때만 자름
+const size_t OVERDRAW_MIN_CLUSTER = 32;       // 클러스터 최소 삼각형 수
+
+struct OverdrawStats {
+    float overdraw;     // 덮인 픽셀당 셰이딩된 fragment 수 (최소 1)
+    size_t covered;     // 모든 방향의 덮인 픽셀 합
+    size_t shaded;      // 모든 방향의 셰이딩된 fragment 합 (깊이 테스트 통과)
+};
+
+static inline glm::vec3 vertexPosition(const vector<float>& vertices, unsigned int v) {
+    return glm::vec3(vertices[v * 5], vertices[v * 5 + 1], vertices[v * 5 + 2]);
+}
+
+// 삼각형 범위 [firstIndex, firstIndex + indexCount) 를 클러스터 단위로 다시 정렬
+static void orderClustersRange(const vector<float>& vertices, vector<unsigned int>& indices, size_t firstIndex, size_t indexCount,
+                               const glm::vec3& meshCenter, int cacheSize, vector<long long>& insertedAt) {
+    size_t triangleCount = indexCount / 3;
+    if (triangleCount < OVERDRAW_MIN_CLUSTER * 2) return;
+    const unsigned int* input = &indices[firstIndex];
+
+    // 구간 정점의 기록을 비움 (앞 구간이 남긴 캐시 상태에서 시작하지 않도록)
+    for (size_t i = 0; i < triangleCount * 3; i++) insertedAt[input[i]] = LLONG_MIN / 2;
+
+    // 구간 전체의 ACMR (기준값)
+    long long misses = 0;
+    for (size_t i = 0; i < triangleCount * 3; i++) {
+        unsigned int v = input[i];
+        if (misses - insertedAt[v] >= cacheSize) insertedAt[v] = misses++;
+    }
+    float rangeAcmr = (float)misses / (float)triangleCount;
+
+    // 클러스터 경계: 새 클러스터에서 캐시를 비운 상태로 시뮬레이션해서 ACMR이 기준 근처로 내려오면 자름
+    vector<size_t> clusterStart(1, 0);
+    long long clusterMisses = 0;
+    long long clock = misses + cacheSize + 1; // 이전 시뮬레이션 기록을 모두 만료시킴
+    for (size_t t = 0; t < triangleCount; t++) {
+        size_t clusterSize = t - clusterStart.back();
+        if (clusterSize >= OVERDRAW_MIN_CLUSTER && (float)clusterMisses / (float)clusterSize <= rangeAcmr * OVERDRAW_CACHE_THRESHOLD) {
+            clusterStart.push_back(t);
+            clusterMisses = 0;
+            clock += cacheSize + 1; // 캐시 비우기
+        }
+        for (int c = 0; c < 3; c++) {
+            unsigned int v = input[t * 3 + c];
+            if (clock - insertedAt[v] >= cacheSize) {
+                insertedAt[v] = clock++;
+                clusterMisses++;
+            }
+        }
+    }
+    // 마지막 클러스터가 너무 작으면 앞 클러스터에 붙임
+    if (clusterStart.size() > 1 && triangleCount - clusterStart.back() < OVERDRAW_MIN_CLUSTER) clusterStart.pop_back();
+    clusterStart.push_back(triangleCount);
+    size_t clusterCount = clusterStart.size() - 1;
+    if (clusterCount < 2) return;
+
+    // 정렬 키: (클러스터 중심 - 메시 중심) · 클러스터 면적 가중 법선. 클수록 바깥을 향함 → 먼저 그림
+    vector<float> sortKey(clusterCount);
+    for (size_t k = 0; k < clusterCount; k++) {
+        glm::vec3 centroid(0.0f), normal(0.0f);
+        float area = 0.0f;
+        for (size_t t = clusterStart[k]; t < clusterStart[k + 1]; t++) {
+            glm::vec3 a = vertexPosition(vertices, input[t * 3]);
+            glm::vec3 b = vertexPosition(vertices, input[t * 3 + 1]);
+            glm::vec3 c = vertexPosition(vertices, input[t * 3 + 2]);
+            glm::vec3 n = glm::cross(b - a, c - a); // 길이 = 면적 * 2
+            float triangleArea = glm::length(n);
+            centroid += (a + b + c) * (triangleArea / 3.0f);
+            normal += n;
+            area += triangleArea;
+        }
+        if (area > 0.0f) centroid /= area;
+        float normalLength = glm::length(normal);
+        sortKey[k] = normalLength > 0.0f ? glm::dot(centroid - meshCenter, normal / normalLength) : 0.0f;
+    }
+
+    vector<size_t> order(clusterCount);
+    for (size_t k = 0; k < clusterCount; k++) order[k] = k;
+    stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sortKey[a] > sortKey[b]; });
+
+    vector<unsigned int> output;
+    output.reserve(triangleCount * 3);
+    for (size_t i = 0; i < clusterCount; i++) {
+        size_t k = order[i];
+        output.insert(output.end(), input + clusterStart[k] * 3, input + clusterStart[k + 1] * 3);
+    }
+    memcpy(&indices[firstIndex], &output[0], output.size() * sizeof(unsigned int));
+}
+
+// optimizeVertexCache 다음에 호출 (Tipsify 순서를 클러스터 경계로 사용)
+void optimizeOverdraw(const vector<float>& vertices, vector<unsigned int>& indices, const vector<SubMesh>& submeshes, int cacheSize = VERTEX_CACHE_SIZE) {
+    size_t vertexCount = vertices.size() / 5;
+    if (indices.empty() || vertexCount == 0) return;
+
+    // 메시 중심 = 사용된 정점의 평균
+    glm::vec3 meshCenter(0.0f);
+    for (size_t v = 0; v < vertexCount; v++) meshCenter += vertexPosition(vertices, (unsigned int)v);
+    meshCenter /= (float)vertexCount;
+
+    vector<long long> insertedAt(vertexCount, LLONG_MIN / 2);
+    if (submeshes.empty()) {
+        orderClustersRange(vertices, indices, 0, indices.size(), meshCenter, cacheSize, insertedAt);
+        return;
+    }
+    for (size_t i = 0; i < submeshes.size(); i++)
+        orderClustersRange(vertices, indices, submeshes[i].firstIndex, submeshes[i].indexCount, meshCenter, cacheSize, insertedAt);
+}
+
+// CPU 래스터라이저로 오버드로 측정: 구 위에 고르게 퍼진 viewCount개 방향에서 직교 투영으로 그림
+// 깊이 테스트(GL_LESS)를 통과한 fragment를 셰이딩된 것으로 셈
+// cullBackFaces: 닫힌 메시를 GL_CULL_FACE(CCW 앞면)로 그리는 경우. false면 현재 렌더러처럼 양면 모두 그림
+OverdrawStats measureOverdraw(const vector<float>& vertices, const vector<unsigned int>& indices, bool cullBackFaces = true,
+                              int viewCount = 16, int resolution = 256) {
+    OverdrawStats stats = { 0.0f, 0, 0 };
+    size_t vertexCount = vertices.size() / 5;
+    if (indices.empty() || vertexCount == 0) return stats;
+
+    glm::vec3 minBound = vertexPosition(vertices, 0), maxBound = minBound;
+    for (size_t v = 1; v < vertexCount; v++) {
+        glm::vec3 p = vertexPosition(vertices, (unsigned int)v);
+        minBound = glm::min(minBound, p);
+        maxBound = glm::max(maxBound, p);
+    }
+    glm::vec3 center = (minBound + maxBound) * 0.5f;
+    float radius = glm::length(maxBound - minBound) * 0.5f;
+    if (radius <= 0.0f) return stats;
+    float scale = (resolution - 1) / (2.0f * radius);
+
+    vector<float> depth(resolution * resolution);
+    vector<glm::vec3> projected(vertexCount);
+
+    for (int view = 0; view < viewCount; view++) {
+        // 피보나치 구 방향 + 직교 기저
+        float z = 1.0f - 2.0f * (view + 0.5f) / viewCount;
+        float ring = sqrt(max(0.0f, 1.0f - z * z));
+        float phi = view * 2.39996323f;
+        glm::vec3 forward(ring * cos(phi), ring * sin(phi), z);
+        glm::vec3 up = fabs(forward.y) < 0.99f ? glm::vec3(0, 1, 0) : glm::vec3(1, 0, 0);
+        glm::vec3 right = glm::normalize(glm::cross(up, forward));
+        up = glm::cross(forward, right);
+
+        for (size_t v = 0; v < vertexCount; v++) {
+            glm::vec3 p = vertexPosition(vertices, (unsigned int)v) - center;
+            projected[v] = glm::vec3((glm::dot(p, right) + radius) * scale, (glm::dot(p, up) + radius) * scale, -glm::dot(p, forward)); // 카메라는 -forward 방향을 봄 (CCW 앞면)
+        }
+        fill(depth.begin(), depth.end(), FLT_MAX);
+
+        for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+            glm::vec3 a = projected[indices[t]], b = projected[indices[t + 1]], c = projected[indices[t + 2]];
+            float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+            if (area == 0.0f) continue;
+            if (area < 0.0f) {
+                if (cullBackFaces) continue;
+                swap(b, c);
+                area = -area;
+            }
+
+            int x0 = max(0, (int)ceil(min(a.x, min(b.x, c.x)) - 0.5f)), x1 = min(resolution - 1, (int)floor(max(a.x, max(b.x, c.x)) - 0.5f));
+            int y0 = max(0, (int)ceil(min(a.y, min(b.y, c.y)) - 0.5f)), y1 = min(resolution - 1, (int)floor(max(a.y, max(b.y, c.y)) - 0.5f));
+            for (int y = y0; y <= y1; y++) {
+                float py = y + 0.5f;
+                for (int x = x0; x <= x1; x++) {
+                    float px = x + 0.5f;
+                    float w0 = (c.x - b.x) * (py - b.y) - (c.y - b.y) * (px - b.x);
+                    float w1 = (a.x - c.x) * (py - c.y) - (a.y - c.y) * (px - c.x);
+                    float w2 = (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x);
+                    if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) continue;
+                    float fragmentDepth = (w0 * a.z + w1 * b.z + w2 * c.z) / area;
+                    float& stored = depth[y * resolution + x];
+                    if (fragmentDepth < stored) {
+                        if (stored == FLT_MAX) stats.covered++;
+                        stored = fragmentDepth;
+                        stats.shaded++;
+                    }
+                }
+            }
+        }
+    }
+    stats.overdraw = stats.covered > 0 ? (float)stats.shaded / (float)stats.covered : 0.0f;
+    return stats;
+}
+
+// ===== 메시 최적화: 정점 fetch 순서 =====
+// 중복 제거는 정점 ID를 파일에서 처음 나온 순서로 매기므로, 삼각형 순서를 바꾸면 정점 읽기가 버퍼 전체로 흩어짐
+// 최종 인덱스 버퍼에서 처음 쓰이는 순서대로 인터리브 정점 배열을 다시 배치하고 인덱스를 고쳐 씀
+// 원래 번호가 이미 더 가지런한 메시(행 순서 격자 등)에서는 오히려 나빠지므로, 시뮬레이션한 fetch 바이트가 줄 때만 적용
+
+const int FETCH_CACHE_LINE = 64;   // 시뮬레이션용 캐시 라인 크기 (bytes)
+const int FETCH_CACHE_SETS = 64;   // 64 sets * 4 ways * 64B = 16KB (GPU 정점 fetch 캐시 정도)
+const int FETCH_CACHE_WAYS = 4;
+
+struct VertexFetchStats {
+    size_t bytesFetched; // 캐시 미스로 메모리에서 읽은 바이트
+    float overfetch;     // bytesFetched / (사용된 정점 수 * stride), 최소 1 근처
+};
+
+// set-associative LRU 캐시로 정점 읽기를 시뮬레이션 (정점 하나가 라인 두 개에 걸치면 둘 다 읽음)
+VertexFetchStats measureVertexFetch(const vector<unsigned int>& indices, size_t vertexCount, size_t vertexStride = 5 * sizeof(float)) {
+    VertexFetchStats stats = { 0, 0.0f };
+    if (indices.empty()) return stats;
+
+    vector<size_t> lineTag(FETCH_CACHE_SETS * FETCH_CACHE_WAYS, ~(size_t)0);
+    vector<unsigned int> lastUse(FETCH_CACHE_SETS * FETCH_CACHE_WAYS, 0);
+    vector<char> used(vertexCount, 0);
+    size_t usedCount = 0;
+    unsigned int clock = 0;
+
+    for (size_t i = 0; i < indices.size(); i++) {
+        unsigned int v = indices[i];
+        if (!used[v]) {
+            used[v] = 1;
+            usedCount++;
+        }
+        size_t firstLine = v * vertexStride / FETCH_CACHE_LINE;
+        size_t lastLine = ((size_t)v * vertexStride + vertexStride - 1) / FETCH_CACHE_LINE;
+        for (size_t line = firstLine; line <= lastLine; line++) {
+            size_t set = (line % FETCH_CACHE_SETS) * FETCH_CACHE_WAYS;
+            size_t victim = set;
+            bool hit = false;
+            for (size_t way = set; way < set + FETCH_CACHE_WAYS; way++) {
+                if (lineTag[way] == line) {
+                    lastUse[way] = ++clock;
+                    hit = true;
+                    break;
+                }
+                if (lastUse[way] < lastUse[victim]) victim = way;
+            }
+            if (!hit) {
+                lineTag[victim] = line;
+                lastUse[victim] = ++clock;
+                stats.bytesFetched += FETCH_CACHE_LINE;
+            }
+        }
+    }
+    stats.overfetch = usedCount > 0 ? (float)stats.bytesFetched / (float)(usedCount * vertexStride) : 0.0f;
+    return stats;
+}
+
+// 인덱스 버퍼에서 처음 쓰인 순서대로 정점 번호를 새로 매김 (remap: 원래 번호 -> 새 번호, remappedIndices: 고친 인덱스)
+// 한 번도 안 쓰인 정점은 뒤에 원래 순서로 남김
+static void buildFetchRemap(const vector<unsigned int>& indices, size_t vertexCount, vector<unsigned int>& remap, vector<unsigned int>& remappedIndices) {
+    remap.assign(vertexCount, ~0u);
+    remappedIndices.resize(indices.size());
+    unsigned int nextVertex = 0;
+    for (size_t i = 0; i < indices.size(); i++) {
+        unsigned int& target = remap[indices[i]];
+        if (target == ~0u) target = nextVertex++;
+        remappedIndices[i] = target;
+    }
+    for (size_t v = 0; v < vertexCount; v++)
+        if (remap[v] == ~0u) remap[v] = nextVertex++;
+}
+
+static void applyFetchRemap(vector<float>& vertices, const vector<unsigned int>& remap) {
+    vector<float> reordered(vertices.size());
+    for (size_t v = 0; v < remap.size(); v++)
+        memcpy(&reordered[remap[v] * 5], &vertices[v * 5], 5 * sizeof(float));
+    vertices.swap(reordered);
+}
+
+// 처음 쓰인 순서로 무조건 다시 배치 (벤치마크에서 재배치 자체의 효과를 볼 때)
+void remapVertexFetch(vector<float>& vertices, vector<unsigned int>& indices) {
+    size_t vertexCount = vertices.size() / 5;
+    if (indices.empty() || vertexCount == 0) return;
+    vector<unsigned int> remap, remappedIndices;
+    buildFetchRemap(indices, vertexCount, remap, remappedIndices);
+    indices.swap(remappedIndices);
+    applyFetchRemap(vertices, remap);
+}
+
+// 재배치한 인덱스의 fetch 바이트가 지금보다 적을 때만 정점 / 인덱스를 바꿈. 바꿨으면 true
+bool optimizeVertexFetch(vector<float>& vertices, vector<unsigned int>& indices) {
+    size_t vertexCount = vertices.size() / 5;
+    if (indices.empty() || vertexCount == 0) return false;
+    vector<unsigned int> remap, remappedIndices;
+    buildFetchRemap(indices, vertexCount, remap, remappedIndices);
+    if (measureVertexFetch(remappedIndices, vertexCount).bytesFetched >= measureVertexFetch(indices, vertexCount).bytesFetched) return false;
+    indices.swap(remappedIndices);
+    applyFetchRemap(vertices, remap);
+    return true;
+}
+
+// ===== LOD 체인 (QEM 단순화) =====
+// Garland-Heckbert quadric 오차로 edge collapse (한쪽 정점으로 합치는 half-edge collapse)
+// 정점은 새로 만들지 않으므로 모든 LOD가 같은 정점 버퍼를 쓰고, LOD 인덱스는 인덱스 버퍼 뒤에 이어 붙임
+// UV seam (같은 위치에 UV만 다른 정점)과 열린 경계, 재질 구간 경계의 정점은 움직이지 않음
+
+bool generateLODs = true;        // main에서 업로드 전에 LOD 생성
+const int MAX_LOD_LEVELS = 5;    // level 0 (원본) 포함
+const float LOD_PIXEL_ERROR = 1.0f; // 화면에서 이 픽셀 수 이하의 오차면 더 거친 LOD 사용
+const size_t LOD_MAX_VALENCE = 24;  // collapse 후 한 정점에 붙는 삼각형 수 상한
+
+// LOD 하나 = 재질 구간 표 하나 (구간은 원본과 같은 순서, 인덱스 버퍼 안의 다른 위치)
+struct MeshLOD {
+    vector<SubMesh> submeshes;
+    size_t triangleCount;
+    float error; // 메시 대각선 길이 대비 상대 오차 (level 0은 0)
+};
+
+vector<MeshLOD> cubeLODs;
+vector<MeshLOD> piggyLODs;
+
+// 평면 quadric (대칭 4x4의 위쪽 삼각형 10개)
+struct Quadric {
+    double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2;
+
+    Quadric() : a2(0), ab(0), ac(0), ad(0), b2(0), bc(0), bd(0), c2(0), cd(0), d2(0) {}
+    Quadric(double a, double b, double c, double d)
+        : a2(a * a), ab(a * b), ac(a * c), ad(a * d), b2(b * b), bc(b * c), bd(b * d), c2(c * c), cd(c * d), d2(d * d) {}
+
+    void add(const Quadric& q) {
+        a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad; b2 += q.b2;
+        bc += q.bc; bd += q.bd; c2 += q.c2; cd += q.cd; d2 += q.d2;
+    }
+
+    // 점 p에서의 평면 거리 제곱 합
+    double evaluate(const glm::vec3& p) const {
+        double x = p.x, y = p.y, z = p.z;
+        return a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+             + b2 * y * y + 2 * bc * y * z + 2 * bd * y
+             + c2 * z * z + 2 * cd * z + d2;
+    }
+};
+
+struct CollapseCandidate {
+    double cost;
+    unsigned int from, to;
+    unsigned int fromVersion, toVersion;
+
+    bool operator<(const CollapseCandidate& other) const { return cost > other.cost; } // priority_queue에서 최소 비용 먼저
+};
+
+// 삼각형 (a, b, c)에서 from을 to로 옮겼을 때 뒤집히거나 퇴화하는지
+static bool collapseFlipsTriangle(const vector<float>& vertices, const unsigned int* triangle, unsigned int from, unsigned int to) {
+    glm::vec3 p[3], q[3];
+    for (int c = 0; c < 3; c++) {
+        p[c] = vertexPosition(vertices, triangle[c]);
+        q[c] = vertexPosition(vertices, triangle[c] == from ? to : triangle[c]);
+    }
+    glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+    glm::vec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+    return glm::dot(before, after) <= 0.0f || glm::length(after) < glm::length(before) * 1e-3f;
+}
+
+// 삼각형 범위 하나를 단계별 목표 삼각형 수까지 차례로 단순화 (한 번의 greedy 과정, 목표마다 그 시점의 삼각형을 복사)
+// targets는 내림차순. outs[i] 뒤에 결과를 붙이고, costs[i]에는 그때까지 가장 큰 collapse 비용 (거리 제곱)
+// locked: seam/경계 정점 (구간 밖과 공유하는 정점도 포함)
+static void simplifyRange(const vector<float>& vertices, const unsigned int* input, size_t triangleCount, const vector<size_t>& targets,
+                          const vector<char>& locked, vector<vector<unsigned int> >& outs, vector<double>& costs) {
+    size_t vertexCount = vertices.size() / 5;
+    vector<unsigned int> triangles(input, input + triangleCount * 3);
+    vector<char> removed(triangleCount, 0);
+    vector<Quadric> quadrics(vertexCount);
+    vector<vector<unsigned int> > vertexTriangles(vertexCount);
+    vector<unsigned int> version(vertexCount, 0);
+    vector<unsigned int> collapsedInto(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++) collapsedInto[v] = (unsigned int)v;
+
+    for (size_t t = 0; t < triangleCount; t++) {
+        const unsigned int* tri = &triangles[t * 3];
+        glm::vec3 a = vertexPosition(vertices, tri[0]), b = vertexPosition(vertices, tri[1]), c = vertexPosition(vertices, tri[2]);
+        glm::vec3 n = glm::cross(b - a, c - a);
+        float length = glm::length(n);
+        if (length > 0.0f) {
+            n /= length;
+            Quadric plane(n.x, n.y, n.z, -glm::dot(n, a));
+            for (int k = 0; k < 3; k++) quadrics[tri[k]].add(plane);
+        }
+        for (int k = 0; k < 3; k++) vertexTriangles[tri[k]].push_back((unsigned int)t);
+    }
+
+    // v에 붙은 edge를 양방향 후보로 넣음 (잠긴 정점으로는 옮길 수 있고, 잠긴 정점을 옮기지는 않음)
+    // 사라진 삼각형은 이때 v의 목록에서 정리
+    priority_queue<CollapseCandidate> queue;
+    auto pushCandidate = [&](unsigned int from, unsigned int to) {
+        if (locked[from]) return;
+        Quadric q = quadrics[from];
+        q.add(quadrics[to]);
+        CollapseCandidate candidate = { max(0.0, q.evaluate(vertexPosition(vertices, to))), from, to, version[from], version[to] };
+        queue.push(candidate);
+    };
+    vector<unsigned int> neighbors;
+    auto pushEdges = [&](unsigned int v) {
+        vector<unsigned int>& list = vertexTriangles[v];
+        size_t live = 0;
+        neighbors.clear();
+        for (size_t i = 0; i < list.size(); i++) {
+            unsigned int t = list[i];
+            if (removed[t]) continue;
+            list[live++] = t;
+            for (int k = 0; k < 3; k++)
+                if (triangles[t * 3 + k] != v) neighbors.push_back(triangles[t * 3 + k]);
+        }
+        list.resize(live);
+        sort(neighbors.begin(), neighbors.end()); // edge 하나가 삼각형 두 개에 나오므로 중복 제거
+        neighbors.erase(unique(neighbors.begin(), neighbors.end()), neighbors.end());
+        for (size_t i = 0; i < neighbors.size(); i++) {
+            pushCandidate(v, neighbors[i]);
+            pushCandidate(neighbors[i], v);
+        }
+    };
+    for (size_t v = 0; v < vertexCount; v++)
+        if (!vertexTriangles[v].empty() && !locked[v]) pushEdges((unsigned int)v);
+
+    size_t liveTriangles = triangleCount;
+    double maxCost = 0.0;
+    for (size_t level = 0; level < targets.size(); level++) {
+        while (liveTriangles > targets[level] && !queue.empty()) {
+            CollapseCandidate candidate = queue.top();
+            queue.pop();
+            unsigned int from = candidate.from, to = candidate.to;
+            if (candidate.fromVersion != version[from] || candidate.toVersion != version[to]) continue; // 오래된 후보
+            if (collapsedInto[from] != from || collapsedInto[to] != to) continue;
+
+            // 평평한 곳에서 한 정점으로 계속 모이면 부채꼴이 커져 품질과 속도가 나빠지므로 valence 제한
+            if (vertexTriangles[from].size() + vertexTriangles[to].size() > LOD_MAX_VALENCE) continue;
+
+            // 뒤집힘 검사: from을 쓰는 삼각형 중 to를 포함하지 않는 것
+            bool valid = true;
+            for (size_t i = 0; i < vertexTriangles[from].size() && valid; i++) {
+                unsigned int t = vertexTriangles[from][i];
+                const unsigned int* tri = &triangles[t * 3];
+                if (removed[t] || tri[0] == to || tri[1] == to || tri[2] == to) continue;
+                valid = !collapseFlipsTriangle(vertices, tri, from, to);
+            }
+            if (!valid) continue;
+
+            maxCost = max(maxCost, candidate.cost);
+            for (size_t i = 0; i < vertexTriangles[from].size(); i++) {
+                unsigned int t = vertexTriangles[from][i];
+                if (removed[t]) continue;
+                unsigned int* tri = &triangles[t * 3];
+                if (tri[0] == to || tri[1] == to || tri[2] == to) {
+                    removed[t] = 1; // 합쳐지는 edge의 삼각형은 사라짐
+                    liveTriangles--;
+                    continue;
+                }
+                for (int k = 0; k < 3; k++)
+                    if (tri[k] == from) tri[k] = to;
+                vertexTriangles[to].push_back(t);
+            }
+            vertexTriangles[from].clear();
+            collapsedInto[from] = to;
+            quadrics[to].add(quadrics[from]);
+            version[to]++;
+            pushEdges(to);
+        }
+
+        for (size_t t = 0; t < triangleCount; t++)
+            if (!removed[t]) outs[level].insert(outs[level].end(), &triangles[t * 3], &triangles[t * 3 + 3]);
+        costs[level] = max(costs[level], maxCost);
+    }
+}
+
+// UV seam, 열린 경계, 여러 재질 구간이 공유하는 정점을 찾음
+static void findLockedVertices(const vector<float>& vertices, const vector<unsigned int>& indices, const vector<SubMesh>& ranges, vector<char>& locked) {
+    size_t vertexCount = vertices.size() / 5;
+    locked.assign(vertexCount, 0);
+
+    // 같은 위치를 공유하는 정점 = seam (위치 순으로 정렬해서 인접 비교)
+    vector<unsigned int> byPosition(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++) byPosition[v] = (unsigned int)v;
+    sort(byPosition.begin(), byPosition.end(), [&](unsigned int a, unsigned int b) {
+        return lexicographical_compare(&vertices[a * 5], &vertices[a * 5 + 3], &vertices[b * 5], &vertices[b * 5 + 3]);
+    });
+    for (size_t i = 1; i < vertexCount; i++) {
+        unsigned int a = byPosition[i - 1], b = byPosition[i];
+        if (memcmp(&vertices[a * 5], &vertices[b * 5], 3 * sizeof(float)) == 0) locked[a] = locked[b] = 1;
+    }
+
+    // 구간마다 한 번만 나오는 edge = 경계. 다른 구간과 공유하는 정점도 잠금
+    vector<int> owner(vertexCount, -1);
+    for (size_t r = 0; r < ranges.size(); r++) {
+        vector<pair<unsigned int, unsigned int> > edges;
+        edges.reserve(ranges[r].indexCount);
+        const unsigned int* tri = &indices[ranges[r].firstIndex];
+        for (size_t i = 0; i < ranges[r].indexCount; i++) {
+            unsigned int a = tri[i], b = tri[i % 3 == 2 ? i - 2 : i + 1];
+            edges.push_back(make_pair(min(a, b), max(a, b)));
+            if (owner[a] == -1) owner[a] = (int)r;
+            else if (owner[a] != (int)r) locked[a] = 1;
+        }
+        sort(edges.begin(), edges.end());
+        for (size_t i = 0; i < edges.size(); ) {
+            size_t j = i;
+            while (j < edges.size() && edges[j] == edges[i]) j++;
+            if (j - i == 1) locked[edges[i].first] = locked[edges[i].second] = 1;
+            i = j;
+        }
+    }
+}
+
+// level 0 (원본 구간)과 단순화한 LOD들을 만들고, LOD 인덱스를 indices 뒤에 붙임
+// submeshes가 비어 있으면 전체를 actualColor 색의 구간 하나로 봄
+void buildMeshLODs(const vector<float>& vertices, vector<unsigned int>& indices, const vector<SubMesh>& submeshes,
+                   const glm::vec3& actualColor, vector<MeshLOD>& lods) {
+    lods.clear();
+    if (indices.empty()) return;
+
+    MeshLOD base;
+    base.submeshes = submeshes;
+    if (base.submeshes.empty()) {
+        SubMesh whole;
+        whole.indexCount = (unsigned int)indices.size();
+        whole.diffuse = actualColor;
+        base.submeshes.push_back(whole);
+    }
+    base.triangleCount = indices.size() / 3;
+    base.error = 0.0f;
+    lods.push_back(base);
+    if (!generateLODs) return;
+
+    glm::vec3 minBound = vertexPosition(vertices, 0), maxBound = minBound;
+    for (size_t v = 1; v < vertices.size() / 5; v++) {
+        minBound = glm::min(minBound, vertexPosition(vertices, (unsigned int)v));
+        maxBound = glm::max(maxBound, vertexPosition(vertices, (unsigned int)v));
+    }
+    float diagonal = glm::length(maxBound - minBound);
+    if (diagonal <= 0.0f) return;
+
+    vector<char> locked;
+    findLockedVertices(vertices, indices, base.submeshes, locked);
+    size_t vertexCount = vertices.size() / 5;
+
+    // 모든 레벨을 구간마다 한 번의 단순화로 만듦 (레벨 i = 삼각형 수 1/2^i)
+    vector<vector<unsigned int> > levelIndices(MAX_LOD_LEVELS - 1);
+    vector<double> levelCosts(MAX_LOD_LEVELS - 1, 0.0);
+    vector<vector<SubMesh> > levelRanges(MAX_LOD_LEVELS - 1);
+    for (size_t r = 0; r < base.submeshes.size(); r++) {
+        const SubMesh& range = base.submeshes[r];
+        size_t triangleCount = range.indexCount / 3;
+        vector<size_t> targets;
+        for (int level = 1; level < MAX_LOD_LEVELS; level++) {
+            targets.push_back(triangleCount >> level);
+            SubMesh lodRange = range;
+            lodRange.firstIndex = (unsigned int)levelIndices[level - 1].size();
+            lodRange.meshletCount = 0; // meshlet은 level 0에만 있음
+            levelRanges[level - 1].push_back(lodRange);
+        }
+        simplifyRange(vertices, &indices[range.firstIndex], triangleCount, targets, locked, levelIndices, levelCosts);
+        for (int level = 1; level < MAX_LOD_LEVELS; level++) {
+            SubMesh& lodRange = levelRanges[level - 1].back();
+            lodRange.indexCount = (unsigned int)(levelIndices[level - 1].size() - lodRange.firstIndex);
+        }
+    }
+
+    for (int level = 1; level < MAX_LOD_LEVELS; level++) {
+        MeshLOD lod;
+        vector<unsigned int>& lodIndices = levelIndices[level - 1];
+        lod.submeshes = levelRanges[level - 1];
+        lod.triangleCount = lodIndices.size() / 3;
+        double maxCost = levelCosts[level - 1];
+
+        // 더 줄어들지 않으면 (seam/경계만 남음) 체인 끝
+        if (lod.triangleCount * 10 > lods.back().triangleCount * 9) break;
+
+        optimizeVertexCache(lodIndices, vertexCount, lod.submeshes);
+        lod.error = (float)(sqrt(maxCost) / diagonal);
+        unsigned int offset = (unsigned int)indices.size();
+        for (size_t r = 0; r < lod.submeshes.size(); r++) lod.submeshes[r].firstIndex += offset;
+        indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
+        lods.push_back(lod);
+    }
+}
+
+// 바운딩 박스 8개 모서리를 MVP로 투영한 NDC 사각형 (pickObject와 LOD 선택이 같이 씀)
+// 모서리 하나라도 카메라 뒤(w <= 0)면 false
+bool projectBoundingBox(const glm::mat4& MVP, const glm::vec3& minBound, const glm::vec3& maxBound,
+                        float& minX, float& maxX, float& minY, float& maxY) {
+    minX = 1000; maxX = -1000; minY = 1000; maxY = -1000;
+    bool inFront = true;
+    for (int i = 0; i < 8; i++) {
+        glm::vec3 corner((i & 1) ? maxBound.x : minBound.x, (i & 2) ? maxBound.y : minBound.y, (i & 4) ? maxBound.z : minBound.z);
+        glm::vec4 projected = MVP * glm::vec4(corner, 1.0f);
+        if (projected.w <= 0.0f) inFront = false;
+        projected /= projected.w;  // 동차좌표를 일반좌표로 변환
+        minX = min(minX, projected.x);
+        maxX = max(maxX, projected.x);
+        minY = min(minY, projected.y);
+        maxY = max(maxY, projected.y);
+    }
+    return inFront;
+}
+
+// 화면 크기(픽셀) * LOD 상대 오차가 LOD_PIXEL_ERROR 이하인 가장 거친 LOD
+int selectLODForScreenSize(const vector<MeshLOD>& lods, float screenSize) {
+    int level = 0;
+    for (size_t i = 1; i < lods.size(); i++)
+        if (lods[i].error * screenSize <= LOD_PIXEL_ERROR) level = (int)i;
+    return level;
+}
+
+// 화면에 투영한 바운딩 박스 크기로 LOD 선택
+int selectLOD(const vector<MeshLOD>& lods, const glm::mat4& MVP, const glm::vec3& minBound, const glm::vec3& maxBound, int viewportPixels) {
+    float minX, maxX, minY, maxY;
+    if (lods.size() < 2 || !projectBoundingBox(MVP, minBound, maxBound, minX, maxX, minY, maxY)) return 0;
+    return selectLODForScreenSize(lods, max(maxX - minX, maxY - minY) * 0.5f * viewportPixels);
+}
+
+// ===== Meshlet 분할 + CPU 컬링 =====
+// 재질 구간 안에서 이웃한 삼각형을 정점 64개 / 삼각형 124개까지 모아 meshlet 하나로 만들고 그 순서로 인덱스를 다시 씀
+// → meshlet이 인덱스 버퍼의 연속 구간이라 glDrawElements 경로 그대로 그릴 수 있음
+// 매 프레임 바운딩 구로 절두체 밖, 법선 콘으로 전부 뒷면인 meshlet을 건너뜀 (닫힌 불투명 메시 가정)
+
+bool cullMeshletsEnabled = true;
+const unsigned int MESHLET_MAX_VERTICES = 64;
+const unsigned int MESHLET_MAX_TRIANGLES = 124;
+
+vector<Meshlet> cubeMeshlets;
+vector<Meshlet> piggyMeshlets;
+
+struct MeshletCullStats {
+    size_t meshlets;
+    size_t frustumCulled;
+    size_t coneCulled;
+    size_t triangles;          // 전체 삼각형
+    size_t trianglesCulled;    // 컬링된 meshlet의 삼각형
+};
+
+// 삼각형 [firstIndex, firstIndex + indexCount) 의 바운딩 구와 법선 콘
+static void computeMeshletBounds(const vector<float>& vertices, const vector<unsigned int>& indices, Meshlet& meshlet) {
+    const unsigned int* tri = &indices[meshlet.firstIndex];
+    size_t triangleCount = meshlet.indexCount / 3;
+
+    glm::vec3 minBound = vertexPosition(vertices, tri[0]), maxBound = minBound;
+    for (size_t i = 1; i < meshlet.indexCount; i++) {
+        minBound = glm::min(minBound, vertexPosition(vertices, tri[i]));
+        maxBound = glm::max(maxBound, vertexPosition(vertices, tri[i]));
+    }
+    meshlet.center = (minBound + maxBound) * 0.5f;
+    meshlet.radius = 0.0f;
+    for (size_t i = 0; i < meshlet.indexCount; i++)
+        meshlet.radius = max(meshlet.radius, glm::length(vertexPosition(vertices, tri[i]) - meshlet.center));
+
+    // 콘 축 = 삼각형 법선 평균, 반각 = 축과 가장 벌어진 법선
+    vector<glm::vec3> normals(triangleCount);
+    glm::vec3 axis(0.0f);
+    for (size_t t = 0; t < triangleCount; t++) {
+        glm::vec3 a = vertexPosition(vertices, tri[t * 3]), b = vertexPosition(vertices, tri[t * 3 + 1]), c = vertexPosition(vertices, tri[t * 3 + 2]);
+        glm::vec3 n = glm::cross(b - a, c - a);
+        float length = glm::length(n);
+        normals[t] = length > 0.0f ? n / length : glm::vec3(0.0f);
+        axis += normals[t];
+    }
+    float axisLength = glm::length(axis);
+    meshlet.coneAxis = axisLength > 0.0f ? axis / axisLength : glm::vec3(0, 0, 1);
+    meshlet.coneApex = meshlet.center;
+    meshlet.coneCutoff = 2.0f;
+    if (axisLength <= 0.0f) return;
+
+    float minDot = 1.0f;
+    for (size_t t = 0; t < triangleCount; t++)
+        if (normals[t] != glm::vec3(0.0f)) minDot = min(minDot, glm::dot(meshlet.coneAxis, normals[t]));
+    if (minDot <= 0.1f) return; // 거의 반구 이상으로 퍼진 meshlet은 콘 컬링 안 함
+
+    // apex: 축을 따라 뒤로 물러나 모든 삼각형 평면의 뒤쪽(앞면 쪽이 아닌 곳)에 오는 점
+    float maxT = 0.0f;
+    for (size_t t = 0; t < triangleCount; t++) {
+        float denominator = glm::dot(meshlet.coneAxis, normals[t]);
+        if (denominator <= 0.0f) continue;
+        float distance = glm::dot(meshlet.center - vertexPosition(vertices, tri[t * 3]), normals[t]) / denominator;
+        maxT = max(maxT, distance);
+    }
+    meshlet.coneApex = meshlet.center - meshlet.coneAxis * maxT;
+    meshlet.coneCutoff = sqrt(1.0f - minDot * minDot); // sin(반각) = cos(90° - 반각)
+}
+
+// meshlet 하나의 삼각형 순서를 Tipsify로 (정점을 meshlet 안 번호로 바꿔서 돌리므로 비용은 meshlet 크기에 비례)
+// localIndex: 메시 정점 수 크기, 전부 ~0u로 들어와서 ~0u로 돌려 놓음
+static void tipsifyMeshlet(unsigned int* tri, size_t indexCount, vector<unsigned int>& localIndex) {
+    vector<unsigned int> local(indexCount), globalIndex;
+    for (size_t i = 0; i < indexCount; i++) {
+        unsigned int& slot = localIndex[tri[i]];
+        if (slot == ~0u) {
+            slot = (unsigned int)globalIndex.size();
+            globalIndex.push_back(tri[i]);
+        }
+        local[i] = slot;
+    }
+    size_t localCount = globalIndex.size();
+    vector<int> liveTriangles(localCount), cacheTime(localCount);
+    vector<unsigned int> adjacencyOffsets(localCount + 1);
+    tipsifyRange(local, 0, indexCount, localCount, VERTEX_CACHE_SIZE, liveTriangles, cacheTime, adjacencyOffsets);
+    for (size_t i = 0; i < indexCount; i++) tri[i] = globalIndex[local[i]];
+    for (size_t v = 0; v < localCount; v++) localIndex[globalIndex[v]] = ~0u;
+}
+
+// 재질 구간마다 meshlet을 만들고 구간의 firstMeshlet/meshletCount를 채움
+// 이미 meshlet에 들어간 정점을 쓰는 삼각형 중 새 정점이 적고 법선이 meshlet 평균과 비슷한 것부터 붙여서 키움
+// (콘이 좁아야 뒷면 컬링이 잘 됨). 구간 안의 삼각형은 meshlet 순서로 다시 쓰므로 optimizeMesh의 Tipsify 순서가 깨짐
+// -> meshlet마다 안에서 Tipsify를 다시 돌려 정점 캐시 순서를 되살리고, 정점 fetch 순서도 다시 맞춤
+void buildMeshlets(vector<float>& vertices, vector<unsigned int>& indices, vector<SubMesh>& submeshes, vector<Meshlet>& meshlets) {
+    meshlets.clear();
+    size_t vertexCount = vertices.size() / 5;
+    vector<unsigned int> lastMeshlet(vertexCount, ~0u); // 정점이 마지막으로 들어간 meshlet 번호
+    vector<unsigned int> localIndex(vertexCount, ~0u);  // tipsifyMeshlet용
+
+    // 정점 → 삼각형 인접 리스트 (CSR)는 메시 전체로 한 번만 (삼각형 번호는 메시 기준)
+    // 구간은 자기 삼각형만 다시 쓰므로, 다른 구간 삼각형은 번호 범위로 걸러내면 앞 구간을 처리한 뒤에도 그대로 쓸 수 있음
+    size_t meshTriangles = indices.size() / 3;
+    vector<unsigned int> offsets(vertexCount + 1, 0);
+    for (size_t i = 0; i < meshTriangles * 3; i++) offsets[indices[i] + 1]++;
+    for (size_t v = 0; v < vertexCount; v++) offsets[v + 1] += offsets[v];
+    vector<unsigned int> adjacency(meshTriangles * 3);
+    {
+        vector<unsigned int> fillPos(offsets.begin(), offsets.end() - 1);
+        for (size_t t = 0; t < meshTriangles; t++)
+            for (int c = 0; c < 3; c++) adjacency[fillPos[indices[t * 3 + c]]++] = (unsigned int)t;
+    }
+
+    for (size_t r = 0; r < submeshes.size(); r++) {
+        SubMesh& range = submeshes[r];
+        range.firstMeshlet = (unsigned int)meshlets.size();
+        size_t triangleCount = range.indexCount / 3;
+        if (triangleCount == 0) {
+            range.meshletCount = 0;
+            continue;
+        }
+        const unsigned int* input = &indices[range.firstIndex];
+        size_t firstTriangle = range.firstIndex / 3;
+
+        // 구간 삼각형 법선
+        vector<glm::vec3> normals(triangleCount);
+        for (size_t t = 0; t < triangleCount; t++) {
+            glm::vec3 a = vertexPosition(vertices, input[t * 3]), b = vertexPosition(vertices, input[t * 3 + 1]), c = vertexPosition(vertices, input[t * 3 + 2]);
+            glm::vec3 n = glm::cross(b - a, c - a);
+            float length = glm::length(n);
+            normals[t] = length > 0.0f ? n / length : glm::vec3(0.0f);
+        }
+
+        vector<char> emitted(triangleCount, 0);
+        vector<unsigned int> output;
+        output.reserve(triangleCount * 3);
+        size_t cursor = 0;
+        vector<unsigned int> meshletVertices;
+
+        while (output.size() < triangleCount * 3) {
+            unsigned int meshletId = (unsigned int)meshlets.size();
+            Meshlet meshlet;
+            meshlet.firstIndex = range.firstIndex + (unsigned int)output.size();
+            meshletVertices.clear();
+            glm::vec3 normalSum(0.0f);
+            unsigned int meshletTriangles = 0;
+
+            while (meshletTriangles < MESHLET_MAX_TRIANGLES) {
+                // 후보: meshlet 정점에 붙은 삼각형. 없으면 입력 순서상 다음 삼각형
+                long long best = -1;
+                float bestScore = FLT_MAX;
+                glm::vec3 axis = glm::length(normalSum) > 0.0f ? glm::normalize(normalSum) : glm::vec3(0.0f);
+                for (size_t i = 0; i < meshletVertices.size(); i++) {
+                    unsigned int v = meshletVertices[i];
+                    for (unsigned int a = offsets[v]; a < offsets[v + 1]; a++) {
+                        size_t t = adjacency[a] - firstTriangle; // 앞 구간이면 언더플로로 커져서 걸러짐
+                        if (t >= triangleCount || emitted[t]) continue;
+                        int added = 0;
+                        for (int c = 0; c < 3; c++) added += lastMeshlet[input[t * 3 + c]] != meshletId;
+                        float score = added + (1.0f - glm::dot(axis, normals[t])) * 2.0f;
+                        if (score < bestScore) {
+                            bestScore = score;
+                            best = t;
+                        }
+                    }
+                }
+                if (best < 0) {
+                    if (meshletTriangles > 0) break; // 이어진 삼각형이 없으면 새 meshlet
+                    while (emitted[cursor]) cursor++;
+                    best = (long long)cursor;
+                }
+
+                const unsigned int* tri = &input[best * 3];
+                unsigned int added = 0;
+                for (int c = 0; c < 3; c++) {
+                    bool repeated = (c > 0 && tri[0] == tri[c]) || (c > 1 && tri[1] == tri[c]);
+                    if (lastMeshlet[tri[c]] != meshletId && !repeated) added++;
+                }
+                if (meshletVertices.size() + added > MESHLET_MAX_VERTICES) break;
+                for (int c = 0; c < 3; c++) {
+                    if (lastMeshlet[tri[c]] == meshletId) continue;
+                    lastMeshlet[tri[c]] = meshletId;
+                    meshletVertices.push_back(tri[c]);
+                }
+                output.insert(output.end(), tri, tri + 3);
+                emitted[best] = 1;
+                normalSum += normals[best];
+                meshletTriangles++;
+            }
+            meshlet.indexCount = range.firstIndex + (unsigned int)output.size() - meshlet.firstIndex;
+            meshlets.push_back(meshlet);
+        }
+
+        if (optimizeMeshes)
+            for (size_t m = range.firstMeshlet; m < meshlets.size(); m++)
+                tipsifyMeshlet(&output[meshlets[m].firstIndex - range.firstIndex], meshlets[m].indexCount, localIndex);
+        memcpy(&indices[range.firstIndex], &output[0], output.size() * sizeof(unsigned int));
+        range.meshletCount = (unsigned int)meshlets.size() - range.firstMeshlet;
+        for (size_t m = range.firstMeshlet; m < meshlets.size(); m++) computeMeshletBounds(vertices, indices, meshlets[m]);
+    }
+    if (optimizeMeshes) optimizeVertexFetch(vertices, indices);
+}
+
+// MVP에서 절두체 평면 6개 (Gribb-Hartmann). 모델 공간 평면이고 법선은 정규화, 안쪽이 양수
+void extractFrustumPlanes(const glm::mat4& MVP, glm::vec4 planes[6]) {
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; i++) rows[i] = glm::vec4(MVP[0][i], MVP[1][i], MVP[2][i], MVP[3][i]);
+    for (int i = 0; i < 3; i++) {
+        planes[i * 2] = rows[3] + rows[i];
+        planes[i * 2 + 1] = rows[3] - rows[i];
+    }
+    for (int i = 0; i < 6; i++) {
+        float length = glm::length(glm::vec3(planes[i].x, planes[i].y, planes[i].z));
+        if (length > 0.0f) planes[i] = planes[i] / length;
+    }
+}
+
+// cameraPosition은 모델 공간 카메라 위치 (inverse(View * Model) * (0,0,0,1))
+void cullMeshlets(const vector<Meshlet>& meshlets, const glm::mat4& MVP, const glm::vec3& cameraPosition, vector<char>& visible,
+                  MeshletCullStats* stats = nullptr) {
+    glm::vec4 planes[6];
+    extractFrustumPlanes(MVP, planes);
+    visible.assign(meshlets.size(), 1);
+    MeshletCullStats counts = { meshlets.size(), 0, 0, 0, 0 };
+
+    for (size_t m = 0; m < meshlets.size(); m++) {
+        const Meshlet& meshlet = meshlets[m];
+        counts.triangles += meshlet.indexCount / 3;
+
+        bool outside = false;
+        for (int p = 0; p < 6 && !outside; p++)
+            outside = glm::dot(glm::vec3(planes[p].x, planes[p].y, planes[p].z), meshlet.center) + planes[p].w < -meshlet.radius;
+        if (outside) {
+            visible[m] = 0;
+            counts.frustumCulled++;
+            counts.trianglesCulled += meshlet.indexCount / 3;
+            continue;
+        }
+
+        glm::vec3 view = meshlet.coneApex - cameraPosition;
+        float viewLength = glm::length(view);
+        if (viewLength > 0.0f && glm::dot(view, meshlet.coneAxis) >= meshlet.coneCutoff * viewLength) {
+            visible[m] = 0;
+            counts.coneCulled++;
+            counts.trianglesCulled += meshlet.indexCount / 3;
+        }
+    }
+    if (stats) *stats = counts;
+}
+
+// ===== 물체 AABB 절두체 컬링 (SIMD) =====
+// 월드 공간 AABB를 center/extent SoA로 모아 두고 Projection * View의 평면 6개로 한 번에 검사
+// 박스가 평면 바깥쪽에 완전히 있으면 (center 거리 + |n|·extent < 0) 컬링. 남은 박스 번호만 visible에 채움
+// AVX(8개) > SSE(4개) > 스칼라 순으로 빌드에 있는 것을 씀, 나머지 꼬리는 스칼라
+
+enum CullKernel { CULL_KERNEL_SCALAR, CULL_KERNEL_SSE, CULL_KERNEL_AVX };
+
+struct AABBList {
+    vector<float> centerX, centerY, centerZ;
+    vector<float> extentX, extentY, extentZ;
+
+    size_t size() const { return centerX.size(); }
+
+    void clear() {
+        centerX.clear(); centerY.clear(); centerZ.clear();
+        extentX.clear(); extentY.clear(); extentZ.clear();
+    }
+
+    void add(const glm::vec3& minBound, const glm::vec3& maxBound) {
+        glm::vec3 center = (minBound + maxBound) * 0.5f, extent = (maxBound - minBound) * 0.5f;
+        centerX.push_back(center.x); centerY.push_back(center.y); centerZ.push_back(center.z);
+        extentX.push_back(extent.x); extentY.push_back(extent.y); extentZ.push_back(extent.z);
+    }
+
+    // 모델 공간 AABB를 model로 옮긴 월드 AABB (Arvo: extent는 |회전 행렬|로 변환)
+    void addTransformed(const glm::mat4& model, const glm::vec3& minBound, const glm::vec3& maxBound) {
+        glm::vec3 center = glm::vec3(model * glm::vec4((minBound + maxBound) * 0.5f, 1.0f));
+        glm::vec3 extent = (maxBound - minBound) * 0.5f, worldExtent(0.0f);
+        for (int row = 0; row < 3; row++)
+            for (int column = 0; column < 3; column++) worldExtent[row] += fabs(model[column][row]) * extent[column];
+        add(center - worldExtent, center + worldExtent);
+    }
+};
+
+AABBList sceneBoxes;                 // renderScene에서 매 프레임 채움 (0: cube, 1: piggy)
+vector<unsigned int> visibleObjects; // sceneBoxes 중 보이는 번호
+
+#if defined(CULL_AVX)
+const CullKernel DEFAULT_CULL_KERNEL = CULL_KERNEL_AVX;
+#elif defined(CULL_SSE)
+const CullKernel DEFAULT_CULL_KERNEL = CULL_KERNEL_SSE;
+#else
+const CullKernel DEFAULT_CULL_KERNEL = CULL_KERNEL_SCALAR;
+#endif
+
+// [begin, end) 구간 스칼라 검사, visible[count]부터 채우고 새 count 반환
+static size_t cullAABBsScalar(const AABBList& boxes, const glm::vec4 planes[6], size_t begin, size_t end, unsigned int* visible, size_t count) {
+    for (size_t i = begin; i < end; i++) {
+        bool outside = false;
+        for (int p = 0; p < 6; p++) {
+            float distance = planes[p].x * boxes.centerX[i] + planes[p].y * boxes.centerY[i] + planes[p].z * boxes.centerZ[i] + planes[p].w;
+            float radius = fabs(planes[p].x) * boxes.extentX[i] + fabs(planes[p].y) * boxes.extentY[i] + fabs(planes[p].z) * boxes.extentZ[i];
+            outside = outside || distance + radius < 0.0f;
+        }
+        visible[count] = (unsigned int)i;
+        count += outside ? 0 : 1;
+    }
+    return count;
+}
+
+#ifdef CULL_SSE
+static size_t cullAABBsSSE(const AABBList& boxes, const glm::vec4 planes[6], unsigned int* visible, size_t& processed) {
+    __m128 normal[6][3], absNormal[6][3], offset[6];
+    for (int p = 0; p < 6; p++) {
+        for (int a = 0; a < 3; a++) {
+            normal[p][a] = _mm_set1_ps(planes[p][a]);
+            absNormal[p][a] = _mm_set1_ps(fabs(planes[p][a]));
+        }
+        offset[p] = _mm_set1_ps(planes[p].w);
+    }
+    const __m128 zero = _mm_setzero_ps();
+    size_t count = 0, n = boxes.size() & ~(size_t)3;
+    for (size_t i = 0; i < n; i += 4) {
+        __m128 cx = _mm_loadu_ps(&boxes.centerX[i]), cy = _mm_loadu_ps(&boxes.centerY[i]), cz = _mm_loadu_ps(&boxes.centerZ[i]);
+        __m128 ex = _mm_loadu_ps(&boxes.extentX[i]), ey = _mm_loadu_ps(&boxes.extentY[i]), ez = _mm_loadu_ps(&boxes.extentZ[i]);
+        __m128 outside = zero;
+        for (int p = 0; p < 6; p++) {
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(normal[p][0], cx), _mm_mul_ps(normal[p][1], cy)),
+                                         _mm_add_ps(_mm_mul_ps(normal[p][2], cz), offset[p]));
+            __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(absNormal[p][0], ex), _mm_mul_ps(absNormal[p][1], ey)), _mm_mul_ps(absNormal[p][2], ez));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), zero));
+        }
+        int mask = ~_mm_movemask_ps(outside);
+        for (int k = 0; k < 4; k++) {
+            visible[count] = (unsigned int)(i + k);
+            count += (mask >> k) & 1;
+        }
+    }
+    processed = n;
+    return count;
+}
+#endif
+
+#ifdef CULL_AVX
+static size_t cullAABBsAVX(const AABBList& boxes, const glm::vec4 planes[6], unsigned int* visible, size_t& processed) {
+    __m256 normal[6][3], absNormal[6][3], offset[6];
+    for (int p = 0; p < 6; p++) {
+        for (int a = 0; a < 3; a++) {
+            normal[p][a] = _mm256_set1_ps(planes[p][a]);
+            absNormal[p][a] = _mm256_set1_ps(fabs(planes[p][a]));
+        }
+        offset[p] = _mm256_set1_ps(planes[p].w);
+    }
+    const __m256 zero = _mm256_setzero_ps();
+    size_t count = 0, n = boxes.size() & ~(size_t)7;
+    for (size_t i = 0; i < n; i += 8) {
+        __m256 cx = _mm256_loadu_ps(&boxes.centerX[i]), cy = _mm256_loadu_ps(&boxes.centerY[i]), cz = _mm256_loadu_ps(&boxes.centerZ[i]);
+        __m256 ex = _mm256_loadu_ps(&boxes.extentX[i]), ey = _mm256_loadu_ps(&boxes.extentY[i]), ez = _mm256_loadu_ps(&boxes.extentZ[i]);
+        __m256 outside = zero;
+        for (int p = 0; p < 6; p++) {
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(normal[p][0], cx), _mm256_mul_ps(normal[p][1], cy)),
+                                            _mm256_add_ps(_mm256_mul_ps(normal[p][2], cz), offset[p]));
+            __m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(absNormal[p][0], ex), _mm256_mul_ps(absNormal[p][1], ey)),
+                                          _mm256_mul_ps(absNormal[p][2], ez));
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), zero, _CMP_LT_OQ));
+        }
+        int mask = ~_mm256_movemask_ps(outside);
+        for (int k = 0; k < 8; k++) {
+            visible[count] = (unsigned int)(i + k);
+            count += (mask >> k) & 1;
+        }
+    }
+    processed = n;
+    return count;
+}
+#endif
+
+// boxes 중 절두체와 겹치는 박스 번호를 오름차순으로 visible에 채우고 개수 반환
+// 빌드에 없는 kernel을 고르면 있는 것 중 가장 넓은 것으로 내려감
+size_t cullAABBs(const AABBList& boxes, const glm::mat4& ViewProjection, vector<unsigned int>& visible, CullKernel kernel = DEFAULT_CULL_KERNEL) {
+    glm::vec4 planes[6];
+    extractFrustumPlanes(ViewProjection, planes);
+    visible.resize(boxes.size());
+    if (boxes.size() == 0) return 0;
+
+    size_t count = 0, processed = 0;
+#ifdef CULL_AVX
+    if (kernel == CULL_KERNEL_AVX) count = cullAABBsAVX(boxes, planes, &visible[0], processed);
+#else
+    if (kernel == CULL_KERNEL_AVX) kernel = CULL_KERNEL_SSE;
+#endif
+#ifdef CULL_SSE
+    if (kernel == CULL_KERNEL_SSE) count = cullAABBsSSE(boxes, planes, &visible[0], processed);
+#endif
+    count = cullAABBsScalar(boxes, planes, processed, boxes.size(), &visible[0], count);
+    visible.resize(count);
+    return count;
+}
+
+// ===== 배치 변환 (SoA + SIMD) =====
+// 물체 회전(X, Y 도)과 위치를 성분별 배열(SoA)로 두고 model / MVP 행렬을 한 번에 계산
+// model = T * Rx * Ry를 닫힌 식으로 (glm::translate + glm::rotate 두 번과 같은 값), MVP = ViewProjection * model
+// SSE면 sin/cos 다항식 근사로 물체 4개씩 계산해서 4x4 전치로 mat4마다 저장, 물체가 많으면 구간을 나눠 frameWorkers 풀에서
+// 카메라가 바뀐 프레임에는 전부, 아니면 회전 / 위치가 바뀐 물체(dirty 목록)만 다시 계산
+
+enum TransformKernel { TRANSFORM_KERNEL_SCALAR, TRANSFORM_KERNEL_SSE };
+
+const size_t TRANSFORM_MIN_CHUNK = 16384; // 스레드 하나가 맡는 최소 물체 수
+
+struct TransformBatch {
+    vector<float> rotationX, rotationY; // 도
+    vector<float> positionX, positionY, positionZ;
+    vector<glm::mat4> model;            // updateTransformBatch 결과
+    vector<glm::mat4> MVP;
+    vector<unsigned int> dirtyIndices;  // 회전 / 위치가 바뀐 물체 (중복 없음)
+    vector<char> dirty;                 // 물체마다 dirtyIndices에 있는지
+    unsigned int cameraVersion;         // MVP를 계산할 때의 CameraState::version
+
+    TransformBatch() : cameraVersion(0) {}
+
+    size_t size() const { return rotationX.size(); }
+
+    size_t add(float angleX, float angleY, const glm::vec3& position) {
+        rotationX.push_back(angleX); rotationY.push_back(angleY);
+        positionX.push_back(position.x); positionY.push_back(position.y); positionZ.push_back(position.z);
+        model.push_back(glm::mat4(1.0f));
+        MVP.push_back(glm::mat4(1.0f));
+        dirty.push_back(0);
+        markDirty(size() - 1);
+        return size() - 1;
+    }
+
+    void markDirty(size_t index) {
+        if (dirty[index]) return;
+        dirty[index] = 1;
+        dirtyIndices.push_back((unsigned int)index);
+    }
+
+    void markAllDirty() {
+        for (size_t i = 0; i < size(); i++) markDirty(i);
+    }
+
+    void rotate(size_t index, float deltaX, float deltaY) {
+        rotationX[index] += deltaX;
+        rotationY[index] += deltaY;
+        markDirty(index);
+    }
+};
+
+TransformBatch sceneTransforms;
+
+// 물체 하나의 변환 (배치 안의 자기 번호). rotate()는 이 물체만 dirty 목록에 올리고, 행렬은 배치가 계산한 값을 읽음
+struct Transform {
+    TransformBatch* batch;
+    size_t index;
+
+    Transform() : batch(nullptr), index(0) {}
+    Transform(TransformBatch& owner, size_t slot) : batch(&owner), index(slot) {}
+
+    void rotate(float deltaX, float deltaY) { batch->rotate(index, deltaX, deltaY); }
+    float rotationX() const { return batch->rotationX[index]; }
+    float rotationY() const { return batch->rotationY[index]; }
+    const glm::mat4& model() const { return batch->model[index]; }
+    const glm::mat4& MVP() const { return batch->MVP[index]; }
+};
+
+// 개별 물체 회전 (main에서 sceneTransforms에 추가)
+Transform cubeTransform;
+Transform piggyTransform;
+
+#if defined(CULL_SSE)
+const TransformKernel DEFAULT_TRANSFORM_KERNEL = TRANSFORM_KERNEL_SSE;
+#else
+const TransformKernel DEFAULT_TRANSFORM_KERNEL = TRANSFORM_KERNEL_SCALAR;
+#endif
+
+// 월드 좌표 점을 물체 모델 공간으로 (회전 + 이동뿐이라 역행렬 = 회전 전치)
+glm::vec3 worldToModel(const glm::mat4& model, const glm::vec3& point) {
+    glm::vec3 offset = point - glm::vec3(model[3]);
+    return glm::vec3(glm::dot(glm::vec3(model[0]), offset), glm::dot(glm::vec3(model[1]), offset), glm::dot(glm::vec3(model[2]), offset));
+}
+
+// [begin, end) 구간 스칼라 계산
+static void buildTransformsScalar(TransformBatch& batch, const glm::mat4& ViewProjection, size_t begin, size_t end) {
+    const float toRadians = 3.14159265358979f / 180.0f;
+    for (size_t i = begin; i < end; i++) {
+        float sa = sinf(batch.rotationX[i] * toRadians), ca = cosf(batch.rotationX[i] * toRadians);
+        float sb = sinf(batch.rotationY[i] * toRadians), cb = cosf(batch.rotationY[i] * toRadians);
+        glm::mat4& model = batch.model[i];
+        model[0] = glm::vec4(cb, sa * sb, -ca * sb, 0.0f);
+        model[1] = glm::vec4(0.0f, ca, sa, 0.0f);
+        model[2] = glm::vec4(sb, -sa * cb, ca * cb, 0.0f);
+        model[3] = glm::vec4(batch.positionX[i], batch.positionY[i], batch.positionZ[i], 1.0f);
+        batch.MVP[i] = ViewProjection * model;
+    }
+}
+
+#ifdef CULL_SSE
+// 라디안 4개의 sin / cos (사분면으로 줄인 뒤 [-pi/4, pi/4]에서 Cephes 다항식, 오차 ~1e-7)
+static inline void sinCos4(__m128 x, __m128& sine, __m128& cosine) {
+    __m128 quadrant = _mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(0.636619772f))));
+    __m128i q = _mm_cvtps_epi32(quadrant);
+    __m128 r = _mm_sub_ps(x, _mm_mul_ps(quadrant, _mm_set1_ps(1.5703125f)));
+    r = _mm_sub_ps(r, _mm_mul_ps(quadrant, _mm_set1_ps(4.83751297e-4f)));
+    r = _mm_sub_ps(r, _mm_mul_ps(quadrant, _mm_set1_ps(7.54978995e-8f)));
+    __m128 r2 = _mm_mul_ps(r, r);
+
+    __m128 s = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(-1.9515295891e-4f), r2), _mm_set1_ps(8.3321608736e-3f));
+    s = _mm_add_ps(_mm_mul_ps(s, r2), _mm_set1_ps(-1.6666654611e-1f));
+    s = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(s, r2), r), r);
+    __m128 c = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(2.443315711809948e-5f), r2), _mm_set1_ps(-1.388731625493765e-3f));
+    c = _mm_add_ps(_mm_mul_ps(c, r2), _mm_set1_ps(4.166664568298827e-2f));
+    c = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(_mm_mul_ps(c, r2), r2), _mm_mul_ps(r2, _mm_set1_ps(0.5f))), _mm_set1_ps(1.0f));
+
+    // 사분면 q: sin = (s, c, -s, -c)[q & 3], cos = (c, -s, -c, s)[q & 3]
+    __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+    __m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(q, _mm_set1_epi32(2)), 30));
+    __m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(q, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+    sine = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s)), sinSign);
+    cosine = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c)), cosSign);
+}
+
+// 물체 4개의 열 하나(행 0~3이 lane별로 들어 있음)를 전치해서 각 mat4의 column에 저장
+static inline void storeColumn4(glm::mat4* matrices, int column, __m128 row0, __m128 row1, __m128 row2, __m128 row3) {
+    _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+    _mm_storeu_ps(&matrices[0][column][0], row0);
+    _mm_storeu_ps(&matrices[1][column][0], row1);
+    _mm_storeu_ps(&matrices[2][column][0], row2);
+    _mm_storeu_ps(&matrices[3][column][0], row3);
+}
+
+// [begin, end)에서 4개 단위 부분을 SSE로, 반환값: 처리한 끝 (나머지는 스칼라)
+static size_t buildTransformsSSE(TransformBatch& batch, const glm::mat4& ViewProjection, size_t begin, size_t end) {
+    __m128 vp[4][4]; // vp[k][r] = ViewProjection[k][r]
+    for (int k = 0; k < 4; k++)
+        for (int r = 0; r < 4; r++) vp[k][r] = _mm_set1_ps(ViewProjection[k][r]);
+    const __m128 toRadians = _mm_set1_ps(3.14159265358979f / 180.0f), zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 sa, ca, sb, cb;
+        sinCos4(_mm_mul_ps(_mm_loadu_ps(&batch.rotationX[i]), toRadians), sa, ca);
+        sinCos4(_mm_mul_ps(_mm_loadu_ps(&batch.rotationY[i]), toRadians), sb, cb);
+        __m128 m[4][3]; // model 열 c의 행 0~2
+        m[0][0] = cb;   m[0][1] = _mm_mul_ps(sa, sb);                   m[0][2] = _mm_sub_ps(zero, _mm_mul_ps(ca, sb));
+        m[1][0] = zero; m[1][1] = ca;                                   m[1][2] = sa;
+        m[2][0] = sb;   m[2][1] = _mm_sub_ps(zero, _mm_mul_ps(sa, cb)); m[2][2] = _mm_mul_ps(ca, cb);
+        m[3][0] = _mm_loadu_ps(&batch.positionX[i]); m[3][1] = _mm_loadu_ps(&batch.positionY[i]); m[3][2] = _mm_loadu_ps(&batch.positionZ[i]);
+
+        for (int c = 0; c < 4; c++) {
+            storeColumn4(&batch.model[i], c, m[c][0], m[c][1], m[c][2], c == 3 ? one : zero);
+            __m128 out[4];
+            for (int r = 0; r < 4; r++) {
+                out[r] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vp[0][r], m[c][0]), _mm_mul_ps(vp[1][r], m[c][1])), _mm_mul_ps(vp[2][r], m[c][2]));
+                if (c == 3) out[r] = _mm_add_ps(out[r], vp[3][r]);
+            }
+            storeColumn4(&batch.MVP[i], c, out[0], out[1], out[2], out[3]);
+        }
+    }
+    return i;
+}
+#endif
+
+// [begin, end) 구간 계산 (SSE가 없거나 꼬리는 스칼라)
+static void buildTransforms(TransformBatch& batch, const glm::mat4& ViewProjection, size_t begin, size_t end, TransformKernel kernel) {
+#ifdef CULL_SSE
+    if (kernel == TRANSFORM_KERNEL_SSE) begin = buildTransformsSSE(batch, ViewProjection, begin, end);
+#endif
+    buildTransformsScalar(batch, ViewProjection, begin, end);
+}
+
+// 카메라가 바뀌었거나 dirty 물체가 1/4 이상이면 전체를 배치 커널로 (물체가 많으면 4의 배수 구간 threadCount개를 frameWorkers 풀에서)
+// 아니면 dirty 목록의 물체만 하나씩 (SSE 커널이 물체당 약 4배 빠르므로 1/4 근처에서 전체 쪽이 나음)
+// 반환값: 다시 계산했는지
+bool updateTransformBatch(TransformBatch& batch, const CameraState& camera, int threadCount = 1, TransformKernel kernel = DEFAULT_TRANSFORM_KERNEL) {
+    bool cameraChanged = batch.cameraVersion != camera.version;
+    if (!cameraChanged && batch.dirtyIndices.empty()) return false;
+
+    size_t count = batch.size();
+    if (cameraChanged || batch.dirtyIndices.size() * 4 >= count) {
+        size_t chunks = max<size_t>(1, min<size_t>((size_t)max(threadCount, 1), count / TRANSFORM_MIN_CHUNK));
+        size_t chunkSize = ((count + chunks - 1) / chunks + 3) & ~(size_t)3;
+        if (chunks == 1) {
+            buildTransforms(batch, camera.ViewProjection, 0, count, kernel);
+        } else {
+            parallelFor(frameWorkers, (int)((count + chunkSize - 1) / chunkSize), [&batch, &camera, count, chunkSize, kernel](int chunk) {
+                size_t begin = chunk * chunkSize;
+                buildTransforms(batch, camera.ViewProjection, begin, min(count, begin + chunkSize), kernel);
+            });
+        }
+    } else {
+        for (size_t i = 0; i < batch.dirtyIndices.size(); i++)
+            buildTransformsScalar(batch, camera.ViewProjection, batch.dirtyIndices[i], batch.dirtyIndices[i] + 1);
+    }
+    for (size_t i = 0; i < batch.dirtyIndices.size(); i++) batch.dirty[batch.dirtyIndices[i]] = 0;
+    batch.dirtyIndices.clear();
+    batch.cameraVersion = camera.version;
+    return true;
+}
+
+// ===== 소프트웨어 계층 Z 오클루전 컬링 (CPU) =====
+// 가까운 큰 물체 몇 개의 단순화 메시(오클루더)를 256x128 깊이 버퍼에 CPU로 그리고 2x2 최대값 피라미드를 만듦
+// AABB를 화면에 투영한 사각형이 덮는 피라미드 텍셀(2x2 이하)의 가장 먼 깊이보다 AABB의 가장 가까운 깊이가 더 멀면 가려진 것
+// 깊이는 GL과 같은 NDC z/w (작을수록 가까움). 래스터화는 행 구간을 스레드로 나누고 한 행에서 픽셀 4개씩 SSE로 처리
+// 오클루더는 LOD 오차 OCCLUDER_MAX_ERROR 이하인 가장 거친 LOD라서 원본보다 그 오차만큼 튀어나올 수 있음
+
+bool occlusionCullingEnabled = true;        // --no-occlusion 으로 끔
+const int OCCLUSION_WIDTH = 256;
+const int OCCLUSION_HEIGHT = 128;
+const int OCCLUSION_LEVELS = 8;             // 256x128 ... 2x1
+const int OCCLUSION_MAX_OCCLUDERS = 32;     // 카메라에 가까운 순
+const float OCCLUDER_MAX_ERROR = 0.01f;     // 오클루더로 쓸 LOD의 상대 오차 상한
+
+// 위치만 남긴 오클루더 메시 (쓰는 정점만 모음)
+struct OccluderMesh {
+    vector<glm::vec3> positions;
+    vector<unsigned int> indices;
+};
+
+// 화면 공간 삼각형: 모서리 함수 3개(A*x + B*y + C, 안쪽이 양수)와 깊이 평면, 픽셀 사각형
+struct OccluderTriangle {
+    float edgeA[3], edgeB[3], edgeC[3];
+    float depthA, depthB, depthC;
+    int minX, maxX, minY, maxY;
+};
+
+struct OcclusionStats {
+    size_t occluders;
+    size_t triangles;      // 래스터화한 삼각형 (뒷면 / near 평면에 걸친 것 제외)
+    size_t tested;
+    size_t occluded;
+    double rasterSeconds;
+    double pyramidSeconds;
+    double testSeconds;
+};
+
+struct OcclusionBuffer {
+    glm::mat4 ViewProjection;
+    int widths[OCCLUSION_LEVELS], heights[OCCLUSION_LEVELS];
+    vector<float> levels[OCCLUSION_LEVELS]; // level 0 = 래스터 결과, 위로 갈수록 2x2 최대값
+};
+
+// 오클루전 컬링 상태 한 벌 (메시별 오클루더 + 프레임마다 다시 쓰는 버퍼)
+struct OcclusionCuller {
+    OccluderMesh occluder;
+    OcclusionBuffer buffer;
+    OcclusionStats stats;
+};
+
+OcclusionCuller piggyOcclusion;
+
+// 오차가 OCCLUDER_MAX_ERROR 이하인 가장 거친 LOD (LOD가 없으면 원본 전체)
+void buildOccluderMesh(const vector<float>& vertices, const vector<unsigned int>& indices, const vector<SubMesh>& submeshes,
+                       const vector<MeshLOD>& lods, OccluderMesh& occluder) {
+    const vector<SubMesh>* ranges = &submeshes;
+    for (size_t level = 1; level < lods.size(); level++)
+        if (lods[level].error <= OCCLUDER_MAX_ERROR) ranges = &lods[level].submeshes;
+
+    occluder.positions.clear();
+    occluder.indices.clear();
+    vector<unsigned int> remap(vertices.size() / 5, ~0u);
+    for (size_t r = 0; r < ranges->size(); r++) {
+        const SubMesh& range = (*ranges)[r];
+        for (unsigned int i = range.firstIndex; i < range.firstIndex + range.indexCount; i++) {
+            unsigned int v = indices[i];
+            if (remap[v] == ~0u) {
+                remap[v] = (unsigned int)occluder.positions.size();
+                occluder.positions.push_back(vertexPosition(vertices, v));
+            }
+            occluder.indices.push_back(remap[v]);
+        }
+    }
+}
+
+void clearOcclusionBuffer(OcclusionBuffer& buffer, const glm::mat4& ViewProjection) {
+    buffer.ViewProjection = ViewProjection;
+    for (int level = 0; level < OCCLUSION_LEVELS; level++) {
+        buffer.widths[level] = max(OCCLUSION_WIDTH >> level, 1);
+        buffer.heights[level] = max(OCCLUSION_HEIGHT >> level, 1);
+        buffer.levels[level].assign((size_t)buffer.widths[level] * buffer.heights[level], 1.0f);
+    }
+}
+
+// model로 옮긴 오클루더 삼각형을 화면 공간으로 준비 (뒷면, 퇴화, near 평면에 걸친 삼각형은 버림 → 가림이 줄어들 뿐 틀리지 않음)
+static void setupOccluderTriangles(const OccluderMesh& occluder, const glm::mat4& MVP, vector<OccluderTriangle>& triangles) {
+    vector<glm::vec4> screen(occluder.positions.size());
+    for (size_t v = 0; v < occluder.positions.size(); v++) {
+        glm::vec4 clip = MVP * glm::vec4(occluder.positions[v], 1.0f);
+        if (clip.w <= 1e-5f) {
+            screen[v] = glm::vec4(0.0f, 0.0f, 0.0f, -1.0f);
+            continue;
+        }
+        float invW = 1.0f / clip.w;
+        screen[v] = glm::vec4((clip.x * invW * 0.5f + 0.5f) * OCCLUSION_WIDTH, (clip.y * invW * 0.5f + 0.5f) * OCCLUSION_HEIGHT, clip.z * invW, 1.0f);
+    }
+
+    for (size_t i = 0; i + 2 < occluder.indices.size(); i += 3) {
+        const glm::vec4* v[3] = { &screen[occluder.indices[i]], &screen[occluder.indices[i + 1]], &screen[occluder.indices[i + 2]] };
+        if (v[0]->w < 0.0f || v[1]->w < 0.0f || v[2]->w < 0.0f) continue;
+        float area = (v[1]->x - v[0]->x) * (v[2]->y - v[0]->y) - (v[1]->y - v[0]->y) * (v[2]->x - v[0]->x);
+        if (area <= 1e-6f) continue; // 뒷면(시계 방향) 또는 퇴화
+
+        OccluderTriangle triangle;
+        float minX = min(v[0]->x, min(v[1]->x, v[2]->x)), maxX = max(v[0]->x, max(v[1]->x, v[2]->x));
+        float minY = min(v[0]->y, min(v[1]->y, v[2]->y)), maxY = max(v[0]->y, max(v[1]->y, v[2]->y));
+        triangle.minX = max((int)floor(minX), 0);
+        triangle.maxX = min((int)ceil(maxX), OCCLUSION_WIDTH - 1);
+        triangle.minY = max((int)floor(minY), 0);
+        triangle.maxY = min((int)ceil(maxY), OCCLUSION_HEIGHT - 1);
+        if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) continue;
+
+        // 모서리 k는 v[k+1] → v[k+2] (v[k]의 무게중심 좌표 * area)
+        float invArea = 1.0f / area;
+        triangle.depthA = triangle.depthB = triangle.depthC = 0.0f;
+        for (int k = 0; k < 3; k++) {
+            const glm::vec4& a = *v[(k + 1) % 3];
+            const glm::vec4& b = *v[(k + 2) % 3];
+            triangle.edgeA[k] = -(b.y - a.y);
+            triangle.edgeB[k] = b.x - a.x;
+            triangle.edgeC[k] = -(triangle.edgeA[k] * a.x + triangle.edgeB[k] * a.y);
+            triangle.depthA += triangle.edgeA[k] * invArea * v[k]->z;
+            triangle.depthB += triangle.edgeB[k] * invArea * v[k]->z;
+            triangle.depthC += triangle.edgeC[k] * invArea * v[k]->z;
+        }
+        triangles.push_back(triangle);
+    }
+}
+
+// 행 [rowBegin, rowEnd) 안에서 삼각형들을 깊이 버퍼에 그림 (가까운 값만 남김, 픽셀 중심 기준, 모서리 위 픽셀은 안 칠함)
+static void rasterizeOccluderRows(float* depth, const vector<OccluderTriangle>& triangles, int rowBegin, int rowEnd) {
+    for (size_t t = 0; t < triangles.size(); t++) {
+        const OccluderTriangle& triangle = triangles[t];
+        int yBegin = max(triangle.minY, rowBegin), yEnd = min(triangle.maxY + 1, rowEnd);
+        int xBegin = triangle.minX & ~3;
+        for (int y = yBegin; y < yEnd; y++) {
+            float py = y + 0.5f;
+            float* row = depth + (size_t)y * OCCLUSION_WIDTH;
+#ifdef CULL_SSE
+            __m128 e0 = _mm_set1_ps(triangle.edgeB[0] * py + triangle.edgeC[0]);
+            __m128 e1 = _mm_set1_ps(triangle.edgeB[1] * py + triangle.edgeC[1]);
+            __m128 e2 = _mm_set1_ps(triangle.edgeB[2] * py + triangle.edgeC[2]);
+            __m128 z = _mm_set1_ps(triangle.depthB * py + triangle.depthC);
+            __m128 a0 = _mm_set1_ps(triangle.edgeA[0]), a1 = _mm_set1_ps(triangle.edgeA[1]), a2 = _mm_set1_ps(triangle.edgeA[2]);
+            __m128 za = _mm_set1_ps(triangle.depthA);
+            __m128 zero = _mm_setzero_ps();
+            for (int x = xBegin; x <= triangle.maxX; x += 4) {
+                __m128 px = _mm_add_ps(_mm_set1_ps(x + 0.5f), _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f));
+                __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpgt_ps(_mm_add_ps(_mm_mul_ps(a0, px), e0), zero),
+                                                      _mm_cmpgt_ps(_mm_add_ps(_mm_mul_ps(a1, px), e1), zero)),
+                                           _mm_cmpgt_ps(_mm_add_ps(_mm_mul_ps(a2, px), e2), zero));
+                __m128 current = _mm_loadu_ps(row + x);
+                __m128 nearer = _mm_min_ps(current, _mm_add_ps(_mm_mul_ps(za, px), z));
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, current)));
+            }
+#else
+            for (int x = triangle.minX; x <= triangle.maxX; x++) {
+                float px = x + 0.5f;
+                bool inside = true;
+                for (int k = 0; k < 3; k++) inside = inside && triangle.edgeA[k] * px + triangle.edgeB[k] * py + triangle.edgeC[k] > 0.0f;
+                if (inside) row[x] = min(row[x], triangle.depthA * px + triangle.depthB * py + triangle.depthC);
+            }
+#endif
+        }
+    }
+}
+
+// 오클루더 메시를 models 위치마다 그림. 화면을 가로 띠로 나눠 threadCount개까지 frameWorkers 풀이 나눠 맡음
+void rasterizeOccluders(OcclusionBuffer& buffer, const OccluderMesh& occluder, const vector<glm::mat4>& models, int threadCount, OcclusionStats* stats = nullptr) {
+    vector<OccluderTriangle> triangles;
+    for (size_t m = 0; m < models.size(); m++) setupOccluderTriangles(occluder, buffer.ViewProjection * models[m], triangles);
+
+    float* depth = &buffer.levels[0][0];
+    int bands = max(1, min(threadCount, OCCLUSION_HEIGHT / 8));
+    if (bands == 1 || triangles.empty()) {
+        rasterizeOccluderRows(depth, triangles, 0, OCCLUSION_HEIGHT);
+    } else {
+        parallelFor(frameWorkers, bands, [depth, &triangles, bands](int band) {
+            rasterizeOccluderRows(depth, triangles, OCCLUSION_HEIGHT * band / bands, OCCLUSION_HEIGHT * (band + 1) / bands);
+        });
+    }
+    if (stats) {
+        stats->occluders += models.size();
+        stats->triangles += triangles.size();
+    }
+}
+
+// 2x2 텍셀 중 가장 먼 깊이로 한 단계씩 줄임
+void buildDepthPyramid(OcclusionBuffer& buffer) {
+    for (int level = 1; level < OCCLUSION_LEVELS; level++) {
+        const vector<float>& below = buffer.levels[level - 1];
+        vector<float>& above = buffer.levels[level];
+        int belowWidth = buffer.widths[level - 1];
+        for (int y = 0; y < buffer.heights[level]; y++) {
+            const float* row0 = &below[(size_t)(y * 2) * belowWidth];
+            const float* row1 = row0 + belowWidth;
+            for (int x = 0; x < buffer.widths[level]; x++)
+                above[(size_t)y * buffer.widths[level] + x] = max(max(row0[x * 2], row0[x * 2 + 1]), max(row1[x * 2], row1[x * 2 + 1]));
+        }
+    }
+}
+
+// NDC 사각형 + 가장 가까운 깊이가 피라미드 깊이 뒤에 완전히 있으면 true
+static bool occludedByPyramid(const OcclusionBuffer& buffer, float minX, float maxX, float minY, float maxY, float nearestDepth) {
+    int x0 = max((int)floor((minX * 0.5f + 0.5f) * OCCLUSION_WIDTH), 0), x1 = min((int)floor((maxX * 0.5f + 0.5f) * OCCLUSION_WIDTH), OCCLUSION_WIDTH - 1);
+    int y0 = max((int)floor((minY * 0.5f + 0.5f) * OCCLUSION_HEIGHT), 0), y1 = min((int)floor((maxY * 0.5f + 0.5f) * OCCLUSION_HEIGHT), OCCLUSION_HEIGHT - 1);
+    if (x0 > x1 || y0 > y1) return false;
+
+    // 사각형이 2x2 텍셀 이하로 들어오는 가장 낮은 단계
+    int level = 0;
+    while (level + 1 < OCCLUSION_LEVELS && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1)) level++;
+    const vector<float>& depth = buffer.levels[level];
+    for (int y = y0 >> level; y <= (y1 >> level); y++)
+        for (int x = x0 >> level; x <= (x1 >> level); x++)
+            if (depth[(size_t)y * buffer.widths[level] + x] >= nearestDepth) return false;
+    return true;
+}
+
+// candidates(boxes 번호) 중 가려지지 않은 것만 visible에 (순서 유지), 가려진 개수 반환
+// AABB 모서리 8개 투영은 박스 4개씩 SSE, 카메라 뒤(w <= 0)에 걸친 박스는 보이는 것으로 침
+size_t cullOccludedAABBs(const OcclusionBuffer& buffer, const AABBList& boxes, const vector<unsigned int>& candidates,
+                         vector<unsigned int>& visible, OcclusionStats* stats = nullptr) {
+    const glm::mat4& M = buffer.ViewProjection;
+    visible.clear();
+    visible.reserve(candidates.size());
+    size_t i = 0;
+#ifdef CULL_SSE
+    __m128 m[4][4];
+    for (int column = 0; column < 4; column++)
+        for (int row = 0; row < 4; row++) m[column][row] = _mm_set1_ps(M[column][row]);
+    for (; i + 4 <= candidates.size(); i += 4) {
+        const unsigned int* id = &candidates[i];
+        __m128 c[3] = { _mm_set_ps(boxes.centerX[id[3]], boxes.centerX[id[2]], boxes.centerX[id[1]], boxes.centerX[id[0]]),
+                        _mm_set_ps(boxes.centerY[id[3]], boxes.centerY[id[2]], boxes.centerY[id[1]], boxes.centerY[id[0]]),
+                        _mm_set_ps(boxes.centerZ[id[3]], boxes.centerZ[id[2]], boxes.centerZ[id[1]], boxes.centerZ[id[0]]) };
+        __m128 e[3] = { _mm_set_ps(boxes.extentX[id[3]], boxes.extentX[id[2]], boxes.extentX[id[1]], boxes.extentX[id[0]]),
+                        _mm_set_ps(boxes.extentY[id[3]], boxes.extentY[id[2]], boxes.extentY[id[1]], boxes.extentY[id[0]]),
+                        _mm_set_ps(boxes.extentZ[id[3]], boxes.extentZ[id[2]], boxes.extentZ[id[1]], boxes.extentZ[id[0]]) };
+        // 중심의 clip 좌표와 축마다 extent만큼의 변화량
+        __m128 base[4], delta[3][4];
+        for (int row = 0; row < 4; row++) {
+            base[row] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0][row], c[0]), _mm_mul_ps(m[1][row], c[1])), _mm_add_ps(_mm_mul_ps(m[2][row], c[2]), m[3][row]));
+            for (int axis = 0; axis < 3; axis++) delta[axis][row] = _mm_mul_ps(m[axis][row], e[axis]);
+        }
+        __m128 minX = _mm_set1_ps(FLT_MAX), maxX = _mm_set1_ps(-FLT_MAX), minY = minX, maxY = maxX, nearest = minX;
+        __m128 behind = _mm_setzero_ps();
+        for (int corner = 0; corner < 8; corner++) {
+            __m128 clip[4];
+            for (int row = 0; row < 4; row++) {
+                __m128 value = base[row];
+                for (int axis = 0; axis < 3; axis++)
+                    value = (corner >> axis) & 1 ? _mm_add_ps(value, delta[axis][row]) : _mm_sub_ps(value, delta[axis][row]);
+                clip[row] = value;
+            }
+            behind = _mm_or_ps(behind, _mm_cmple_ps(clip[3], _mm_set1_ps(1e-5f)));
+            __m128 invW = _mm_div_ps(_mm_set1_ps(1.0f), clip[3]);
+            __m128 x = _mm_mul_ps(clip[0], invW), y = _mm_mul_ps(clip[1], invW), z = _mm_mul_ps(clip[2], invW);
+            minX = _mm_min_ps(minX, x); maxX = _mm_max_ps(maxX, x);
+            minY = _mm_min_ps(minY, y); maxY = _mm_max_ps(maxY, y);
+            nearest = _mm_min_ps(nearest, z);
+        }
+        float lanes[5][4];
+        _mm_storeu_ps(lanes[0], minX); _mm_storeu_ps(lanes[1], maxX);
+        _mm_storeu_ps(lanes[2], minY); _mm_storeu_ps(lanes[3], maxY);
+        _mm_storeu_ps(lanes[4], nearest);
+        int behindMask = _mm_movemask_ps(behind);
+        for (int k = 0; k < 4; k++) {
+            if (((behindMask >> k) & 1) || !occludedByPyramid(buffer, lanes[0][k], lanes[1][k], lanes[2][k], lanes[3][k], lanes[4][k]))
+                visible.push_back(id[k]);
+        }
+    }
+#endif
+    for (; i < candidates.size(); i++) {
+        unsigned int id = candidates[i];
+        glm::vec3 center(boxes.centerX[id], boxes.centerY[id], boxes.centerZ[id]), extent(boxes.extentX[id], boxes.extentY[id], boxes.extentZ[id]);
+        float minX, maxX, minY, maxY, nearest = FLT_MAX;
+        bool inFront = projectBoundingBox(M, center - extent, center + extent, minX, maxX, minY, maxY);
+        for (int corner = 0; corner < 8 && inFront; corner++) {
+            glm::vec3 p = center + glm::vec3((corner & 1) ? extent.x : -extent.x, (corner & 2) ? extent.y : -extent.y, (corner & 4) ? extent.z : -extent.z);
+            glm::vec4 clip = M * glm::vec4(p, 1.0f);
+            nearest = min(nearest, clip.z / clip.w);
+        }
+        if (!inFront || !occludedByPyramid(buffer, minX, maxX, minY, maxY, nearest)) visible.push_back(id);
+    }
+
+    size_t occluded = candidates.size() - visible.size();
+    if (stats) {
+        stats->tested += candidates.size();
+        stats->occluded += occluded;
+    }
+    return occluded;
+}
+
+// ===== 인스턴싱 (같은 메시 여러 개) =====
+// 인스턴스마다 model 행렬 + 색상 번호를 인스턴스 버퍼에 넣고 glDrawElementsInstanced로 그림
+// 매 프레임 CPU는 AABB 컬링으로 절두체 밖 인스턴스를 빼고 LOD별로 모아서 한 번 올림
+// → draw call 수 = LOD 단계 수 * 재질 구간 수 (인스턴스 수와 무관)
+
+int piggyInstanceCount = 0;          // --instances N (0이면 끔)
+const int MAX_INSTANCES = 100000;
+const int INSTANCE_PALETTE_SIZE = 8; // 셰이더 instancePalette 크기 (instanceShaderDefines로 셰이더에 넣음)
+const glm::vec3 INSTANCE_PALETTE[INSTANCE_PALETTE_SIZE] = {
+    glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(1.0f, 0.75f, 0.75f), glm::vec3(0.75f, 1.0f, 0.75f), glm::vec3(0.75f, 0.75f, 1.0f),
+    glm::vec3(1.0f, 1.0f, 0.7f), glm::vec3(0.7f, 1.0f, 1.0f), glm::vec3(1.0f, 0.7f, 1.0f), glm::vec3(0.85f, 0.85f, 0.85f)
+};
+
+// LoadShaders에 넘길 #define (셰이더 배열 크기가 C++ 상수와 어긋나지 않게)
+string instanceShaderDefines() {
+    return "#define INSTANCE_PALETTE_SIZE " + to_string(INSTANCE_PALETTE_SIZE) + "\n";
+}
+
+// 인스턴스 버퍼 한 칸 (location 2~5: model 열, location 6: 색상 번호)
+struct InstanceData {
+    glm::mat4 model;
+    unsigned int colorIndex;
+};
+
+// 월드 공간 바운딩 구 (LOD 선택용, CPU에만 둠)
+struct InstanceBounds {
+    glm::vec3 center;
+    float radius;
+};
+
+struct InstanceBatchStats {
+    size_t instances;
+    size_t visible;
+    size_t occluded;  // 절두체 안이지만 오클루전 컬링으로 빠진 수
+    size_t levelCounts[MAX_LOD_LEVELS];
+};
+
+vector<InstanceData> piggyInstances;
+vector<InstanceBounds> piggyInstanceBounds;
+AABBList piggyInstanceBoxes;                // 컬링용 월드 AABB
+vector<InstanceData> piggyVisibleInstances; // 매 프레임 LOD 순서로 다시 채움
+GLuint PiggyInstanceBuffer = 0;
+float sceneFarPlane = 100.0f;                // 인스턴스 격자가 있으면 격자 전체가 들어오게 늘림
+
+// 원점 칸(단독 PiggyBank 자리)을 비운 정사각 격자. 칸마다 임의 yaw / 크기 / 색상 (고정 seed)
+// 반환값: 원점에서 가장 먼 인스턴스 바운딩 구 끝까지의 거리
+float createInstanceGrid(int count, const glm::vec3& minBound, const glm::vec3& maxBound,
+                        vector<InstanceData>& instances, vector<InstanceBounds>& bounds, AABBList& boxes) {
+    instances.clear();
+    bounds.clear();
+    boxes.clear();
+    if (count <= 0) return 0.0f;
+
+    glm::vec3 center = (minBound + maxBound) * 0.5f;
+    float radius = glm::length(maxBound - minBound) * 0.5f;
+    float spacing = radius * 2.0f;
+    float extent = 0.0f;
+    int side = (int)ceil(sqrt((double)count + 1.0));
+    int half = side / 2;
+    uint32_t state = 12345u;
+    instances.reserve(count);
+    bounds.reserve(count);
+
+    for (int z = 0; z < side && (int)instances.size() < count; z++) {
+        for (int x = 0; x < side && (int)instances.size() < count; x++) {
+            if (x == half && z == half) continue;
+            state = state * 1664525u + 1013904223u;
+            float yaw = (state >> 8) * (360.0f / 16777216.0f);
+            state = state * 1664525u + 1013904223u;
+            float scale = 0.8f + (state >> 8) * (0.4f / 16777216.0f);
+            state = state * 1664525u + 1013904223u;
+
+            InstanceData instance;
+            instance.model = glm::translate(glm::mat4(1.0f), glm::vec3((x - half) * spacing, 0.0f, (z - half) * spacing));
+            instance.model = glm::rotate(instance.model, glm::radians(yaw), glm::vec3(0, 1, 0));
+            instance.model = glm::scale(instance.model, glm::vec3(scale));
+            instance.colorIndex = (state >> 8) % INSTANCE_PALETTE_SIZE;
+            instances.push_back(instance);
+
+            InstanceBounds sphere;
+            sphere.center = glm::vec3(instance.model * glm::vec4(center, 1.0f));
+            sphere.radius = radius * scale;
+            bounds.push_back(sphere);
+            boxes.addTransformed(instance.model, minBound, maxBound);
+            extent = max(extent, glm::length(sphere.center) + sphere.radius);
+        }
+    }
+    return extent;
+}
+
+// 절두체 안의 인스턴스를 LOD 순서로 visible에 채움. levelStarts[level] ~ levelStarts[level + 1]이 그 LOD의 인스턴스
+// LOD 화면 크기는 selectLOD와 같은 기준 (바운딩 크기 * 0.5 * viewport / NDC)
+// occlusion이 있으면 카메라에 가까운 인스턴스를 오클루더로 그려서 가려진 인스턴스도 뺌
+void gatherVisibleInstances(const vector<InstanceData>& instances, const vector<InstanceBounds>& bounds, const AABBList& boxes,
+                            const vector<MeshLOD>& lods, const CameraState& camera, int viewportPixels,
+                            vector<InstanceData>& visible, size_t levelStarts[MAX_LOD_LEVELS + 1], InstanceBatchStats* stats = nullptr,
+                            OcclusionCuller* occlusion = nullptr) {
+    vector<unsigned int> survivors;
+    cullAABBs(boxes, camera.ViewProjection, survivors);
+    const glm::vec3& cameraPosition = camera.position;
+
+    size_t frustumVisible = survivors.size();
+    if (occlusion && !occlusion->occluder.indices.empty() && !survivors.empty()) {
+        vector<pair<float, unsigned int> > byDistance(survivors.size());
+        for (size_t s = 0; s < survivors.size(); s++) {
+            glm::vec3 offset = bounds[survivors[s]].center - cameraPosition;
+            byDistance[s] = make_pair(glm::dot(offset, offset), survivors[s]);
+        }
+        size_t occluderCount = min(survivors.size(), (size_t)OCCLUSION_MAX_OCCLUDERS);
+        partial_sort(byDistance.begin(), byDistance.begin() + occluderCount, byDistance.end());
+        vector<glm::mat4> models(occluderCount);
+        for (size_t k = 0; k < occluderCount; k++) models[k] = instances[byDistance[k].second].model;
+
+        OcclusionStats& occlusionStats = occlusion->stats;
+        occlusionStats = OcclusionStats();
+        chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+        clearOcclusionBuffer(occlusion->buffer, camera.ViewProjection);
+        rasterizeOccluders(occlusion->buffer, occlusion->occluder, models, loaderThreadCount(), &occlusionStats);
+        occlusionStats.rasterSeconds = elapsedSeconds(start);
+        start = chrono::high_resolution_clock::now();
+        buildDepthPyramid(occlusion->buffer);
+        occlusionStats.pyramidSeconds = elapsedSeconds(start);
+        start = chrono::high_resolution_clock::now();
+        vector<unsigned int> unoccluded;
+        cullOccludedAABBs(occlusion->buffer, boxes, survivors, unoccluded, &occlusionStats);
+        occlusionStats.testSeconds = elapsedSeconds(start);
+        survivors.swap(unoccluded);
+    }
+    float pixelsPerUnit = camera.Projection[1][1] * 0.5f * viewportPixels; // 거리 1에서 길이 1이 차지하는 픽셀
+    int levelCount = lods.empty() ? 1 : (int)lods.size();
+
+    vector<unsigned char> levels(survivors.size());
+    size_t counts[MAX_LOD_LEVELS] = { 0 };
+    for (size_t s = 0; s < survivors.size(); s++) {
+        const InstanceBounds& sphere = bounds[survivors[s]];
+        int level = 0;
+        float distance = glm::length(sphere.center - cameraPosition);
+        if (levelCount > 1 && distance > sphere.radius)
+            level = selectLODForScreenSize(lods, 2.0f * sphere.radius * pixelsPerUnit / distance);
+        levels[s] = (unsigned char)level;
+        counts[level]++;
+    }
+
+    levelStarts[0] = 0;
+    for (int level = 0; level < MAX_LOD_LEVELS; level++) levelStarts[level + 1] = levelStarts[level] + (level < levelCount ? counts[level] : 0);
+    visible.resize(levelStarts[MAX_LOD_LEVELS]);
+    size_t cursor[MAX_LOD_LEVELS];
+    for (int level = 0; level < MAX_LOD_LEVELS; level++) cursor[level] = levelStarts[level];
+    for (size_t s = 0; s < survivors.size(); s++) visible[cursor[levels[s]]++] = instances[survivors[s]];
+
+    if (stats) {
+        stats->instances = instances.size();
+        stats->visible = visible.size();
+        stats->occluded = frustumVisible - survivors.size();
+        for (int level = 0; level < MAX_LOD_LEVELS; level++) stats->levelCounts[level] = counts[level];
+    }
+}
+
+// 현재 GL_ARRAY_BUFFER(인스턴스 버퍼)의 firstInstance부터 인스턴스 속성으로 연결 (divisor 1)
+void bindInstanceAttributes(size_t firstInstance) {
+    size_t base = firstInstance * sizeof(InstanceData);
+    for (int column = 0; column < 4; column++) {
+        glVertexAttribPointer(2 + column, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(base + column * sizeof(glm::vec4)));
+        glVertexAttribDivisor(2 + column, 1);
+        glEnableVertexAttribArray(2 + column);
+    }
+    glVertexAttribIPointer(6, 1, GL_UNSIGNED_INT, sizeof(InstanceData), (void*)(base + sizeof(glm::mat4)));
+    glVertexAttribDivisor(6, 1);
+    glEnableVertexAttribArray(6);
+}
+
+void unbindInstanceAttributes() {
+    for (int location = 2; location <= 6; location++) glDisableVertexAttribArray(location);
+}
+
+// ===== 통합 지오메트리 풀 + multi-draw-indirect =====
+// 정적 메시 전부를 정점 버퍼 하나 / 인덱스 버퍼 하나에 이어 붙임 (메시마다 baseVertex, firstIndex)
+// 매 프레임 보이는 구간을 DrawElementsIndirectCommand로 모아 glMultiDrawElementsIndirect 한 번으로 그림
+// draw마다 다른 값(MVP, 색상, 양자화 복원 값)은 gl_DrawIDARB로 읽는 SSBO에 있음
+// 텍스처는 draw 중간에 못 바꾸므로 텍스처가 다른 draw끼리는 호출을 나눔 (색상만 쓰는 draw는 아무 묶음에나 들어감)
+// 아틀라스 재질은 배열 텍스처가 unit 1에 계속 묶여 있고 레이어 / 영역이 draw 데이터에 있어서 색상만 쓰는 draw처럼 아무 묶음에나 들어감
+// --geometry-pool 로만 켜고, 켜도 GL 4.3 + ARB_shader_draw_parameters가 없으면 메시별 버퍼 + 렌더 큐 경로
+// (실제 GL 4.3 컨텍스트에서 아직 돌려 보지 못한 경로라 기본은 꺼 둠)
+
+bool useGeometryPool = false;   // --geometry-pool 로 켬
+bool geometryPoolReady = false; // 지원 확인 + 풀 셰이더 링크 성공
+GLuint poolProgramID = 0;
+
+// glMultiDrawElementsIndirect 명령 한 개 (GL 스펙의 배치 그대로)
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+// SSBO 한 칸 (std430, PoolVertexShader.txt의 DrawData와 같은 배치)
+struct PoolDrawData {
+    glm::mat4 MVP;               // 인스턴스 draw면 Projection * View
+    glm::vec4 color;             // rgb: 재질 색상, a: 텍스처 사용 (0: 없음, 1: textureSampler, 2: 아틀라스)
+    glm::vec4 positionScale;     // xyz: 양자화 복원, w: 인스턴스 draw (1 / 0)
+    glm::vec4 positionOffset;    // xyz: 양자화 복원, w: 아틀라스 레이어
+    glm::vec4 texcoordTransform; // xy: scale, zw: offset
+    glm::vec4 atlasRect;         // 아틀라스 안 영역 (xy: scale, zw: offset)
+};
+
+// 풀 안에서 메시 하나의 위치 (메시 인덱스는 로컬 번호 그대로, baseVertex로 보정)
+struct PoolMesh {
+    GLint baseVertex;
+    unsigned int firstIndex;
+    VertexLayout layout;
+
+    PoolMesh() : baseVertex(0), firstIndex(0) {}
+};
+
+struct GeometryPool {
+    GLuint vertexArray;    // 풀 전용 VAO (속성 포인터는 업로드 때 한 번만)
+    GLuint vertexBuffer;
+    GLuint indexBuffer;
+    GLuint commandBuffer;  // GL_DRAW_INDIRECT_BUFFER
+    GLuint drawDataBuffer; // SSBO binding 0
+    vector<unsigned char> vertexData; // uploadGeometryPool 전까지 CPU에 모음
+    vector<unsigned int> indices;
+    size_t vertexCount;
+
+    GeometryPool() : vertexArray(0), vertexBuffer(0), indexBuffer(0), commandBuffer(0), drawDataBuffer(0), vertexCount(0) {}
+};
+
+// 한 프레임에 모은 draw (텍스처 하나당 한 묶음 = glMultiDrawElementsIndirect 한 번)
+struct PoolDrawList {
+    GLuint texture; // 0이면 아직 색상만 쓰는 draw뿐
+    vector<DrawElementsIndirectCommand> commands;
+    vector<PoolDrawData> drawData;
+};
+
+GeometryPool geometryPool;
+PoolMesh cubePoolMesh;
+PoolMesh piggyPoolMesh;
+
+bool geometryPoolSupported() {
+#ifdef WINDOWS
+    return GLEW_VERSION_4_3 && GLEW_ARB_shader_draw_parameters;
+#else
+    return false; // macOS는 GL 4.1까지
+#endif
+}
+
+// 메시를 풀 뒤에 이어 붙임 (모든 메시가 meshVertexFormat 하나를 씀, 복원 값은 메시마다)
+void addMeshToPool(GeometryPool& pool, const char* name, const vector<float>& vertices, const vector<unsigned int>& indices, PoolMesh& mesh) {
+    vector<unsigned char> data;
+    QuantizationError error;
+    quantizeVertices(vertices, *meshVertexFormat, data, mesh.layout, &error);
+    printQuantization(name, vertices, data, mesh.layout, error);
+
+    mesh.baseVertex = (GLint)pool.vertexCount;
+    mesh.firstIndex = (unsigned int)pool.indices.size();
+    pool.vertexData.insert(pool.vertexData.end(), data.begin(), data.end());
+    pool.indices.insert(pool.indices.end(), indices.begin(), indices.end());
+    pool.vertexCount += vertices.size() / 5;
+}
+
+// 모은 정점/인덱스를 한 번에 올리고 CPU 사본은 버림
+void uploadGeometryPool(GeometryPool& pool) {
+    GLint previousArray = 0;
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousArray);
+    glGenVertexArrays(1, &pool.vertexArray);
+    glBindVertexArray(pool.vertexArray);
+
+    const VertexFormat& format = *meshVertexFormat;
+    glGenBuffers(1, &pool.vertexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, pool.vertexBuffer);
+    uploadStaticBuffer(GL_ARRAY_BUFFER, pool.vertexData.empty() ? nullptr : &pool.vertexData[0], pool.vertexData.size());
+    glVertexAttribPointer(0, format.position.size, format.position.type, format.position.normalized, format.stride, (void*)format.position.offset);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, format.texcoord.size, format.texcoord.type, format.texcoord.normalized, format.stride, (void*)format.texcoord.offset);
+    glEnableVertexAttribArray(1);
+
+    glGenBuffers(1, &pool.indexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, pool.indexBuffer);
+    uploadStaticBuffer(GL_ELEMENT_ARRAY_BUFFER, pool.indices.empty() ? nullptr : &pool.indices[0], pool.indices.size() * sizeof(unsigned int));
+    glGenBuffers(1, &pool.commandBuffer);
+    glGenBuffers(1, &pool.drawDataBuffer);
+    glBindVertexArray(previousArray);
+
+    printf("Geometry pool: %zu vertices (%.2f MB), %zu indices (%.2f MB)\n", pool.vertexCount, pool.vertexData.size() / (1024.0 * 1024.0),
+           pool.indices.size(), pool.indices.size() * sizeof(unsigned int) / (1024.0 * 1024.0));
+    vector<unsigned char>().swap(pool.vertexData);
+    vector<unsigned int>().swap(pool.indices);
+}
+
+void deleteGeometryPool(GeometryPool& pool) {
+    glDeleteBuffers(1, &pool.vertexBuffer);
+    glDeleteBuffers(1, &pool.indexBuffer);
+    glDeleteBuffers(1, &pool.commandBuffer);
+    glDeleteBuffers(1, &pool.drawDataBuffer);
+    glDeleteVertexArrays(1, &pool.vertexArray);
+    pool = GeometryPool();
+}
+
+// 이 텍스처로 그릴 수 있는 묶음 (색상만 쓰는 draw는 마지막 묶음에 붙임)
+static PoolDrawList& poolDrawListFor(vector<PoolDrawList>& lists, GLuint texture) {
+    if (texture == 0 && !lists.empty()) return lists.back();
+    for (size_t i = 0; i < lists.size(); i++) {
+        if (lists[i].texture == texture) return lists[i];
+        if (lists[i].texture == 0) {
+            lists[i].texture = texture;
+            return lists[i];
+        }
+    }
+    lists.push_back(PoolDrawList());
+    lists.back().texture = texture;
+    return lists.back();
+}
+
+// 재질 구간(또는 이어진 visible meshlet)마다 명령 하나를 기록
+// instanceCount > 0 이면 인스턴스 draw: 인스턴스 버퍼의 baseInstance번째부터 instanceCount개
+void appendPoolDraws(vector<PoolDrawList>& lists, const PoolMesh& mesh, const vector<SubMesh>& submeshes, GLuint fallbackTexture,
+                     const glm::mat4& MVP, const vector<Meshlet>* meshlets = nullptr, const vector<char>* visibleMeshlets = nullptr,
+                     GLuint instanceCount = 0, GLuint baseInstance = 0) {
+    for (size_t i = 0; i < submeshes.size(); i++) {
+        const SubMesh& submesh = submeshes[i];
+        GLuint texture = submesh.textureID != 0 ? submesh.textureID : fallbackTexture;
+        bool atlas = submesh.textureID != 0 && submesh.atlasLayer >= 0;
+        PoolDrawData data;
+        data.MVP = MVP;
+        data.color = texture != 0 ? glm::vec4(1.0f, 1.0f, 1.0f, atlas ? 2.0f : 1.0f) : glm::vec4(submesh.diffuse, 0.0f);
+        data.positionScale = glm::vec4(mesh.layout.positionScale, instanceCount > 0 ? 1.0f : 0.0f);
+        data.positionOffset = glm::vec4(mesh.layout.positionOffset, atlas ? (float)submesh.atlasLayer : 0.0f);
+        data.texcoordTransform = glm::vec4(mesh.layout.texcoordScale, mesh.layout.texcoordOffset);
+        data.atlasRect = submesh.atlasRect;
+        PoolDrawList& list = poolDrawListFor(lists, atlas ? 0 : texture);
+
+        DrawElementsIndirectCommand command;
+        command.instanceCount = instanceCount > 0 ? instanceCount : 1;
+        command.baseVertex = mesh.baseVertex;
+        command.baseInstance = baseInstance;
+        if (!visibleMeshlets || submesh.meshletCount == 0) {
+            command.count = submesh.indexCount;
+            command.firstIndex = mesh.firstIndex + submesh.firstIndex;
+            list.commands.push_back(command);
+            list.drawData.push_back(data);
+            continue;
+        }
+        for (unsigned int m = submesh.firstMeshlet; m < submesh.firstMeshlet + submesh.meshletCount; m++) {
+            if (!(*visibleMeshlets)[m]) continue;
+            unsigned int first = (*meshlets)[m].firstIndex, count = (*meshlets)[m].indexCount;
+            while (m + 1 < submesh.firstMeshlet + submesh.meshletCount && (*visibleMeshlets)[m + 1]) count += (*meshlets)[++m].indexCount;
+            command.count = count;
+            command.firstIndex = mesh.firstIndex + first;
+            list.commands.push_back(command);
+            list.drawData.push_back(data);
+        }
+    }
+}
+
+// 묶음마다 명령 버퍼 + SSBO를 올리고 glMultiDrawElementsIndirect 한 번. 반환값: GL draw 호출 수
+// instanceBuffer: 인스턴스 draw가 읽는 InstanceData 배열 (SSBO binding 1)
+int submitPoolDraws(const GeometryPool& pool, const vector<PoolDrawList>& lists, GLuint instanceBuffer) {
+    GLint previousArray = 0, previousProgram = 0;
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousArray);
+    glGetIntegerv(GL_CURRENT_PROGRAM, &previousProgram);
+    glUseProgram(poolProgramID);
+    glBindVertexArray(pool.vertexArray);
+    if (instanceBuffer != 0) glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, instanceBuffer);
+    if (textureAtlas.textureID != 0) {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, textureAtlas.textureID);
+    }
+
+    int calls = 0;
+    for (size_t i = 0; i < lists.size(); i++) {
+        const PoolDrawList& list = lists[i];
+        if (list.commands.empty()) continue;
+        if (list.texture != 0) {
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, list.texture);
+        }
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, pool.commandBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, list.commands.size() * sizeof(DrawElementsIndirectCommand), &list.commands[0], GL_STREAM_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, pool.drawDataBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, list.drawData.size() * sizeof(PoolDrawData), &list.drawData[0], GL_STREAM_DRAW);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, pool.drawDataBuffer);
+#ifdef WINDOWS
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, 0, (GLsizei)list.commands.size(), 0);
+#endif
+        calls++;
+    }
+
+    glBindVertexArray(previousArray);
+    glUseProgram(previousProgram);
+    return calls;
+}
+
+// ===== 렌더 큐 (64비트 정렬 키) =====
+// renderScene은 그릴 것을 바로 그리지 않고 명령으로 모은 다음, 키로 정렬해서 한 번에 제출
+// 키 (상위 비트부터): pass 2 | 프로그램 4 | 텍스처 16 | 깊이 24 (앞 -> 뒤) | 명령 번호 18
+// -> 같은 pass / 프로그램 / 텍스처끼리 붙고, 그 안에서는 가까운 것부터 (early-z)
+// 명령 번호가 키에 들어 있어서 키 배열만 정렬하면 되고, 키가 같으면 넣은 순서 유지
+// 제출할 때 직전 명령과 같은 상태(프로그램, 텍스처, 버퍼, polygon mode, uniform)는 다시 설정하지 않음
+// 아틀라스 재질은 텍스처 키가 모두 같아서 한데 모이고, 배열 텍스처는 제출 시작에 unit 1에 한 번만 묶음 (명령마다 레이어 / 영역 uniform만)
+// 정렬 전후 상태 변경 수 비교는 큐 전체를 한 번 더 훑으므로 --bench-sortkeys 또는 --render-stats 일 때만
+
+bool printRenderQueueStats = false; // --render-stats 로 켬 (매 프레임 정렬 전후 상태 변경 수 출력)
+
+enum RenderPass {
+    RENDER_PASS_OPAQUE = 0, // GL_FILL
+    RENDER_PASS_LINES = 1   // 좌표축, 바운딩 박스 (GL_LINE)
+};
+
+enum RenderProgram {
+    RENDER_PROGRAM_MAIN = 0, // programID
+    RENDER_PROGRAM_POOL = 1  // poolProgramID (지오메트리 풀 묶음 제출)
+};
+
+enum RenderCommandType {
+    RENDER_ELEMENTS, // glDrawElements(Instanced)
+    RENDER_ARRAYS,   // glDrawArrays
+    RENDER_STREAMED, // 스트리밍 메시 페이지 전부
+    RENDER_POOL      // 이번 프레임 풀 draw 묶음 (submitPoolDraws)
+};
+
+const int RENDER_KEY_INDEX_BITS = 18;
+const int RENDER_KEY_DEPTH_BITS = 24;
+const size_t RENDER_QUEUE_MAX_COMMANDS = (size_t)1 << RENDER_KEY_INDEX_BITS;
+
+struct RenderCommand {
+    RenderCommandType type;
+    RenderPass pass;
+    GLenum primitive;
+    GLuint vertexBuffer;
+    GLuint indexBuffer;
+    const VertexLayout* layout;
+    glm::mat4 MVP;
+    GLuint texture;   // 0이면 색상만
+    int atlasLayer;   // texture가 아틀라스면 레이어 (아니면 -1)
+    glm::vec4 atlasRect;
+    glm::vec3 color;
+    GLint first;      // 인덱스(ELEMENTS) 또는 정점(ARRAYS) 시작
+    GLsizei count;
+    GLuint instanceBuffer;   // instanceCount > 0 이면 여기서 firstInstance부터
+    GLsizei instanceCount;
+    size_t firstInstance;
+    const StreamedMesh* streamed;
+    const vector<PoolDrawList>* poolDraws;
+
+    RenderCommand() : type(RENDER_ELEMENTS), pass(RENDER_PASS_OPAQUE), primitive(GL_TRIANGLES), vertexBuffer(0), indexBuffer(0), layout(&FLOAT_VERTEX_LAYOUT),
+                      MVP(1.0f), texture(0), atlasLayer(-1), atlasRect(1.0f, 1.0f, 0.0f, 0.0f), color(1.0f), first(0), count(0), instanceBuffer(0), instanceCount(0), firstInstance(0),
+                      streamed(nullptr), poolDraws(nullptr) {}
+};
+
+struct RenderQueue {
+    vector<RenderCommand> commands;
+    vector<uint64_t> keys;
+    vector<uint64_t> scratch; // 기수 정렬 임시 버퍼
+
+    void clear() {
+        commands.clear();
+        keys.clear();
+    }
+};
+
+// 실제로 바뀐 상태 수 (같은 값이면 GL 호출을 건너뜀)
+struct RenderStateStats {
+    size_t commands;
+    size_t programChanges;
+    size_t polygonModeChanges;
+    size_t textureChanges;
+    size_t bufferChanges;  // 정점/인덱스 버퍼 + 속성 포인터
+    size_t uniformChanges; // MVP, 색상, useTexture, useInstancing, 아틀라스 레이어 / 영역
+
+    RenderStateStats() : commands(0), programChanges(0), polygonModeChanges(0), textureChanges(0), bufferChanges(0), uniformChanges(0) {}
+
+    size_t total() const { return programChanges + polygonModeChanges + textureChanges + bufferChanges + uniformChanges; }
+};
+
+// 주 셰이더 uniform 위치 (프레임마다 한 번 조회)
+struct RenderUniforms {
+    GLint MVP;
+    GLint materialColor;
+    GLint useTexture;
+    GLint textureSampler;
+    GLint useInstancing;
+    GLint instancePalette;
+    GLint useAtlas;
+    GLint atlasRect;
+    GLint atlasLayer;
+    VertexFormatUniforms format;
+};
+
+RenderUniforms getRenderUniforms(GLuint program) {
+    RenderUniforms uniforms;
+    uniforms.MVP = glGetUniformLocation(program, "MVP");
+    uniforms.materialColor = glGetUniformLocation(program, "materialColor");
+    uniforms.useTexture = glGetUniformLocation(program, "useTexture");
+    uniforms.textureSampler = glGetUniformLocation(program, "textureSampler");
+    uniforms.useInstancing = glGetUniformLocation(program, "useInstancing");
+    uniforms.instancePalette = glGetUniformLocation(program, "instancePalette");
+    uniforms.useAtlas = glGetUniformLocation(program, "useAtlas");
+    uniforms.atlasRect = glGetUniformLocation(program, "atlasRect");
+    uniforms.atlasLayer = glGetUniformLocation(program, "atlasLayer");
+    uniforms.format = getVertexFormatUniforms(program);
+    return uniforms;
+}
+
+RenderQueue sceneRenderQueue;
+
+// 물체 AABB 중심의 view 깊이를 0(near) ~ 1(farPlane)로 (키의 앞 -> 뒤 정렬용, 원근 투영의 clip w = view 깊이)
+float renderDepth(const glm::mat4& MVP, const glm::vec3& minBound, const glm::vec3& maxBound, float farPlane) {
+    glm::vec4 center = MVP * glm::vec4((minBound + maxBound) * 0.5f, 1.0f);
+    return center.w / farPlane;
+}
+
+// depth: 0(near) ~ 1(far). 텍스처 이름은 하위 16비트만 (겹쳐도 묶음 순서만 달라짐)
+uint64_t makeRenderKey(RenderPass pass, RenderProgram program, GLuint texture, float depth, size_t index) {
+    uint64_t depthBits = (uint64_t)(min(max(depth, 0.0f), 1.0f) * (float)((1u << RENDER_KEY_DEPTH_BITS) - 1));
+    return ((uint64_t)pass << 62) | ((uint64_t)program << 58) | ((uint64_t)(texture & 0xffff) << 42) |
+           (depthBits << RENDER_KEY_INDEX_BITS) | (uint64_t)index;
+}
+
+void pushRenderCommand(RenderQueue& queue, const RenderCommand& command, float depth) {
+    if (queue.commands.size() >= RENDER_QUEUE_MAX_COMMANDS) {
+        printf("Render queue full (%zu commands), draw dropped\n", queue.commands.size());
+        return;
+    }
+    RenderProgram program = command.type == RENDER_POOL ? RENDER_PROGRAM_POOL : RENDER_PROGRAM_MAIN;
+    queue.keys.push_back(makeRenderKey(command.pass, program, command.texture, depth, queue.commands.size()));
+    queue.commands.push_back(command);
+}
+
+// 재질 구간(또는 이어진 visible meshlet)마다 명령 하나. 텍스처가 있는 구간은 흰색 * 텍스처, 없는 구간은 Kd 색상
+// base: 버퍼, 레이아웃, MVP, 인스턴스 정보 (texture / color / first / count는 여기서 채움)
+void queueSubMeshes(RenderQueue& queue, const RenderCommand& base, const vector<SubMesh>& submeshes, GLuint fallbackTexture, float depth,
+                    const vector<Meshlet>* meshlets = nullptr, const vector<char>* visibleMeshlets = nullptr) {
+    RenderCommand command = base;
+    for (size_t i = 0; i < submeshes.size(); i++) {
+        const SubMesh& submesh = submeshes[i];
+        command.texture = submesh.textureID != 0 ? submesh.textureID : fallbackTexture;
+        command.atlasLayer = submesh.textureID != 0 ? submesh.atlasLayer : -1;
+        command.atlasRect = submesh.atlasRect;
+        command.color = command.texture != 0 ? glm::vec3(1.0f, 1.0f, 1.0f) : submesh.diffuse;
+        if (!visibleMeshlets || submesh.meshletCount == 0 || command.instanceCount > 0) {
+            command.first = (GLint)submesh.firstIndex;
+            command.count = (GLsizei)submesh.indexCount;
+            pushRenderCommand(queue, command, depth);
+            continue;
+        }
+        for (unsigned int m = submesh.firstMeshlet; m < submesh.firstMeshlet + submesh.meshletCount; m++) {
+            if (!(*visibleMeshlets)[m]) continue;
+            unsigned int first = (*meshlets)[m].firstIndex, count = (*meshlets)[m].indexCount;
+            while (m + 1 < submesh.firstMeshlet + submesh.meshletCount && (*visibleMeshlets)[m + 1]) count += (*meshlets)[++m].indexCount;
+            command.first = (GLint)first;
+            command.count = (GLsizei)count;
+            pushRenderCommand(queue, command, depth);
+        }
+    }
+}
+
+// 64비트 키 LSD 기수 정렬 (8비트씩 8번, 모든 키가 같은 바이트인 자리는 건너뜀)
+// 명령이 적으면 히스토그램 비용이 더 커서 std::sort (--bench-sortkeys에서 수천 개 근처가 분기점)
+const size_t RADIX_SORT_MIN_KEYS = 2048;
+
+void radixSortRenderKeys(vector<uint64_t>& keys, vector<uint64_t>& scratch) {
+    size_t count = keys.size();
+    if (count < RADIX_SORT_MIN_KEYS) {
+        sort(keys.begin(), keys.end());
+        return;
+    }
+    scratch.resize(count);
+
+    size_t histograms[8][256];
+    memset(histograms, 0, sizeof(histograms));
+    for (size_t i = 0; i < count; i++) {
+        uint64_t key = keys[i];
+        for (int digit = 0; digit < 8; digit++) histograms[digit][(key >> (digit * 8)) & 0xff]++;
+    }
+
+    uint64_t* source = &keys[0];
+    uint64_t* target = &scratch[0];
+    for (int digit = 0; digit < 8; digit++) {
+        size_t* histogram = histograms[digit];
+        if (histogram[(source[0] >> (digit * 8)) & 0xff] == count) continue;
+
+        size_t offset = 0;
+        for (int bucket = 0; bucket < 256; bucket++) {
+            size_t bucketCount = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += bucketCount;
+        }
+        for (size_t i = 0; i < count; i++) target[histogram[(source[i] >> (digit * 8)) & 0xff]++] = source[i];
+        swap(source, target);
+    }
+    if (source != &keys[0]) memcpy(&keys[0], source, count * sizeof(uint64_t));
+}
+
+static RenderProgram renderProgramOf(const RenderCommand& command) {
+    return command.type == RENDER_POOL ? RENDER_PROGRAM_POOL : RENDER_PROGRAM_MAIN;
+}
+
+// previous 다음에 command를 그릴 때 바뀌는 상태를 셈 (submitRenderQueue의 건너뛰기 규칙과 같음)
+// 풀 묶음은 자기 VAO / 텍스처를 쓰므로 그 다음 명령은 버퍼와 텍스처를 다시 설정
+static void countStateChanges(const RenderCommand* previous, const RenderCommand& command, RenderStateStats& stats) {
+    stats.commands++;
+    if (!previous || renderProgramOf(*previous) != renderProgramOf(command)) stats.programChanges++;
+    if (!previous || previous->pass != command.pass) stats.polygonModeChanges++;
+    if (command.type == RENDER_POOL) return;
+
+    bool afterPool = previous && previous->type == RENDER_POOL;
+    if (command.texture != 0 && command.atlasLayer < 0 && (!previous || afterPool || previous->texture != command.texture)) stats.textureChanges++;
+    if (command.type == RENDER_STREAMED) stats.bufferChanges += command.streamed->indexCounts.size();
+    else if (!previous || afterPool || previous->type == RENDER_STREAMED || previous->vertexBuffer != command.vertexBuffer || previous->layout != command.layout)
+        stats.bufferChanges++;
+
+    bool previousMain = previous && !afterPool;
+    if (!previousMain || memcmp(&previous->MVP, &command.MVP, sizeof(glm::mat4)) != 0) stats.uniformChanges++;
+    if (!previousMain || previous->color != command.color) stats.uniformChanges++;
+    if (!previousMain || (previous->texture != 0) != (command.texture != 0)) stats.uniformChanges++;
+    if (!previousMain || (previous->instanceCount > 0) != (command.instanceCount > 0)) stats.uniformChanges++;
+    if (!previousMain || (previous->atlasLayer >= 0) != (command.atlasLayer >= 0)) stats.uniformChanges++;
+    if (command.atlasLayer >= 0 && (!previousMain || previous->atlasLayer != command.atlasLayer || previous->atlasRect != command.atlasRect))
+        stats.uniformChanges++;
+}
+
+// 넣은 순서 그대로 그렸다면 바뀌었을 상태 수 (정렬로 줄어든 양 비교용)
+RenderStateStats countUnsortedStateChanges(const RenderQueue& queue) {
+    RenderStateStats stats;
+    for (size_t i = 0; i < queue.commands.size(); i++) countStateChanges(i > 0 ? &queue.commands[i - 1] : nullptr, queue.commands[i], stats);
+    return stats;
+}
+
+// 키 정렬 후 순서대로 제출, 바뀐 상태만 GL 호출. 끝나면 polygon mode는 GL_FILL로 되돌리고 큐를 비움
+RenderStateStats submitRenderQueue(RenderQueue& queue, const RenderUniforms& uniforms) {
+    RenderStateStats stats;
+    radixSortRenderKeys(queue.keys, queue.scratch);
+
+    const uint64_t indexMask = ((uint64_t)1 << RENDER_KEY_INDEX_BITS) - 1;
+    const RenderCommand* previous = nullptr;
+    bool instanceAttributesBound = false;
+    if (textureAtlas.textureID != 0) {
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, textureAtlas.textureID);
+    }
+    for (size_t k = 0; k < queue.keys.size(); k++) {
+        const RenderCommand& command = queue.commands[(size_t)(queue.keys[k] & indexMask)];
+        RenderStateStats before = stats;
+        countStateChanges(previous, command, stats);
+        bool afterPool = previous && previous->type == RENDER_POOL;
+        bool previousMain = previous && !afterPool;
+
+        if (stats.programChanges != before.programChanges && command.type != RENDER_POOL) glUseProgram(programID);
+        if (stats.polygonModeChanges != before.polygonModeChanges)
+            glPolygonMode(GL_FRONT_AND_BACK, command.pass == RENDER_PASS_LINES ? GL_LINE : GL_FILL);
+        if (command.type == RENDER_POOL) {
+            submitPoolDraws(geometryPool, *command.poolDraws, command.instanceBuffer); // 풀 프로그램 / VAO는 안에서 바꾸고 되돌림
+            previous = &command;
+            continue;
+        }
+
+        if (stats.textureChanges != before.textureChanges) {
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, command.texture);
+            glUniform1i(uniforms.textureSampler, 0);
+        }
+        if (!previousMain || memcmp(&previous->MVP, &command.MVP, sizeof(glm::mat4)) != 0) glUniformMatrix4fv(uniforms.MVP, 1, GL_FALSE, &command.MVP[0][0]);
+        if (!previousMain || previous->color != command.color) glUniform3fv(uniforms.materialColor, 1, &command.color[0]);
+        if (!previousMain || (previous->texture != 0) != (command.texture != 0)) glUniform1i(uniforms.useTexture, command.texture != 0 ? 1 : 0);
+        if (!previousMain || (previous->instanceCount > 0) != (command.instanceCount > 0)) {
+            glUniform1i(uniforms.useInstancing, command.instanceCount > 0 ? 1 : 0);
+            if (command.instanceCount > 0) glUniform3fv(uniforms.instancePalette, INSTANCE_PALETTE_SIZE, &INSTANCE_PALETTE[0][0]);
+        }
+        if (!previousMain || (previous->atlasLayer >= 0) != (command.atlasLayer >= 0)) glUniform1i(uniforms.useAtlas, command.atlasLayer >= 0 ? 1 : 0);
+        if (command.atlasLayer >= 0 && (!previousMain || previous->atlasLayer != command.atlasLayer || previous->atlasRect != command.atlasRect)) {
+            glUniform4fv(uniforms.atlasRect, 1, &command.atlasRect[0]);
+            glUniform1f(uniforms.atlasLayer, (float)command.atlasLayer);
+        }
+        if (instanceAttributesBound && command.instanceCount == 0) {
+            unbindInstanceAttributes();
+            instanceAttributesBound = false;
+        }
+
+        if (command.type == RENDER_STREAMED) {
+            drawStreamedMesh(*command.streamed, uniforms.format);
+            previous = &command;
+            continue;
+        }
+        if (stats.bufferChanges != before.bufferChanges) {
+            glBindBuffer(GL_ARRAY_BUFFER, command.vertexBuffer);
+            bindVertexLayout(*command.layout, uniforms.format);
+            if (command.type == RENDER_ELEMENTS) glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, command.indexBuffer);
+        }
+
+        if (command.type == RENDER_ARRAYS) {
+            glDrawArrays(command.primitive, command.first, command.count);
+        } else if (command.instanceCount > 0) {
+            glBindBuffer(GL_ARRAY_BUFFER, command.instanceBuffer);
+            bindInstanceAttributes(command.firstInstance);
+            instanceAttributesBound = true;
+            glDrawElementsInstanced(command.primitive, command.count, GL_UNSIGNED_INT, (void*)(command.first * sizeof(unsigned int)), command.instanceCount);
+        } else {
+            glDrawElements(command.primitive, command.count, GL_UNSIGNED_INT, (void*)(command.first * sizeof(unsigned int)));
+        }
+        previous = &command;
+    }
+
+    if (instanceAttributesBound) {
+        unbindInstanceAttributes();
+        glUniform1i(uniforms.useInstancing, 0);
+    }
+    if (previous && previous->pass != RENDER_PASS_OPAQUE) glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    queue.clear();
+    return stats;
+}
+
+// main에서 로드 직후 ~ glBufferData 전에 호출하는 최적화 단계
+void optimizeMesh(const char* name, vector<float>& vertices, vector<unsigned int>& indices, vector<SubMesh>& submeshes) {
+    if (!optimizeMeshes || indices.empty()) return;
+
+    size_t vertexCount = vertices.size() / 5;
+    VertexCacheStats before = measureVertexCache(indices, vertexCount);
+    VertexFetchStats fetchBefore = measureVertexFetch(indices, vertexCount);
+    optimizeVertexCache(indices, vertexCount, submeshes);
+    if (optimizeOverdrawEnabled) optimizeOverdraw(vertices, indices, submeshes);
+    bool remapped = optimizeVertexFetch(vertices, indices);
+    VertexCacheStats after = measureVertexCache(indices, vertexCount);
+    VertexFetchStats fetchAfter = measureVertexFetch(indices, vertexCount);
+    printf("%s vertex cache (FIFO %d): ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n",
+           name, VERTEX_CACHE_SIZE, before.acmr, after.acmr, before.atvr, after.atvr);
+    printf("%s vertex fetch: overfetch %.3f -> %.3f (first-use remap %s)\n", name, fetchBefore.overfetch, fetchAfter.overfetch,
+           remapped ? "applied" : "skipped, no gain");
+}
+
+// ===== OBJ 로더 벤치마크 =====
+// 실행: ACG_HW2.exe --bench-obj [face 수] [스레드 수]  (기본 10,000,000, 모든 코어)
+
+// 정사각 격자 사각형 face로 합성 OBJ 생성 (Blender처럼 %.6f)
+bool writeSyntheticOBJ(const char* path, long long faceCount) {
+    FILE* fp = fopen(path, "wb");
+    if (!fp) return false;
+
+    long long quadsPerRow = 1;
+    while (quadsPerRow * quadsPerRow < faceCount) quadsPerRow++;
+    long long rows = (faceCount + quadsPerRow - 1) / quadsPerRow;
+    long long columns = quadsPerRow + 1;
+
+    fprintf(fp, "# synthetic grid: %lld faces\n", faceCount);
+    for (long long y = 0; y <= rows; y++)
+        for (long long x = 0; x < columns; x++)
+            fprintf(fp, "v %.6f %.6f %.6f\n", (float)x * 0.01f, (float)((x * 7 + y * 13) % 100) * 0.001f, (float)y * 0.01f);
+    for (long long y = 0; y <= rows; y++)
+        for (long long x = 0; x < columns; x++)
+            fprintf(fp, "vt %.6f %.6f\n", (float)x / quadsPerRow, (float)y / rows);
+
+    long long written = 0;
+    for (long long y = 0; y < rows && written < faceCount; y++) {
+        for (long long x = 0; x < quadsPerRow && written < faceCount; x++, written++) {
+            long long a = y * columns + x + 1, b = a + 1, c = a + columns + 1, d = a + columns;
+            fprintf(fp, "f %lld/%lld %lld/%lld %lld/%lld %lld/%lld\n", a, a, b, b, c, c, d, d);
+        }
+    }
+    fclose(fp);
+    return true;
+}
+
+static long long fileSizeOf(const char* path) {
+    MappedFile file;
+    if (!mapFile(path, file)) return 0;
+    long long size = (long long)file.size;
+    unmapFile(file);
+    return size;
+}
+
+static bool sameMesh(const vector<float>& aVertices, const vector<unsigned int>& aIndices,
+                     const vector<float>& bVertices, const vector<unsigned int>& bIndices) {
+    return aIndices == bIndices && aVertices.size() == bVertices.size() &&
+           (aVertices.empty() || memcmp(&aVertices[0], &bVertices[0], aVertices.size() * sizeof(float)) == 0);
+}
+
+static void benchmarkOBJFile(const char* path, int threads) {
+    double megabytes = fileSizeOf(path) / (1024.0 * 1024.0);
+
+    vector<float> refVertices, fastVertices, parallelVertices, cachedVertices;
+    vector<unsigned int> refIndices, fastIndices, parallelIndices, cachedIndices;
+    glm::vec3 color;
+
+    // 파싱 속도만 재기 위해 캐시는 끄고 측정
+    bool cacheSetting = useMeshCache;
+    useMeshCache = false;
+
+    chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+    bool refOk = loadOBJ(path, refVertices, refIndices, color);
+    double refSeconds = elapsedSeconds(start);
+
+    start = chrono::high_resolution_clock::now();
+    bool fastOk = loadOBJFast(path, fastVertices, fastIndices, color);
+    double fastSeconds = elapsedSeconds(start);
+
+    start = chrono::high_resolution_clock::now();
+    bool parallelOk = loadOBJFast(path, parallelVertices, parallelIndices, color, nullptr, threads);
+    double parallelSeconds = elapsedSeconds(start);
+
+    // .meshbin 캐시: 한 번 써두고 읽기 시간 측정 (해시 검증 포함)
+    useMeshCache = true;
+    loadOBJFast(path, cachedVertices, cachedIndices, color, nullptr, threads);
+    start = chrono::high_resolution_clock::now();
+    bool cachedOk = loadMeshCache(path, cachedVertices, cachedIndices, color);
+    double cachedSeconds = elapsedSeconds(start);
+    remove(meshCachePath(path).c_str());
+    useMeshCache = cacheSetting;
+
+    bool fastIdentical = refOk && fastOk && sameMesh(refVertices, refIndices, fastVertices, fastIndices);
+    bool parallelIdentical = refOk && parallelOk && sameMesh(refVertices, refIndices, parallelVertices, parallelIndices);
+    bool cachedIdentical = refOk && cachedOk && sameMesh(refVertices, refIndices, cachedVertices, cachedIndices);
+
+    printf("\n[bench-obj] %s (%.2f MB)\n", path, megabytes);
+    printf("  iostream loadOBJ          : %8.3f s  %8.1f MB/s\n", refSeconds, megabytes / refSeconds);
+    printf("  mmap loadOBJFast          : %8.3f s  %8.1f MB/s  (x%.1f)\n", fastSeconds, megabytes / fastSeconds, refSeconds / fastSeconds);
+    printf("  mmap loadOBJFast %2d thread: %8.3f s  %8.1f MB/s  (x%.1f)\n", threads, parallelSeconds, megabytes / parallelSeconds, refSeconds / parallelSeconds);
+    printf("  .meshbin cache load       : %8.3f s  %8.1f MB/s  (x%.1f)\n", cachedSeconds, megabytes / cachedSeconds, refSeconds / cachedSeconds);
+    printf("  output identical          : %s / %s / %s\n\n", fastIdentical ? "yes" : "NO", parallelIdentical ? "yes" : "NO", cachedIdentical ? "yes" : "NO");
+}
+
+void runOBJBenchmark(long long syntheticFaces, int threads) {
+    benchmarkOBJFile("./PiggyBank.obj", threads);
+
+    const char* syntheticPath = "./synthetic_bench.obj";
+    printf("Writing synthetic OBJ (%lld faces)...\n", syntheticFaces);
+    if (!writeSyntheticOBJ(syntheticPath, syntheticFaces)) {
+        printf("Failed to write %s\n", syntheticPath);
+        return;
+    }
+    benchmarkOBJFile(syntheticPath, threads);
+    remove(syntheticPath);
+}
+
+// ===== 스트리밍 로더 벤치마크 =====
+// 실행: ACG_HW2.exe --bench-stream [face 수] [메모리 상한 MB]  (기본 10,000,000 / 256MB)
+
+struct StreamCounter {
+    size_t triangles;
+    size_t largestPageBytes;
+};
+
+static void countMeshPage(const MeshPage& page, void* userData) {
+    StreamCounter* counter = (StreamCounter*)userData;
+    counter->triangles += page.indexCount / 3;
+    counter->largestPageBytes = max(counter->largestPageBytes, page.vertexCount * 5 * sizeof(float) + page.indexCount * sizeof(unsigned int));
+}
+
+void runStreamBenchmark(long long faceCount, size_t budgetMB) {
+    const char* syntheticPath = "./synthetic_stream.obj";
+    printf("Writing synthetic OBJ (%lld faces)...\n", faceCount);
+    if (!writeSyntheticOBJ(syntheticPath, faceCount)) {
+        printf("Failed to write %s\n", syntheticPath);
+        return;
+    }
+    double megabytes = fileSizeOf(syntheticPath) / (1024.0 * 1024.0);
+
+    OBJStreamSettings settings;
+    settings.memoryBudget = budgetMB << 20;
+    OBJStreamStats stats;
+    StreamCounter counter = { 0, 0 };
+    glm::vec3 color;
+
+    chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+    bool ok = streamOBJ(syntheticPath, settings, countMeshPage, &counter, color, stats);
+    double seconds = elapsedSeconds(start);
+
+    // 전체를 메모리에 올리는 로더의 결과 크기 (비교용)
+    bool cacheSetting = useMeshCache;
+    useMeshCache = false;
+    vector<float> vertices;
+    vector<unsigned int> indices;
+    loadOBJFast(syntheticPath, vertices, indices, color);
+    useMeshCache = cacheSetting;
+    remove(syntheticPath);
+
+    printf("\n[bench-stream] %s (%.2f MB), budget %zu MB\n", syntheticPath, megabytes, budgetMB);
+    if (!ok) {
+        printf("  streaming failed (budget too small)\n\n");
+        return;
+    }
+    printf("  streamOBJ        : %8.3f s  %8.1f MB/s, %zu pages (largest %.1f MB)\n",
+           seconds, megabytes / seconds, stats.pageCount, counter.largestPageBytes / (1024.0 * 1024.0));
+    printf("  peak loader mem  : %8.1f MB  (in-memory result alone: %.1f MB)\n", stats.peakBytes / (1024.0 * 1024.0),
+           (vertices.size() * sizeof(float) + indices.size() * sizeof(unsigned int)) / (1024.0 * 1024.0));
+    printf("  triangles        : %zu streamed / %zu in-memory\n\n", counter.triangles, indices.size() / 3);
+}
+
+// ===== 정점 중복 제거 벤치마크 (std::map vs open addressing) =====
+// 실행: ACG_HW2.exe --bench-dedup [face 수]  (기본 10,000,000)
+
+// 파일 없이 격자 메시 OBJRawData를 바로 만듦 (writeSyntheticOBJ와 같은 배치)
+static void makeSyntheticRawGrid(long long faceCount, OBJRawData& raw) {
+    long long quadsPerRow = 1;
+    while (quadsPerRow * quadsPerRow < faceCount) quadsPerRow++;
+    long long rows = (faceCount + quadsPerRow - 1) / quadsPerRow;
+    long long columns = quadsPerRow + 1;
+
+    raw = OBJRawData();
+    raw.positions.reserve((size_t)((rows + 1) * columns));
+    raw.texcoords.reserve((size_t)((rows + 1) * columns));
+    for (long long y = 0; y <= rows; y++) {
+        for (long long x = 0; x < columns; x++) {
+            raw.positions.push_back(glm::vec3(x * 0.01f, 0.0f, y * 0.01f));
+            raw.texcoords.push_back(glm::vec2((float)x / quadsPerRow, (float)y / rows));
+        }
+    }
+
+    raw.corners.reserve((size_t)faceCount * 4);
+    raw.faceSizes.reserve((size_t)faceCount);
+    long long written = 0;
+    for (long long y = 0; y < rows && written < faceCount; y++) {
+        for (long long x = 0; x < quadsPerRow && written < faceCount; x++, written++) {
+            int a = (int)(y * columns + x + 1), b = a + 1, c = a + (int)columns + 1, d = a + (int)columns;
+            OBJCorner quad[4] = { { a, a }, { b, b }, { c, c }, { d, d } };
+            raw.corners.insert(raw.corners.end(), quad, quad + 4);
+            raw.faceSizes.push_back(4);
+        }
+    }
+}
+
+void runDedupBenchmark(long long faceCount) {
+    OBJRawData raw;
+    makeSyntheticRawGrid(faceCount, raw);
+    printf("\n[bench-dedup] %lld faces, %zu face corners\n", faceCount, raw.corners.size());
+
+    vector<float> mapVertices, hashVertices;
+    vector<unsigned int> mapIndices, hashIndices;
+    int faces = 0;
+
+    chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+    int mapUnique = buildIndexedMeshWith<MapDedupTable>(raw, mapVertices, mapIndices, faces);
+    double mapSeconds = elapsedSeconds(start);
+
+    start = chrono::high_resolution_clock::now();
+    int hashUnique = buildIndexedMeshWith<VertexDedupTable>(raw, hashVertices, hashIndices, faces);
+    double hashSeconds = elapsedSeconds(start);
+
+    double corners = (double)raw.corners.size();
+    printf("  std::map          : %8.3f s  %8.1f M corners/s  (%d unique)\n", mapSeconds, corners / mapSeconds * 1e-6, mapUnique);
+    printf("  VertexDedupTable  : %8.3f s  %8.1f M corners/s  (%d unique, x%.1f)\n", hashSeconds, corners / hashSeconds * 1e-6, hashUnique, mapSeconds / hashSeconds);
+    printf("  output identical  : %s\n\n", (mapVertices == hashVertices && mapIndices == hashIndices) ? "yes" : "NO");
+}
+
+// ===== 정점 캐시 / fetch 최적화 벤치마크 =====
+// 실행: ACG_HW2.exe --bench-vcache [face 수]  (기본 1,000,000)
+
+static void benchmarkVertexCache(const char* name, vector<float>& vertices, vector<unsigned int>& indices, vector<SubMesh>& submeshes) {
+    size_t vertexCount = vertices.size() / 5;
+    vector<unsigned int> fileOrder(indices);
+    VertexCacheStats before = measureVertexCache(indices, vertexCount);
+    chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+    optimizeVertexCache(indices, vertexCount, submeshes);
+    double seconds = elapsedSeconds(start);
+    VertexCacheStats after = measureVertexCache(indices, vertexCount);
+
+    printf("\n[bench-vcache] %s: %zu triangles, %zu vertices\n", name, indices.size() / 3, vertexCount);
+    printf("  ACMR (FIFO %d) : %6.3f -> %6.3f\n", VERTEX_CACHE_SIZE, before.acmr, after.acmr);
+    printf("  ATVR (FIFO %d) : %6.3f -> %6.3f\n", VERTEX_CACHE_SIZE, before.atvr, after.atvr);
+    printf("  Tipsify        : %8.3f s  %8.1f M triangles/s\n", seconds, indices.size() / 3 / seconds * 1e-6);
+
+    // 정점 fetch: 파일 순서 인덱스에 바로 적용한 경우와 Tipsify 뒤에 적용한 경우
+    vector<float> fileVertices(vertices);
+    vector<unsigned int> fileIndices(fileOrder);
+    VertexFetchStats fileFetch = measureVertexFetch(fileIndices, vertexCount);
+    remapVertexFetch(fileVertices, fileIndices);
+    VertexFetchStats fileRemapped = measureVertexFetch(fileIndices, vertexCount);
+
+    // Tipsify 뒤: 재배치 자체의 효과와, optimizeMesh처럼 줄어들 때만 적용했을 때
+    vector<float> tipsifyVertices(vertices);
+    vector<unsigned int> tipsifyIndices(indices);
+    VertexFetchStats tipsifyFetch = measureVertexFetch(indices, vertexCount);
+    remapVertexFetch(tipsifyVertices, tipsifyIndices);
+    VertexFetchStats tipsifyRemapped = measureVertexFetch(tipsifyIndices, vertexCount);
+    start = chrono::high_resolution_clock::now();
+    bool kept = optimizeVertexFetch(vertices, indices);
+    seconds = elapsedSeconds(start);
+
+    printf("  overfetch (16KB, 64B lines)\n");
+    printf("    file order   : %6.3f -> %6.3f  (%.1f -> %.1f MB)\n", fileFetch.overfetch, fileRemapped.overfetch,
+           fileFetch.bytesFetched / (1024.0 * 1024.0), fileRemapped.bytesFetched / (1024.0 * 1024.0));
+    printf("    Tipsify      : %6.3f -> %6.3f  (%.1f -> %.1f MB)\n", tipsifyFetch.overfetch, tipsifyRemapped.overfetch,
+           tipsifyFetch.bytesFetched / (1024.0 * 1024.0), tipsifyRemapped.bytesFetched / (1024.0 * 1024.0));
+    printf("  fetch remap    : %8.3f s (measure + remap), %s\n", seconds, kept ? "applied" : "skipped, no gain");
+}
+
+void runVertexCacheBenchmark(long long faceCount) {
+    bool cacheSetting = useMeshCache;
+    useMeshCache = false;
+    vector<float> vertices;
+    vector<unsigned int> indices;
+    vector<SubMesh> submeshes;
+    glm::vec3 color;
+    if (loadOBJFast("./PiggyBank.obj", vertices, indices, color, nullptr, 1, &submeshes))
+        benchmarkVertexCache("./PiggyBank.obj", vertices, indices, submeshes);
+    useMeshCache = cacheSetting;
+
+    OBJRawData raw;
+    makeSyntheticRawGrid(faceCount, raw);
+    int faces = 0;
+    submeshes.clear();
+    buildIndexedMesh(raw, vertices, indices, faces);
+    benchmarkVertexCache("synthetic grid", vertices, indices, submeshes);
+    printf("\n");
+}
+
+// ===== 오버드로 벤치마크 =====
+// 실행: ACG_HW2.exe --bench-overdraw [OBJ 경로] [방향 수]  (기본 PiggyBank.obj, 16방향)
+
+void runOverdrawBenchmark(const char* path, int viewCount) {
+    bool cacheSetting = useMeshCache;
+    useMeshCache = false;
+    vector<float> vertices;
+    vector<unsigned int> indices;
+    vector<SubMesh> submeshes;
+    glm::vec3 color;
+    bool ok = loadOBJFast(path, vertices, indices, color, nullptr, 1, &submeshes);
+    useMeshCache = cacheSetting;
+    if (!ok) return;
+
+    size_t vertexCount = vertices.size() / 5;
+    VertexCacheStats fileCache = measureVertexCache(indices, vertexCount);
+    OverdrawStats fileOverdraw = measureOverdraw(vertices, indices, true, viewCount);
+    OverdrawStats fileOverdrawNoCull = measureOverdraw(vertices, indices, false, viewCount);
+
+    optimizeVertexCache(indices, vertexCount, submeshes);
+    VertexCacheStats tipsifyCache = measureVertexCache(indices, vertexCount);
+    OverdrawStats tipsifyOverdraw = measureOverdraw(vertices, indices, true, viewCount);
+    OverdrawStats tipsifyOverdrawNoCull = measureOverdraw(vertices, indices, false, viewCount);
+
+    chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+    optimizeOverdraw(vertices, indices, submeshes);
+    double seconds = elapsedSeconds(start);
+    VertexCacheStats finalCache = measureVertexCache(indices, vertexCount);
+    OverdrawStats finalOverdraw = measureOverdraw(vertices, indices, true, viewCount);
+    OverdrawStats finalOverdrawNoCull = measureOverdraw(vertices, indices, false, viewCount);
+
+    printf("\n[bench-overdraw] %s: %zu triangles, %d views at 256x256\n", path, indices.size() / 3, viewCount);
+    printf("                       overdraw (cull / no cull)  ACMR\n");
+    printf("  file order         : %.3f / %.3f            %.3f\n", fileOverdraw.overdraw, fileOverdrawNoCull.overdraw, fileCache.acmr);
+    printf("  Tipsify            : %.3f / %.3f            %.3f\n", tipsifyOverdraw.overdraw, tipsifyOverdrawNoCull.overdraw, tipsifyCache.acmr);
+    printf("  Tipsify + clusters : %.3f / %.3f            %.3f  (%.3f s)\n\n", finalOverdraw.overdraw, finalOverdrawNoCull.overdraw, finalCache.acmr, seconds);
+}
+
+// ===== 정점 양자화 벤치마크 =====
+// 실행: ACG_HW2.exe --bench-quantize [face 수]  (기본 1,000,000)
+
+static void benchmarkQuantization(const char* name, const vector<float>& vertices) {
+    const VertexFormat* formats[3] = { &FLOAT_VERTEX_FORMAT, &SNORM16_VERTEX_FORMAT, &HALF_VERTEX_FORMAT };
+    printf("\n[bench-quantize] %s: %zu vertices\n", name, vertices.size() / 5);
+    for (int i = 0; i < 3; i++) {
+        vector<unsigned char> data;
+        VertexLayout layout;
+        QuantizationError error;
+        chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+        quantizeVertices(vertices, *formats[i], data, layout, &error);
+        double seconds = elapsedSeconds(start);
+        printf("  %-8s: %2d B/vertex %8.2f MB  position error %.3g (bound %.3g)  uv error %.3g (bound %.3g)  %.3f s\n",
+               formats[i]->name, (int)formats[i]->stride, data.size() / (1024.0 * 1024.0),
+               error.positionMax, error.positionBound, error.texcoordMax, error.texcoordBound, seconds);
+    }
+}
+
+void runQuantizationBenchmark(long long faceCount) {
+    bool cacheSetting = useMeshCache;
+    useMeshCache = false;
+    vector<float> vertices;
+    vector<unsigned int> indices;
+    glm::vec3 color;
+    if (loadOBJFast("./PiggyBank.obj", vertices, indices, color))
+        benchmarkQuantization("./PiggyBank.obj", vertices);
+    useMeshCache = cacheSetting;
+
+    OBJRawData raw;
+    makeSyntheticRawGrid(faceCount, raw);
+    int faces = 0;
+    buildIndexedMesh(raw, vertices, indices, faces);
+    benchmarkQuantization("synthetic grid", vertices);
+    printf("\n");
+}
+
+// ===== LOD 생성 벤치마크 =====
+// 실행: ACG_HW2.exe --bench-lod [OBJ 경로]  (기본 PiggyBank.obj)
+
+void runLODBenchmark(const char* path) {
+    bool cacheSetting = useMeshCache;
+    useMeshCache = false;
+    vector<float> vertices;
+    vector<unsigned int> indices;
+    vector<SubMesh> submeshes;
+    glm::vec3 color;
+    bool ok = loadOBJFast(path, vertices, indices, color, nullptr, 1, &submeshes);
+    useMeshCache = cacheSetting;
+    if (!ok) return;
+
+    vector<MeshLOD> lods;
+    chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+    buildMeshLODs(vertices, indices, submeshes, color, lods);
+    double seconds = elapsedSeconds(start);
+
+    printf("\n[bench-lod] %s: %zu vertices, %zu levels in %.3f s\n", path, vertices.size() / 5, lods.size(), seconds);
+    for (size_t i = 0; i < lods.size(); i++) {
+        // 이 LOD가 선택되기 시작하는 화면 크기 (바운딩 박스의 긴 변, 픽셀)
+        float maxPixels = lods[i].error > 0.0f ? LOD_PIXEL_ERROR / lods[i].error : 0.0f;
+        printf("  LOD %zu: %8zu triangles (%5.1f%%)  error %.5f", i, lods[i].triangleCount,
+               100.0 * lods[i].triangleCount / lods[0].triangleCount, lods[i].error);
+        if (i > 0) printf("  used below %.0f px", maxPixels);
+        printf("\n");
+    }
+    printf("\n");
+}
+
+// ===== Meshlet 컬링 벤치마크 =====
+// 실행: ACG_HW2.exe --bench-meshlet [OBJ 경로] [방향 수]  (기본 PiggyBank.obj, 64방향)
+
+void runMeshletBenchmark(const char* path, int viewCount) {
+    bool cacheSetting = useMeshCache;
+    useMeshCache = false;
+    vector<float> vertices;
+    vector<unsigned int> indices;
+    vector<SubMesh> submeshes;
+    glm::vec3 color;
+    bool ok = loadOBJFast(path, vertices, indices, color, nullptr, 1, &submeshes);
+    useMeshCache = cacheSetting;
+    if (!ok) return;
+
+    optimizeMesh(path, vertices, indices, submeshes);
+    vector<Meshlet> meshlets;
+    chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+    buildMeshlets(vertices, indices, submeshes, meshlets);
+    double buildSeconds = elapsedSeconds(start);
+
+    size_t coneEnabled = 0;
+    for (size_t m = 0; m < meshlets.size(); m++) coneEnabled += meshlets[m].coneCutoff <= 1.0f;
+
+    glm::vec3 minBound = vertexPosition(vertices, 0), maxBound = minBound;
+    for (size_t v = 1; v < vertices.size() / 5; v++) {
+        minBound = glm::min(minBound, vertexPosition(vertices, (unsigned int)v));
+        maxBound = glm::max(maxBound, vertexPosition(vertices, (unsigned int)v));
+    }
+    glm::vec3 center = (minBound + maxBound) * 0.5f;
+    float radius = glm::length(maxBound - minBound) * 0.5f;
+    glm::mat4 Projection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f * radius);
+
+    printf("\n[bench-meshlet] %s: %zu triangles, %zu meshlets (%.1f triangles each, %zu with cone) built in %.3f s, ACMR after meshlets %.3f\n",
+           path, indices.size() / 3, meshlets.size(), indices.size() / 3.0 / meshlets.size(), coneEnabled, buildSeconds,
+           measureVertexCache(indices, vertices.size() / 5).acmr);
+
+    // 전체가 보이는 거리와 메시에 붙어서 일부만 보이는 거리
+    float distances[2] = { 3.0f, 1.1f };
+    for (int d = 0; d < 2; d++) {
+        size_t frustumCulled = 0, coneCulled = 0, trianglesCulled = 0, triangles = 0, wronglyCulled = 0;
+        double cullSeconds = 0.0;
+        for (int view = 0; view < viewCount; view++) {
+            float z = 1.0f - 2.0f * (view + 0.5f) / viewCount;
+            float ring = sqrt(max(0.0f, 1.0f - z * z));
+            float phi = view * 2.39996323f;
+            glm::vec3 eye = center + glm::vec3(ring * cos(phi), ring * sin(phi), z) * (radius * distances[d]);
+            glm::vec3 up = fabs(z) < 0.99f ? glm::vec3(0, 0, 1) : glm::vec3(0, 1, 0);
+            glm::mat4 MVP = Projection * glm::lookAt(eye, center, up);
+
+            vector<char> visible;
+            MeshletCullStats stats;
+            start = chrono::high_resolution_clock::now();
+            cullMeshlets(meshlets, MVP, eye, visible, &stats);
+            cullSeconds += elapsedSeconds(start);
+            frustumCulled += stats.frustumCulled;
+            coneCulled += stats.coneCulled;
+            trianglesCulled += stats.trianglesCulled;
+            triangles += stats.triangles;
+
+            // 콘 컬링이 보수적인지 확인: 컬링된 meshlet 안에 카메라를 향한 삼각형이 있으면 안 됨
+            for (size_t m = 0; m < meshlets.size(); m++) {
+                if (visible[m]) continue;
+                for (unsigned int i = meshlets[m].firstIndex; i < meshlets[m].firstIndex + meshlets[m].indexCount; i += 3) {
+                    glm::vec3 a = vertexPosition(vertices, indices[i]), b = vertexPosition(vertices, indices[i + 1]), c = vertexPosition(vertices, indices[i + 2]);
+                    glm::vec4 clip[3] = { MVP * glm::vec4(a, 1.0f), MVP * glm::vec4(b, 1.0f), MVP * glm::vec4(c, 1.0f) };
+                    bool inside = false; // 세 정점 중 하나라도 절두체 안이면 보이는 삼각형
+                    for (int k = 0; k < 3; k++)
+                        inside = inside || (fabs(clip[k].x) <= clip[k].w && fabs(clip[k].y) <= clip[k].w && fabs(clip[k].z) <= clip[k].w);
+                    if (inside && glm::dot(glm::cross(b - a, c - a), eye - a) > 0.0f) wronglyCulled++;
+                }
+            }
+        }
+        printf("  distance %.1f x radius: %5.1f%% triangles skipped (%.1f frustum + %.1f cone meshlets per view), %.2f us per cull, %zu front faces wrongly culled\n",
+               distances[d], 100.0 * trianglesCulled / triangles, (double)frustumCulled / viewCount, (double)coneCulled / viewCount,
+               cullSeconds / viewCount * 1e6, wronglyCulled);
+    }
+    printf("\n");
+}
+
+// ===== AABB 절두체 컬링 벤치마크 =====
+// 카메라 주변에 흩어진 임의 박스를 커널별로 컬링해서 시간과 결과 일치 여부를 비교
+
+void runCullBenchmark(long long boxCount) {
+    AABBList boxes;
+    uint32_t state = 777u;
+    for (long long i = 0; i < boxCount; i++) {
+        float values[4];
+        for (int k = 0; k < 4; k++) {
+            state = state * 1664525u + 1013904223u;
+            values[k] = (state >> 8) / 16777216.0f;
+        }
+        glm::vec3 center = glm::vec3(values[0], values[1], values[2]) * 400.0f - glm::vec3(200.0f);
+        glm::vec3 extent(0.5f + values[3] * 4.0f);
+        boxes.add(center - extent, center + extent);
+    }
+
+    glm::mat4 Projection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 150.0f);
+    glm::mat4 View = glm::lookAt(glm::vec3(0.0f), glm::vec3(1.0f, -0.2f, 0.5f), glm::vec3(0, 1, 0));
+    glm::mat4 ViewProjection = Projection * View;
+
+    const char* names[3] = { "scalar", "SSE (4)", "AVX (8)" };
+    bool available[3] = { true, false, false };
+#ifdef CULL_SSE
+    available[CULL_KERNEL_SSE] = true;
+#endif
+#ifdef CULL_AVX
+    available[CULL_KERNEL_AVX] = true;
+#endif
+
+    printf("\n[bench-cull] %lld boxes (%.1f MB SoA)\n", boxCount, boxCount * 6 * sizeof(float) / (1024.0 * 1024.0));
+    vector<unsigned int> reference;
+    double scalarSeconds = 0.0;
+    for (int kernel = CULL_KERNEL_SCALAR; kernel <= CULL_KERNEL_AVX; kernel++) {
+        if (!available[kernel]) {
+            printf("  %-8s: not compiled in\n", names[kernel]);
+            continue;
+        }
+        vector<unsigned int> visible;
+        const int runs = 10;
+        cullAABBs(boxes, ViewProjection, visible, (CullKernel)kernel); // 워밍업
+        chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+        for (int run = 0; run < runs; run++) cullAABBs(boxes, ViewProjection, visible, (CullKernel)kernel);
+        double seconds = elapsedSeconds(start) / runs;
+        if (kernel == CULL_KERNEL_SCALAR) {
+            reference = visible;
+            scalarSeconds = seconds;
+        }
+        printf("  %-8s: %.3f ms, %zu visible (%.1f%%), %.2fx scalar, %s\n", names[kernel], seconds * 1e3, visible.size(),
+               100.0 * visible.size() / boxCount, scalarSeconds / seconds, visible == reference ? "same list" : "DIFFERENT list");
+    }
+    printf("\n");
+}
+
+// ===== 인스턴싱 벤치마크 =====
+// PiggyBank 격자에서 매 프레임 CPU 작업(컬링 + LOD 분류)과 draw call 수를 객체별 그리기와 비교
+
+void runInstancingBenchmark(const char* path, int instanceCount) {
+    bool cacheSetting = useMeshCache;
+    useMeshCache = false;
+    vector<float> vertices;
+    vector<unsigned int> indices;
+    vector<SubMesh> submeshes;
+    glm::vec3 color;
+    bool ok = loadOBJFast(path, vertices, indices, color, nullptr, 1, &submeshes);
+    useMeshCache = cacheSetting;
+    if (!ok) return;
+
+    optimizeMesh(path, vertices, indices, submeshes);
+    vector<MeshLOD> lods;
+    buildMeshLODs(vertices, indices, submeshes, color, lods);
+
+    glm::vec3 minBound = vertexPosition(vertices, 0), maxBound = minBound;
+    for (size_t v = 1; v < vertices.size() / 5; v++) {
+        minBound = glm::min(minBound, vertexPosition(vertices, (unsigned int)v));
+        maxBound = glm::max(maxBound, vertexPosition(vertices, (unsigned int)v));
+    }
+    vector<InstanceData> instances;
+    vector<InstanceBounds> bounds;
+    AABBList boxes;
+    float extent = createInstanceGrid(instanceCount, minBound, maxBound, instances, bounds, boxes);
+    float radius = glm::length(maxBound - minBound) * 0.5f;
+
+    // 앱 기본 카메라(renderScene과 같은 View / far plane)와 격자 모서리에서 낮게 가로질러 보는 카메라
+    CameraState cameras[2];
+    buildCameraState(cameras[0], max(100.0f, 2.0f * extent));
+    float gridHalf = extent * 0.7071f;
+    glm::mat4 groundView = glm::lookAt(glm::vec3(-gridHalf, radius * 2.0f, -gridHalf), glm::vec3(0.0f), glm::vec3(0, 1, 0));
+    setCameraMatrices(cameras[1], cameras[0].Projection, groundView, cameras[0].farPlane);
+    const char* viewNames[2] = { "default camera", "ground level  " };
+
+    printf("\n[bench-instances] %s: %zu instances, %zu LOD levels, %zu material ranges, instance data %zu bytes each\n",
+           path, instances.size(), lods.size(), submeshes.size(), sizeof(InstanceData));
+    const int frames = 20;
+    for (int v = 0; v < 2; v++) {
+        vector<InstanceData> visible;
+        size_t levelStarts[MAX_LOD_LEVELS + 1];
+        InstanceBatchStats stats;
+        chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+        for (int frame = 0; frame < frames; frame++)
+            gatherVisibleInstances(instances, bounds, boxes, lods, cameras[v], viewportHeight, visible, levelStarts, &stats);
+        double seconds = elapsedSeconds(start) / frames;
+
+        size_t instancedDraws = 0, trianglesLOD = 0;
+        for (size_t level = 0; level < lods.size(); level++) {
+            if (stats.levelCounts[level] == 0) continue;
+            instancedDraws += lods[level].submeshes.size();
+            trianglesLOD += stats.levelCounts[level] * lods[level].triangleCount;
+        }
+        printf("  %s: %zu visible, LOD %zu / %zu / %zu / %zu / %zu, %.3f ms cull + sort, %.2f MB uploaded\n",
+               viewNames[v], stats.visible, stats.levelCounts[0], stats.levelCounts[1], stats.levelCounts[2], stats.levelCounts[3], stats.levelCounts[4],
+               seconds * 1e3, stats.visible * sizeof(InstanceData) / (1024.0 * 1024.0));
+        printf("                  draw calls %zu (per object: %zu), %.1fM triangles (all LOD 0: %.1fM)\n",
+               instancedDraws, stats.visible * submeshes.size(), trianglesLOD / 1e6, stats.visible * lods[0].triangleCount / 1e6);
+    }
+    printf("\n");
+}
+
+// ===== mip 체인 / 텍스처 샘플링 벤치마크 =====
+// 텍스처를 17도 돌리고 축소(화면 픽셀당 텍셀 1~16개)해서 256x256 화면에 CPU로 샘플링
+// mip 없이 레벨 0 bilinear vs mip 체인 trilinear: 샘플링 시간, 텍스처 캐시(16KB 4-way, 64B 줄) 흉내로 읽은 바이트,
+// 픽셀 영역을 선형 공간에서 촘촘히 평균낸 기준 이미지 대비 PSNR (aliasing이 클수록 낮음)
+
+struct TextureCacheSim {
+    static const int SETS = 64, WAYS = 4, LINE = 64; // 16KB
+    uint64_t tags[SETS][WAYS];
+    uint64_t lastUse[SETS][WAYS];
+    uint64_t clock;
+    size_t misses;
+
+    TextureCacheSim() : clock(0), misses(0) {
+        memset(tags, 0xff, sizeof(tags));
+        memset(lastUse, 0, sizeof(lastUse));
+    }
+
+    void access(uint64_t address) {
+        uint64_t line = address / LINE;
+        int set = (int)(line % SETS), victim = 0;
+        clock++;
+        for (int way = 0; way < WAYS; way++) {
+            if (tags[set][way] == line) {
+                lastUse[set][way] = clock;
+                return;
+            }
+            if (lastUse[set][way] < lastUse[set][victim]) victim = way;
+        }
+        misses++;
+        tags[set][victim] = line;
+        lastUse[set][victim] = clock;
+    }
+};
+
+// GL처럼 텍셀 중심 기준, GL_REPEAT. 값은 8비트 그대로 0~1 (sRGB 디코드 없는 GL_RGB 텍스처와 같음)
+static void sampleBilinear(const TextureLevel& level, int channels, uint64_t levelOffset, float u, float v, float out[4], TextureCacheSim* cache) {
+    float tx = u * level.width - 0.5f, ty = v * level.height - 0.5f;
+    int x0 = (int)floorf(tx), y0 = (int)floorf(ty);
+    float fx = tx - x0, fy = ty - y0;
+    float weights[4] = { (1 - fx) * (1 - fy), fx * (1 - fy), (1 - fx) * fy, fx * fy };
+    for (int c = 0; c < 4; c++) out[c] = 0.0f;
+    for (int corner = 0; corner < 4; corner++) {
+        int x = ((x0 + (corner & 1)) % level.width + level.width) % level.width;
+        int y = ((y0 + (corner >> 1)) % level.height + level.height) % level.height;
+        size_t texel = ((size_t)y * level.width + x) * channels;
+        if (cache) cache->access(levelOffset + texel);
+        for (int c = 0; c < channels; c++) out[c] += weights[corner] * level.pixels[texel + c] * (1.0f / 255.0f);
+    }
+}
+
+static void sampleTrilinear(const TextureMipChain& chain, const vector<uint64_t>& offsets, float u, float v, float lod, float out[4], TextureCacheSim* cache) {
+    lod = min(max(lod, 0.0f), (float)(chain.levels.size() - 1));
+    int level = (int)lod;
+    float blend = lod - level;
+    sampleBilinear(chain.levels[level], chain.channels, offsets[level], u, v, out, cache);
+    if (blend <= 0.0f || level + 1 >= (int)chain.levels.size()) return;
+    float next[4];
+    sampleBilinear(chain.levels[level + 1], chain.channels, offsets[level + 1], u, v, next, cache);
+    for (int c = 0; c < 4; c++) out[c] += (next[c] - out[c]) * blend;
+}
+
+static double imagePSNR(const vector<unsigned char>& a, const vector<unsigned char>& b) {
+    double error = 0.0;
+    for (size_t i = 0; i < a.size(); i++) error += ((double)a[i] - b[i]) * ((double)a[i] - b[i]);
+    error /= a.size();
+    return error <= 0.0 ? 99.0 : 10.0 * log10(255.0 * 255.0 / error);
+}
+
+void runMipmapBenchmark(const char* path, int screenSize) {
+    int width, height, channels;
+    stbi_set_flip_vertically_on_load(false);
+    unsigned char* data = stbi_load(path, &width, &height, &channels, 0);
+    if (!data) {
+        printf("Failed to load texture: %s\n", path);
+        return;
+    }
+
+    printf("\n[bench-mipmap] %s: %dx%d, %d channels, screen %dx%d\n", path, width, height, channels, screenSize, screenSize);
+    TextureMipChain chain;
+    int threadCounts[2] = { 1, loaderThreadCount() };
+    for (int t = 0; t < (threadCounts[1] > 1 ? 2 : 1); t++) {
+        chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+        buildMipChain(data, width, height, channels, chain, threadCounts[t]);
+        printf("  mip chain build (%d thread%s): %.1f ms, %zu levels, %.2f MB (level 0 %.2f MB)\n", threadCounts[t], threadCounts[t] > 1 ? "s" : "",
+               elapsedSeconds(start) * 1e3, chain.levels.size(), chain.byteSize() / (1024.0 * 1024.0), chain.levels[0].pixels.size() / (1024.0 * 1024.0));
+    }
+    stbi_image_free(data);
+
+    vector<uint64_t> offsets(chain.levels.size());
+    for (size_t level = 1; level < chain.levels.size(); level++) offsets[level] = offsets[level - 1] + chain.levels[level - 1].pixels.size();
+
+    const float angle = glm::radians(17.0f);
+    const float cosAngle = cosf(angle), sinAngle = sinf(angle);
+    const int pixelCount = screenSize * screenSize;
+    printf("  texels/pixel | %-36s | %-36s\n", "level 0 bilinear", "mip chain trilinear");
+    printf("               | %8s %12s %12s | %8s %12s %12s\n", "ms", "MB fetched", "PSNR dB", "ms", "MB fetched", "PSNR dB");
+    for (int scale = 1; scale <= 16; scale *= 2) {
+        // 화면 픽셀 (px, py) 중심 -> 텍스처 UV (텍셀 단위로 scale배, 17도 회전)
+        auto pixelToUV = [&](float px, float py, float& u, float& v) {
+            float dx = (px - screenSize * 0.5f) * scale, dy = (py - screenSize * 0.5f) * scale;
+            u = (width * 0.5f + dx * cosAngle - dy * sinAngle) / width;
+            v = (height * 0.5f + dx * sinAngle + dy * cosAngle) / height;
+        };
+
+        // 기준: 픽셀 영역을 n x n 레벨 0 샘플로 선형 공간 평균
+        initSRGBTables();
+        int n = min(16, 2 * scale);
+        vector<unsigned char> reference(pixelCount * chain.channels);
+        for (int py = 0; py < screenSize; py++)
+            for (int px = 0; px < screenSize; px++) {
+                float sum[4] = { 0, 0, 0, 0 };
+                for (int sy = 0; sy < n; sy++)
+                    for (int sx = 0; sx < n; sx++) {
+                        float u, v, texel[4];
+                        pixelToUV(px + (sx + 0.5f) / n, py + (sy + 0.5f) / n, u, v);
+                        sampleBilinear(chain.levels[0], chain.channels, 0, u, v, texel, nullptr);
+                        for (int c = 0; c < chain.channels; c++)
+                            sum[c] += isAlphaChannel(c, chain.channels) ? texel[c] : srgbToLinearTable[(int)(texel[c] * 255.0f + 0.5f)];
+                    }
+                for (int c = 0; c < chain.channels; c++) sum[c] /= (float)(n * n);
+                encodeTextureRow(sum, 1, chain.channels, &reference[(py * screenSize + px) * chain.channels]);
+            }
+
+        double seconds[2], megabytes[2], psnr[2];
+        for (int mode = 0; mode < 2; mode++) {
+            vector<unsigned char> image(pixelCount * chain.channels);
+            TextureCacheSim cache;
+            float lod = mode == 0 ? 0.0f : log2f((float)scale);
+            // 8x8 타일 순서 (GPU 래스터 순서 흉내)
+            chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+            for (int tileY = 0; tileY < screenSize; tileY += 8)
+                for (int tileX = 0; tileX < screenSize; tileX += 8)
+                    for (int py = tileY; py < min(tileY + 8, screenSize); py++)
+                        for (int px = tileX; px < min(tileX + 8, screenSize); px++) {
+                            float u, v, texel[4];
+                            pixelToUV(px + 0.5f, py + 0.5f, u, v);
+                            if (mode == 0) sampleBilinear(chain.levels[0], chain.channels, 0, u, v, texel, &cache);
+                            else sampleTrilinear(chain, offsets, u, v, lod, texel, &cache);
+                            for (int c = 0; c < chain.channels; c++)
+                                image[(py * screenSize + px) * chain.channels + c] = (unsigned char)(min(max(texel[c], 0.0f), 1.0f) * 255.0f + 0.5f);
+                        }
+            seconds[mode] = elapsedSeconds(start);
+            megabytes[mode] = cache.misses * (double)TextureCacheSim::LINE / (1024.0 * 1024.0);
+            psnr[mode] = imagePSNR(image, reference);
+        }
+        printf("  %12d | %8.2f %12.2f %12.2f | %8.2f %12.2f %12.2f\n", scale, seconds[0] * 1e3, megabytes[0], psnr[0],
+               seconds[1] * 1e3, megabytes[1], psnr[1]);
+    }
+    printf("\n");
+}
+
+// ===== 블록 압축 벤치마크 =====
+// PNG의 mip 체인을 BC1 / BC3 / BC7로 압축: 인코딩 시간 (1 스레드 vs 전체), CPU 디코드 시간,
+// 크기 (원본 채널 / GPU가 실제로 쓰는 RGBA8 대비), 레벨 0과 체인 전체의 PSNR
+
+void runBlockCompressionBenchmark(const char* path) {
+    int width, height, channels;
+    stbi_set_flip_vertically_on_load(true);
+    unsigned char* data = stbi_load(path, &width, &height, &channels, 0);
+    if (!data) {
+        printf("Failed to load texture: %s\n", path);
+        return;
+    }
+
+    printf("\n[bench-bc] %s: %dx%d, %d channels\n", path, width, height, channels);
+    TextureMipChain chain;
+    buildMipChain(data, width, height, channels, chain, loaderThreadCount());
+    stbi_image_free(data);
+    size_t rgba8Bytes = 0;
+    for (size_t level = 0; level < chain.levels.size(); level++) rgba8Bytes += (size_t)chain.levels[level].width * chain.levels[level].height * 4;
+    printf("  mip chain: %zu levels, %.2f MB (%d channels), %.2f MB as RGBA8\n", chain.levels.size(), chain.byteSize() / (1024.0 * 1024.0),
+           channels, rgba8Bytes / (1024.0 * 1024.0));
+
+    int threadCounts[2] = { 1, loaderThreadCount() };
+    printf("  %-6s | %10s %10s | %9s | %8s %8s %8s | %10s %10s\n", "format", "enc 1T ms", "enc NT ms", "dec ms", "MB", "vs src", "vs RGBA8",
+           "PSNR L0", "PSNR all");
+    TextureCompression formats[3] = { TEXTURE_BC1, TEXTURE_BC3, TEXTURE_BC7 };
+    for (int f = 0; f < 3; f++) {
+        CompressedTexture texture;
+        double encodeSeconds[2] = { 0.0, 0.0 };
+        for (int t = 0; t < 2; t++) {
+            chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+            compressMipChain(chain, formats[f], texture, threadCounts[t]);
+            encodeSeconds[t] = elapsedSeconds(start);
+        }
+
+        // 체인 전체를 디코드해서 레벨 0과 전체(레벨을 이어 붙인 것)를 원본과 비교
+        vector<unsigned char> original, decoded;
+        double levelZeroPSNR = 0.0;
+        chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+        vector<TextureLevel> decodedLevels(texture.levels.size());
+        for (size_t level = 0; level < texture.levels.size(); level++)
+            decompressLevel(texture.levels[level], texture.format, channels, decodedLevels[level]);
+        double decodeSeconds = elapsedSeconds(start);
+        for (size_t level = 0; level < texture.levels.size(); level++) {
+            if (level == 0) levelZeroPSNR = imagePSNR(decodedLevels[0].pixels, chain.levels[0].pixels);
+            original.insert(original.end(), chain.levels[level].pixels.begin(), chain.levels[level].pixels.end());
+            decoded.insert(decoded.end(), decodedLevels[level].pixels.begin(), decodedLevels[level].pixels.end());
+        }
+
+        printf("  %-6s | %10.1f %10.1f | %9.1f | %8.2f %7.1fx %7.1fx | %10.2f %10.2f\n", TEXTURE_COMPRESSION_NAMES[formats[f]],
+               encodeSeconds[0] * 1e3, encodeSeconds[1] * 1e3, decodeSeconds * 1e3, texture.byteSize() / (1024.0 * 1024.0),
+               (double)chain.byteSize() / texture.byteSize(), (double)rgba8Bytes / texture.byteSize(), levelZeroPSNR, imagePSNR(decoded, original));
+    }
+    printf("  (enc NT = %d threads)\n\n", threadCounts[1]);
+}
+
+// ===== 텍스처 캐시 벤치마크 =====
+// 포맷별로 캐시를 지우고 decodeTexture (cold: PNG 디코드 + mip + 인코딩 + KTX2 저장) -> 다시 decodeTexture (warm: 매핑 + 검증)
+// warm은 매핑이 지연 로드라서 업로드가 읽는 것처럼 레벨 바이트를 한 번 다 읽은 시간도 같이
+
+void runTextureCacheBenchmark(const char* path) {
+    printf("\n[bench-texcache] %s\n", path);
+    int width, height, channels;
+    chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+    stbi_set_flip_vertically_on_load(true);
+    unsigned char* data = stbi_load(path, &width, &height, &channels, 0);
+    if (!data) {
+        printf("Failed to load texture: %s\n", path);
+        return;
+    }
+    stbi_image_free(data);
+    printf("  stb_image decode only: %.1f ms (%dx%d, %d channels)\n", elapsedSeconds(start) * 1e3, width, height, channels);
+
+    bool cacheSetting = useTextureCache;
+    useTextureCache = true;
+    TextureCompression formats[3] = { TEXTURE_UNCOMPRESSED, TEXTURE_BC1, TEXTURE_BC7 };
+    double cold[3], warm[3], warmRead[3];
+    size_t fileBytes[3];
+    for (int f = 0; f < 3; f++) {
+        string cachePath = textureCachePath(path, formats[f]);
+        remove(cachePath.c_str());
+        {
+            DecodedTexture texture;
+            start = chrono::high_resolution_clock::now();
+            decodeTexture(path, formats[f], texture);
+            cold[f] = elapsedSeconds(start);
+        }
+        DecodedTexture texture;
+        start = chrono::high_resolution_clock::now();
+        bool hit = decodeTexture(path, formats[f], texture) && texture.mapping;
+        warm[f] = elapsedSeconds(start);
+        uint64_t checksum = 0;
+        fileBytes[f] = 0;
+        for (size_t level = 0; level < texture.levels.size(); level++) {
+            checksum += hashBytes((const char*)texture.levels[level].data, texture.levels[level].size);
+            fileBytes[f] += texture.levels[level].size;
+        }
+        warmRead[f] = elapsedSeconds(start);
+        if (!hit) printf("  %s: warm load did not hit the cache\n", TEXTURE_COMPRESSION_NAMES[formats[f]]);
+        if (checksum == 1) printf("\n"); // 읽기가 최적화로 빠지지 않게
+    }
+    useTextureCache = cacheSetting;
+
+    printf("\n  %-6s | %10s | %10s %14s | %9s\n", "format", "cold ms", "warm ms", "warm+read ms", "level MB");
+    for (int f = 0; f < 3; f++)
+        printf("  %-6s | %10.1f | %10.2f %14.2f | %9.2f\n", TEXTURE_COMPRESSION_NAMES[formats[f]], cold[f] * 1e3, warm[f] * 1e3, warmRead[f] * 1e3,
+               fileBytes[f] / (1024.0 * 1024.0));
+    printf("\n");
+}
+
+// ===== 텍스처 아틀라스 벤치마크 =====
+// 합성 재질 N개(기본 64): 텍스처 크기는 32~1024의 2의 거듭제곱, 4개 중 1개는 가로 세로가 다름
+// 레이어 크기별 채우기 결과(레이어 수, 사용률), 고른 크기로 mip 체인 + 자리 채우기 시간,
+// 영역 경계(반복 이음새)를 넘나드는 UV에서 아틀라스 bilinear와 원본 wrap bilinear의 최대 차이 (여백이 맞으면 레벨마다 0),
+// 재질마다 draw 하나인 장면을 정렬 제출할 때 텍스처 바인딩 / uniform 변경 수, 풀 multi-draw 묶음 수 (재질마다 텍스처 vs 아틀라스)
+
+// 배열 텍스처 레이어 하나(RGBA8)를 GL_REPEAT bilinear로
+static void sampleAtlasBilinear(const unsigned char* layer, int size, float u, float v, float out[4]) {
+    float tx = u * size - 0.5f, ty = v * size - 0.5f;
+    int x0 = (int)floorf(tx), y0 = (int)floorf(ty);
+    float fx = tx - x0, fy = ty - y0;
+    float weights[4] = { (1 - fx) * (1 - fy), fx * (1 - fy), (1 - fx) * fy, fx * fy };
+    for (int c = 0; c < 4; c++) out[c] = 0.0f;
+    for (int corner = 0; corner < 4; corner++) {
+        int x = ((x0 + (corner & 1)) % size + size) % size;
+        int y = ((y0 + (corner >> 1)) % size + size) % size;
+        const unsigned char* texel = layer + ((size_t)y * size + x) * 4;
+        for (int c = 0; c < 4; c++) out[c] += weights[corner] * texel[c] * (1.0f / 255.0f);
+    }
+}
+
+void runAtlasBenchmark(int textureCount) {
+    unsigned int seed = 12345;
+    vector<AtlasEntry> entries(textureCount);
+    for (int i = 0; i < textureCount; i++) {
+        seed = seed * 1103515245u + 12345u;
+        entries[i].width = 32 << ((seed >> 16) % 6);
+        entries[i].height = (seed >> 8) % 4 == 0 ? 32 << ((seed >> 20) % 6) : entries[i].width;
+        entries[i].path = "synthetic";
+    }
+
+    printf("\n[bench-atlas] %d textures (32 ~ 1024 texels per side)\n", textureCount);
+    printf("  %-10s | %6s | %6s | %6s\n", "layer size", "layers", "placed", "used");
+    for (int size = ATLAS_MIN_LAYER_SIZE; size <= ATLAS_MAX_LAYER_SIZE; size *= 2) {
+        vector<AtlasEntry> trial = entries;
+        int layers = packTextureAtlas(trial, size), placed = 0;
+        uint64_t texels = 0;
+        for (size_t i = 0; i < trial.size(); i++) {
+            if (trial[i].layer < 0) continue;
+            placed++;
+            texels += (uint64_t)trial[i].width * trial[i].height;
+        }
+        printf("  %10d | %6d | %6d | %5.1f%%\n", size, layers, placed, layers > 0 ? 100.0 * texels / ((double)layers * size * size) : 0.0);
+    }
+
+    chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+    int layers;
+    int layerSize = packTextureAtlasBestSize(entries, layers);
+    double packSeconds = elapsedSeconds(start);
+    int levels = atlasLevelCount(entries);
+    printf("  chosen: %dx%d, %d layer(s), %d levels, packed in %.3f ms\n", layerSize, layerSize, layers, levels, packSeconds * 1e3);
+
+    // 합성 텍스처: 3 / 4채널을 섞고 텍셀 값은 위치 해시 (이웃 영역이나 엉뚱한 가장자리를 읽으면 바로 차이가 남)
+    vector<TextureMipChain> chains(textureCount);
+    start = chrono::high_resolution_clock::now();
+    for (int i = 0; i < textureCount; i++) {
+        if (entries[i].layer < 0) continue;
+        int channels = i % 2 == 0 ? 3 : 4;
+        vector<unsigned char> pixels((size_t)entries[i].width * entries[i].height * channels);
+        for (size_t t = 0; t < pixels.size(); t++) pixels[t] = (unsigned char)(((t + i * 7919u) * 2654435761u) >> 24);
+        buildMipChain(&pixels[0], entries[i].width, entries[i].height, channels, chains[i], loaderThreadCount());
+    }
+    double mipSeconds = elapsedSeconds(start);
+
+    vector<vector<unsigned char>> levelPixels(levels);
+    size_t bytes = 0;
+    for (int level = 0; level < levels; level++) {
+        levelPixels[level].assign((size_t)layers * (layerSize >> level) * (layerSize >> level) * 4, 0);
+        bytes += levelPixels[level].size();
+    }
+    start = chrono::high_resolution_clock::now();
+    for (int i = 0; i < textureCount; i++) {
+        if (entries[i].layer < 0) continue;
+        for (int level = 0; level < levels; level++) {
+            const TextureLevel& mip = chains[i].levels[level];
+            TextureLevelData source = { mip.width, mip.height, &mip.pixels[0], mip.pixels.size() };
+            writeAtlasEntryLevel(entries[i], level, source, chains[i].channels, &levelPixels[level][0], layerSize >> level);
+        }
+    }
+    double composeSeconds = elapsedSeconds(start);
+    printf("  mip chains: %.1f ms, compose into layers: %.1f ms, %.2f MB (RGBA8, %d levels)\n", mipSeconds * 1e3, composeSeconds * 1e3,
+           bytes / (1024.0 * 1024.0), levels);
+
+    // 영역마다 네 변을 넘나드는 UV (레벨 텍셀 ±2개 범위)에서 셰이더와 같은 방식(fract -> 영역)으로 샘플링
+    printf("  max |atlas - wrapped source| at region edges (8-bit):");
+    for (int level = 0; level < levels; level++) {
+        float maxError = 0.0f;
+        int levelSize = layerSize >> level;
+        for (int i = 0; i < textureCount; i++) {
+            if (entries[i].layer < 0) continue;
+            const TextureLevel& mip = chains[i].levels[level];
+            const unsigned char* layer = &levelPixels[level][(size_t)entries[i].layer * levelSize * levelSize * 4];
+            const glm::vec4& rect = entries[i].rect;
+            for (int k = -8; k <= 8; k++) {
+                for (int j = 0; j < 8; j++) {
+                    float across[2] = { k / (4.0f * mip.width), k / (4.0f * mip.height) }, along = (j + 0.5f) / 8.0f;
+                    for (int axis = 0; axis < 2; axis++) {
+                        float u = axis == 0 ? across[0] : along, v = axis == 0 ? along : across[1];
+                        u -= floorf(u);
+                        v -= floorf(v);
+                        float expected[4], actual[4];
+                        sampleBilinear(mip, chains[i].channels, 0, u, v, expected, nullptr);
+                        sampleAtlasBilinear(layer, levelSize, u * rect.x + rect.z, v * rect.y + rect.w, actual);
+                        for (int c = 0; c < chains[i].channels; c++) maxError = max(maxError, fabsf(expected[c] - actual[c]) * 255.0f);
                     }
-                    
-                    current_vertex_index++;
                 }
-                
-                face_vertex_indices.push_back(vertex_map[vertex_key]);
             }
-            
-            // 삼각형 생성
-            if (face_vertex_indices.size() >= 3) {
-                if (face_vertex_indices.size() == 3) {
-                    temp_indices.push_back(face_vertex_indices[0]);
-                    temp_indices.push_back(face_vertex_indices[1]);
-                    temp_indices.push_back(face_vertex_indices[2]);
-                    face_count++;
-                }
-                else if (face_vertex_indices.size() == 4) {
-                    // 두 개의 삼각형으로 분할해서 저장
-                    temp_indices.push_back(face_vertex_indices[0]);
-                    temp_indices.push_back(face_vertex_indices[1]);
-                    temp_indices.push_back(face_vertex_indices[2]);
-                    
-                    temp_indices.push_back(face_vertex_indices[0]);
-                    temp_indices.push_back(face_vertex_indices[2]);
-                    temp_indices.push_back(face_vertex_indices[3]);
-                    face_count += 2;
-                }
-                else {
-                    // [클로드 도움: 다각형을 삼각형으로 분할하는 방법 (fan triangulation)]
-                    for (size_t i = 1; i < face_vertex_indices.size() - 1; i++) {
-                        temp_indices.push_back(face_vertex_indices[0]);
-                        temp_indices.push_back(face_vertex_indices[i]);
-                        temp_indices.push_back(face_vertex_indices[i + 1]);
-                        face_count++;
-                    }
-                }
+        }
+        printf(" L%d %.2f", level, maxError);
+    }
+    printf("\n");
+
+    // 재질마다 draw 하나 (정점 버퍼 하나를 나눠 씀), 임의 깊이. 따로: 텍스처 이름 1..N / 아틀라스: 이름 하나 + 레이어 / 영역
+    const GLuint atlasTexture = (GLuint)textureCount + 1;
+    RenderQueue queues[2];
+    vector<SubMesh> submeshes[2];
+    for (int i = 0; i < textureCount; i++) {
+        seed = seed * 1103515245u + 12345u;
+        float depth = (float)((seed >> 8) & 0xffff) / 65535.0f;
+        for (int mode = 0; mode < 2; mode++) {
+            SubMesh submesh;
+            submesh.firstIndex = i * 300;
+            submesh.indexCount = 300;
+            submesh.textureID = (GLuint)i + 1;
+            if (mode == 1 && entries[i].layer >= 0) {
+                submesh.textureID = atlasTexture;
+                submesh.atlasLayer = entries[i].layer;
+                submesh.atlasRect = entries[i].rect;
             }
+            submeshes[mode].push_back(submesh);
+            RenderCommand command;
+            command.vertexBuffer = 1;
+            queueSubMeshes(queues[mode], command, vector<SubMesh>(1, submesh), 0, depth);
         }
     }
-    
-    file.close();
-    
-    // 바운딩 박스 계산
-    if (centerOffset != nullptr && !temp_vertices.empty()) {
-        glm::vec3 minBound = temp_vertices[0];
-        glm::vec3 maxBound = temp_vertices[0];
-        
-        for (const auto& vertex : temp_vertices) {
-            minBound.x = min(minBound.x, vertex.x);
-            minBound.y = min(minBound.y, vertex.y);
-            minBound.z = min(minBound.z, vertex.z);
-            maxBound.x = max(maxBound.x, vertex.x);
-            maxBound.y = max(maxBound.y, vertex.y);
-            maxBound.z = max(maxBound.z, vertex.z);
+    const char* names[2] = { "per-material textures", "texture atlas" };
+    printf("  %-22s | %13s %15s | %12s\n", "", "texture binds", "uniform changes", "pool batches");
+    for (int mode = 0; mode < 2; mode++) {
+        RenderQueue& queue = queues[mode];
+        radixSortRenderKeys(queue.keys, queue.scratch);
+        RenderStateStats stats;
+        const uint64_t indexMask = ((uint64_t)1 << RENDER_KEY_INDEX_BITS) - 1;
+        for (size_t k = 0; k < queue.keys.size(); k++)
+            countStateChanges(k > 0 ? &queue.commands[(size_t)(queue.keys[k - 1] & indexMask)] : nullptr, queue.commands[(size_t)(queue.keys[k] & indexMask)], stats);
+        vector<PoolDrawList> lists;
+        appendPoolDraws(lists, PoolMesh(), submeshes[mode], 0, glm::mat4(1.0f));
+        printf("  %-22s | %13zu %15zu | %12zu\n", names[mode], stats.textureChanges + (mode == 1 ? 1 : 0), stats.uniformChanges, lists.size());
+    }
+    printf("  (atlas binds: the array texture once per frame on unit 1)\n\n");
+}
+
+// ===== 배치 변환 벤치마크 =====
+// 임의 회전 / 위치의 물체 count개에 대해 model + MVP 계산 속도 (초당 물체 수)
+// 물체마다 glm::translate + glm::rotate 두 번 + 곱 vs 배치 스칼라 / SSE / SSE + 스레드, glm 결과와 최대 차이
+
+void runTransformBenchmark(size_t count, int threads) {
+    TransformBatch batch;
+    unsigned int seed = 7;
+    for (size_t i = 0; i < count; i++) {
+        float values[5];
+        for (int k = 0; k < 5; k++) {
+            seed = seed * 1103515245u + 12345u;
+            values[k] = (float)((seed >> 8) & 0xffff) / 65535.0f;
         }
-        
-        *centerOffset = (minBound + maxBound) * 0.5f;
-        printf("Bounding box: min(%.3f, %.3f, %.3f), max(%.3f, %.3f, %.3f)\n", 
-               minBound.x, minBound.y, minBound.z, maxBound.x, maxBound.y, maxBound.z);
-        printf("Center offset: (%.3f, %.3f, %.3f)\n", 
-               centerOffset->x, centerOffset->y, centerOffset->z);
+        batch.add(values[0] * 720.0f - 360.0f, values[1] * 720.0f - 360.0f, glm::vec3(values[2], values[3], values[4]) * 200.0f - glm::vec3(100.0f));
     }
-    
-    // 결과 저장
-    vertices = final_vertices;
-    indices = temp_indices;
-    
-    printf("OBJ file loaded: %d unique vertices (pos+tex), %d triangles, %zu indices\n", 
-           current_vertex_index, face_count, indices.size());
-    
-    return true;
+    CameraState camera;
+    buildCameraState(camera, 300.0f);
+    const int rounds = 20;
+
+    // 기준: 물체마다 glm 체인 (renderScene의 예전 방식)
+    vector<glm::mat4> referenceMVP(count);
+    chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+    for (int round = 0; round < rounds; round++) {
+        for (size_t i = 0; i < count; i++) {
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(batch.positionX[i], batch.positionY[i], batch.positionZ[i]));
+            model = glm::rotate(model, glm::radians(batch.rotationX[i]), glm::vec3(1, 0, 0));
+            model = glm::rotate(model, glm::radians(batch.rotationY[i]), glm::vec3(0, 1, 0));
+            referenceMVP[i] = camera.ViewProjection * model;
+        }
+    }
+    double glmSeconds = elapsedSeconds(start) / rounds;
+
+    printf("\n[bench-transforms] %zu objects (model + MVP each)\n", count);
+    printf("  glm per object      : %8.3f ms  %7.1f M objects/s\n", glmSeconds * 1e3, count / glmSeconds / 1e6);
+
+    struct Variant { const char* name; TransformKernel kernel; int threads; };
+    Variant variants[3] = { { "batch scalar        ", TRANSFORM_KERNEL_SCALAR, 1 }, { "batch SSE           ", TRANSFORM_KERNEL_SSE, 1 },
+                            { "batch SSE + threads ", TRANSFORM_KERNEL_SSE, threads } };
+    for (int v = 0; v < 3; v++) {
+        fill(batch.MVP.begin(), batch.MVP.end(), glm::mat4(0.0f));
+        start = chrono::high_resolution_clock::now();
+        for (int round = 0; round < rounds; round++) {
+            batch.markAllDirty();
+            updateTransformBatch(batch, camera, variants[v].threads, variants[v].kernel);
+        }
+        double seconds = elapsedSeconds(start) / rounds;
+
+        float maxError = 0.0f, maxValue = 0.0f;
+        for (size_t i = 0; i < count; i++)
+            for (int c = 0; c < 4; c++)
+                for (int r = 0; r < 4; r++) {
+                    maxError = max(maxError, fabsf(batch.MVP[i][c][r] - referenceMVP[i][c][r]));
+                    maxValue = max(maxValue, fabsf(referenceMVP[i][c][r]));
+                }
+        printf("  %s: %8.3f ms  %7.1f M objects/s  (x%.1f, %d thread%s, max |MVP - glm| %.2e of %.1f)\n", variants[v].name, seconds * 1e3,
+               count / seconds / 1e6, glmSeconds / seconds, variants[v].threads, variants[v].threads > 1 ? "s" : "", maxError, maxValue);
+    }
+
+    // 물체 하나만 돌린 프레임은 그 물체만, 바뀐 게 없는 프레임은 건너뜀
+    start = chrono::high_resolution_clock::now();
+    for (int round = 0; round < rounds; round++) {
+        batch.rotate(round % count, 1.0f, 0.0f);
+        updateTransformBatch(batch, camera, threads);
+    }
+    printf("  one object rotated  : %8.3f ms\n", elapsedSeconds(start) / rounds * 1e3);
+    start = chrono::high_resolution_clock::now();
+    bool recomputed = updateTransformBatch(batch, camera, threads);
+    printf("  unchanged frame     : %8.3f ms  (%s)\n\n", elapsedSeconds(start) * 1e3, recomputed ? "recomputed" : "skipped");
+}
+
+// ===== 렌더 큐 정렬 벤치마크 =====
+// 합성 장면: 물체마다 메시 64종 / 텍스처 16종(0 = 색상만) 중 하나, 재질 구간 1~3개, 10%는 선 pass
+// 물체를 임의 순서로 넣고 기수 정렬 vs std::sort 시간, 넣은 순서 vs 키 순서의 상태 변경 수 비교
+
+void runRenderQueueBenchmark(size_t commandCount) {
+    RenderQueue queue;
+    unsigned int seed = 12345;
+    size_t objects = 0;
+    while (queue.commands.size() < commandCount) {
+        RenderCommand command;
+        seed = seed * 1103515245u + 12345u;
+        command.pass = (seed >> 16) % 10 == 0 ? RENDER_PASS_LINES : RENDER_PASS_OPAQUE;
+        command.vertexBuffer = 1 + (seed >> 8) % 64;
+        command.texture = (seed >> 20) % 16;
+        command.MVP[3][0] = (float)objects++;
+        seed = seed * 1103515245u + 12345u;
+        float depth = (float)((seed >> 8) & 0xffff) / 65535.0f;
+        int submeshes = 1 + (int)((seed >> 4) % 3);
+        for (int i = 0; i < submeshes && queue.commands.size() < commandCount; i++) {
+            command.color = glm::vec3(0.1f * i, 0.5f, 0.5f);
+            command.first = i * 300;
+            command.count = 300;
+            pushRenderCommand(queue, command, depth);
+        }
+    }
+
+    vector<uint64_t> reference = queue.keys, keys, scratch;
+    const int rounds = 10;
+    chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+    for (int round = 0; round < rounds; round++) {
+        keys = queue.keys;
+        sort(keys.begin(), keys.end());
+    }
+    double sortSeconds = elapsedSeconds(start) / rounds;
+    reference = keys;
+
+    start = chrono::high_resolution_clock::now();
+    for (int round = 0; round < rounds; round++) {
+        keys = queue.keys;
+        radixSortRenderKeys(keys, scratch);
+    }
+    double radixSeconds = elapsedSeconds(start) / rounds;
+
+    RenderStateStats unsorted = countUnsortedStateChanges(queue), sorted;
+    const uint64_t indexMask = ((uint64_t)1 << RENDER_KEY_INDEX_BITS) - 1;
+    for (size_t k = 0; k < keys.size(); k++)
+        countStateChanges(k > 0 ? &queue.commands[(size_t)(keys[k - 1] & indexMask)] : nullptr, queue.commands[(size_t)(keys[k] & indexMask)], sorted);
+
+    printf("\n[bench-sortkeys] %zu commands from %zu objects\n", queue.commands.size(), objects);
+    printf("  std::sort  : %8.3f ms\n", sortSeconds * 1e3);
+    printf("  radix sort : %8.3f ms (%.1fx), %s\n", radixSeconds * 1e3, sortSeconds / radixSeconds, keys == reference ? "same order" : "ORDER MISMATCH");
+    printf("  state changes       %12s %12s\n", "submission", "sorted");
+    printf("    polygon mode      %12zu %12zu\n", unsorted.polygonModeChanges, sorted.polygonModeChanges);
+    printf("    texture           %12zu %12zu\n", unsorted.textureChanges, sorted.textureChanges);
+    printf("    buffer            %12zu %12zu\n", unsorted.bufferChanges, sorted.bufferChanges);
+    printf("    uniform           %12zu %12zu\n", unsorted.uniformChanges, sorted.uniformChanges);
+    printf("    total             %12zu %12zu\n\n", unsorted.total(), sorted.total());
+}
+
+// ===== 오클루전 컬링 벤치마크 =====
+// PiggyBank 격자를 낮은 시점에서 볼 때 절두체 컬링만 한 것과 계층 Z까지 한 것을 비교
+// 검증: 가려졌다고 뺀 인스턴스 일부를 원본(LOD 0) 오클루더로 만든 깊이 버퍼에 원본 메시로 그려서 보이는 픽셀이 있는지 셈
+
+void runOcclusionBenchmark(const char* path, int instanceCount) {
+    bool cacheSetting = useMeshCache;
+    useMeshCache = false;
+    vector<float> vertices;
+    vector<unsigned int> indices;
+    vector<SubMesh> submeshes;
+    glm::vec3 color;
+    bool ok = loadOBJFast(path, vertices, indices, color, nullptr, 1, &submeshes);
+    useMeshCache = cacheSetting;
+    if (!ok) return;
+
+    optimizeMesh(path, vertices, indices, submeshes);
+    vector<MeshLOD> lods;
+    buildMeshLODs(vertices, indices, submeshes, color, lods);
+    OcclusionCuller occlusion;
+    buildOccluderMesh(vertices, indices, submeshes, lods, occlusion.occluder);
+    OccluderMesh fullMesh;
+    buildOccluderMesh(vertices, indices, submeshes, vector<MeshLOD>(), fullMesh);
+
+    glm::vec3 minBound = vertexPosition(vertices, 0), maxBound = minBound;
+    for (size_t v = 1; v < vertices.size() / 5; v++) {
+        minBound = glm::min(minBound, vertexPosition(vertices, (unsigned int)v));
+        maxBound = glm::max(maxBound, vertexPosition(vertices, (unsigned int)v));
+    }
+    vector<InstanceData> instances;
+    vector<InstanceBounds> bounds;
+    AABBList boxes;
+    float extent = createInstanceGrid(instanceCount, minBound, maxBound, instances, bounds, boxes);
+    float radius = glm::length(maxBound - minBound) * 0.5f;
+    float farPlane = max(100.0f, 2.0f * extent);
+    glm::mat4 Projection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, farPlane);
+
+    // 격자 모서리에서 대각선으로 / 격자 안 한 줄 사이에서 줄을 따라 (낮은 시점 = 앞줄이 뒷줄을 가림)
+    const char* viewNames[2] = { "grid corner", "inside a row" };
+    CameraState cameras[2];
+    setCameraMatrices(cameras[0], Projection, glm::lookAt(glm::vec3(-extent * 0.7071f, radius * 0.6f, -extent * 0.7071f), glm::vec3(0.0f), glm::vec3(0, 1, 0)), farPlane);
+    setCameraMatrices(cameras[1], Projection, glm::lookAt(glm::vec3(radius, radius * 0.4f, -extent * 0.5f), glm::vec3(radius * 3.0f, radius * 0.4f, extent * 0.5f), glm::vec3(0, 1, 0)), farPlane);
+
+    printf("\n[bench-occlusion] %s: %zu instances, occluder %zu triangles (LOD 0: %zu), %dx%d depth, %d threads\n", path, instances.size(),
+           occlusion.occluder.indices.size() / 3, fullMesh.indices.size() / 3, OCCLUSION_WIDTH, OCCLUSION_HEIGHT, loaderThreadCount());
+    for (int v = 0; v < 2; v++) {
+        vector<InstanceData> visible;
+        size_t levelStarts[MAX_LOD_LEVELS + 1];
+        InstanceBatchStats frustumStats, occlusionStats;
+        gatherVisibleInstances(instances, bounds, boxes, lods, cameras[v], viewportHeight, visible, levelStarts, &frustumStats);
+        size_t frustumTriangles = 0;
+        for (size_t level = 0; level < lods.size(); level++) frustumTriangles += frustumStats.levelCounts[level] * lods[level].triangleCount;
+
+        const int frames = 10;
+        chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+        for (int frame = 0; frame < frames; frame++)
+            gatherVisibleInstances(instances, bounds, boxes, lods, cameras[v], viewportHeight, visible, levelStarts, &occlusionStats, &occlusion);
+        double seconds = elapsedSeconds(start) / frames;
+        size_t occlusionTriangles = 0;
+        for (size_t level = 0; level < lods.size(); level++) occlusionTriangles += occlusionStats.levelCounts[level] * lods[level].triangleCount;
+
+        // 검증용 깊이: 같은 오클루더 위치에 원본 메시
+        const glm::mat4& ViewProjection = cameras[v].ViewProjection;
+        vector<unsigned int> frustumVisible;
+        cullAABBs(boxes, ViewProjection, frustumVisible);
+        vector<char> isVisible(instances.size(), 0);
+        {
+            vector<unsigned int> unoccluded;
+            cullOccludedAABBs(occlusion.buffer, boxes, frustumVisible, unoccluded);
+            for (size_t i = 0; i < unoccluded.size(); i++) isVisible[unoccluded[i]] = 1;
+        }
+        const glm::vec3& cameraPosition = cameras[v].position;
+        vector<pair<float, unsigned int> > byDistance;
+        for (size_t i = 0; i < frustumVisible.size(); i++) {
+            glm::vec3 offset = bounds[frustumVisible[i]].center - cameraPosition;
+            byDistance.push_back(make_pair(glm::dot(offset, offset), frustumVisible[i]));
+        }
+        size_t occluderCount = min(byDistance.size(), (size_t)OCCLUSION_MAX_OCCLUDERS);
+        partial_sort(byDistance.begin(), byDistance.begin() + occluderCount, byDistance.end());
+        vector<glm::mat4> occluderModels;
+        for (size_t k = 0; k < occluderCount; k++) occluderModels.push_back(instances[byDistance[k].second].model);
+        OcclusionBuffer reference;
+        clearOcclusionBuffer(reference, ViewProjection);
+        rasterizeOccluders(reference, fullMesh, occluderModels, 1);
+
+        size_t checked = 0, wronglyOccluded = 0;
+        size_t step = max((size_t)1, occlusionStats.occluded / 200);
+        size_t occludedIndex = 0;
+        for (size_t i = 0; i < frustumVisible.size(); i++) {
+            unsigned int id = frustumVisible[i];
+            if (isVisible[id] || (occludedIndex++ % step) != 0) continue;
+            vector<OccluderTriangle> triangles;
+            setupOccluderTriangles(fullMesh, ViewProjection * instances[id].model, triangles);
+            vector<float> depth = reference.levels[0];
+            rasterizeOccluderRows(&depth[0], triangles, 0, OCCLUSION_HEIGHT);
+            checked++;
+            if (depth != reference.levels[0]) wronglyOccluded++;
+        }
+
+        printf("  %-12s: %zu in frustum, %zu occluded (%.1f%%), %.1fM -> %.1fM triangles\n", viewNames[v], frustumStats.visible,
+               occlusionStats.occluded, 100.0 * occlusionStats.occluded / max(frustumStats.visible, (size_t)1), frustumTriangles / 1e6, occlusionTriangles / 1e6);
+        printf("                %.2f ms per frame (raster %.2f ms for %zu triangles, pyramid %.3f ms, test %.2f ms), %zu / %zu sampled occluded instances visible at full detail\n",
+               seconds * 1e3, occlusion.stats.rasterSeconds * 1e3, occlusion.stats.triangles, occlusion.stats.pyramidSeconds * 1e3,
+               occlusion.stats.testSeconds * 1e3, wronglyOccluded, checked);
+    }
+    printf("\n");
 }
 
 // 바운딩 박스 라인 생성 [클로드 도움: 8개 모서리점을 12개 선분으로 연결하고 lines에 넣는 과정]
@@ -632,9 +7730,9 @@ void createAxisGeometry() {
 
 // Bounding Box 기반 마우스 클릭 감지
 int pickObject(int mouseX, int mouseY) {
-    // 화면 크기 480x480 기준
-    int screenWidth = 480;
-    int screenHeight = 480;
+    // 현재 창 크기 기준
+    int screenWidth = viewportWidth;
+    int screenHeight = viewportHeight;
     
     // 화면 중심 기준으로 좌표 변환 (-1 ~ 1)
     float normalizedX = (float)(mouseX - screenWidth/2) / (screenWidth/2);
@@ -642,61 +7740,19 @@ int pickObject(int mouseX, int mouseY) {
     
     // [클로드 도움: 마우스 클릭은 2D인데 바운딩 박스는 3D라서 좌표계를 맞추기 위해 3D→2D 변환하는 과정]
     
-    // MVP 변환을 통해 물체들의 Bounding Box 계산
-    glm::mat4 Projection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f); // 3D→2D 투영
-    glm::mat4 View = glm::mat4(1.0f);
-    View = glm::rotate(View, glm::radians(cameraRotationX), glm::vec3(1, 0, 0)); // 카메라 X축 회전
-    View = glm::rotate(View, glm::radians(cameraRotationY), glm::vec3(0, 1, 0)); // 카메라 Y축 회전  
-    View = glm::translate(View, glm::vec3(-cameraX, -cameraY, -(cameraDistance + cameraZ))); // 카메라 위치
-    
-    // Cube 바운딩 박스 계산
-    glm::mat4 CubeModel = glm::mat4(1.0f);
-    CubeModel = glm::rotate(CubeModel, glm::radians(cubeRotationX), glm::vec3(1, 0, 0));
-    CubeModel = glm::rotate(CubeModel, glm::radians(cubeRotationY), glm::vec3(0, 1, 0));
+    // MVP 변환을 통해 물체들의 Bounding Box 계산 (렌더링과 같은 카메라 / 변환 캐시, 바뀐 게 없으면 행렬 곱 없음)
+    const CameraState& camera = updateCameraState(sceneCamera, sceneFarPlane);
+    updateTransformBatch(sceneTransforms, camera);
+    const glm::mat4& CubeMVP = cubeTransform.MVP();
+    const glm::mat4& PiggyMVP = piggyTransform.MVP();
     
-    // Cube 바운딩 박스의 8개 모서리 점
-    glm::vec3 cubeCorners[8] = {
-        glm::vec3(cubeMinBound.x, cubeMinBound.y, cubeMinBound.z), glm::vec3(cubeMaxBound.x, cubeMinBound.y, cubeMinBound.z),
-        glm::vec3(cubeMinBound.x, cubeMaxBound.y, cubeMinBound.z), glm::vec3(cubeMaxBound.x, cubeMaxBound.y, cubeMinBound.z),
-        glm::vec3(cubeMinBound.x, cubeMinBound.y, cubeMaxBound.z), glm::vec3(cubeMaxBound.x, cubeMinBound.y, cubeMaxBound.z),
-        glm::vec3(cubeMinBound.x, cubeMaxBound.y, cubeMaxBound.z), glm::vec3(cubeMaxBound.x, cubeMaxBound.y, cubeMaxBound.z)
-    };
-    
-    // 8개 점을 화면 좌표로 변환하여 2D 바운딩 박스 범위 구하기
-    float cubeMinX = 1000, cubeMaxX = -1000, cubeMinY = 1000, cubeMaxY = -1000;
-    for (int i = 0; i < 8; i++) {
-        glm::vec4 projected = Projection * View * CubeModel * glm::vec4(cubeCorners[i], 1.0f);
-        projected /= projected.w;  // 동차좌표를 일반좌표로 변환
-        cubeMinX = min(cubeMinX, projected.x);
-        cubeMaxX = max(cubeMaxX, projected.x);
-        cubeMinY = min(cubeMinY, projected.y);
-        cubeMaxY = max(cubeMaxY, projected.y);
-    }
-    
-    // PiggyBank 바운딩 박스 계산 (동일한 과정)
-    glm::mat4 PiggyModel = glm::mat4(1.0f);
-    PiggyModel = glm::rotate(PiggyModel, glm::radians(piggyRotationX), glm::vec3(1, 0, 0));
-    PiggyModel = glm::rotate(PiggyModel, glm::radians(piggyRotationY), glm::vec3(0, 1, 0));
-    
-    // PiggyBank 바운딩 박스의 8개 모서리 점
-    glm::vec3 piggyCorners[8] = {
-        glm::vec3(piggyMinBound.x, piggyMinBound.y, piggyMinBound.z), glm::vec3(piggyMaxBound.x, piggyMinBound.y, piggyMinBound.z),
-        glm::vec3(piggyMinBound.x, piggyMaxBound.y, piggyMinBound.z), glm::vec3(piggyMaxBound.x, piggyMaxBound.y, piggyMinBound.z),
-        glm::vec3(piggyMinBound.x, piggyMinBound.y, piggyMaxBound.z), glm::vec3(piggyMaxBound.x, piggyMinBound.y, piggyMaxBound.z),
-        glm::vec3(piggyMinBound.x, piggyMaxBound.y, piggyMaxBound.z), glm::vec3(piggyMaxBound.x, piggyMaxBound.y, piggyMaxBound.z)
-    };
+    // Cube 바운딩 박스의 8개 모서리 점을 화면 좌표로 변환하여 2D 바운딩 박스 범위 구하기
+    float cubeMinX, cubeMaxX, cubeMinY, cubeMaxY;
+    projectBoundingBox(CubeMVP, cubeMinBound, cubeMaxBound, cubeMinX, cubeMaxX, cubeMinY, cubeMaxY);
     
-    // 8개 점을 화면 좌표로 변환하여 2D 바운딩 박스 범위 구하기
-    float piggyMinX = 1000, piggyMaxX = -1000, piggyMinY = 1000, piggyMaxY = -1000;
-    for (int i = 0; i < 8; i++) {
-        glm::vec4 projected = Projection * View * PiggyModel * glm::vec4(piggyCorners[i], 1.0f);
-        projected /= projected.w;  // 동차좌표를 일반좌표로 변환
-        
-        piggyMinX = min(piggyMinX, projected.x);
-        piggyMaxX = max(piggyMaxX, projected.x);
-        piggyMinY = min(piggyMinY, projected.y);
-        piggyMaxY = max(piggyMaxY, projected.y);
-    }
+    // PiggyBank 바운딩 박스의 8개 모서리 점을 화면 좌표로 변환하여 2D 바운딩 박스 범위 구하기 (동일한 과정)
+    float piggyMinX, piggyMaxX, piggyMinY, piggyMaxY;
+    projectBoundingBox(PiggyMVP, piggyMinBound, piggyMaxBound, piggyMinX, piggyMaxX, piggyMinY, piggyMaxY);
     
     // Bounding Box 내부 클릭 검사
     bool inCube = (normalizedX >= cubeMinX && normalizedX <= cubeMaxX && 
@@ -710,8 +7766,8 @@ int pickObject(int mouseX, int mouseY) {
         glm::vec3 cubeCenterPoint = (cubeMinBound + cubeMaxBound) * 0.5f;
         glm::vec3 piggyCenterPoint = (piggyMinBound + piggyMaxBound) * 0.5f;
         
-        glm::vec4 cubeCenter = Projection * View * CubeModel * glm::vec4(cubeCenterPoint, 1.0f);
-        glm::vec4 piggyCenter = Projection * View * PiggyModel * glm::vec4(piggyCenterPoint, 1.0f);
+        glm::vec4 cubeCenter = CubeMVP * glm::vec4(cubeCenterPoint, 1.0f);
+        glm::vec4 piggyCenter = PiggyMVP * glm::vec4(piggyCenterPoint, 1.0f);
         if (cubeCenter.z < piggyCenter.z) {  // 더 앞에 있는 것
             printf("Clicked on Cube (closer)\n");
             return 1;
@@ -775,15 +7831,13 @@ void mouseMotion(int x, int y) {
 		
 		if (selectedObject == 1) {
 			// Cube 회전
-			cubeRotationY += deltaX * rotationSpeed;
-			cubeRotationX += deltaY * rotationSpeed;
-			printf("Rotating Cube: X=%.1f, Y=%.1f\n", cubeRotationX, cubeRotationY);
+			cubeTransform.rotate(deltaY * rotationSpeed, deltaX * rotationSpeed);
+			printf("Rotating Cube: X=%.1f, Y=%.1f\n", cubeTransform.rotationX(), cubeTransform.rotationY());
 		}
 		else if (selectedObject == 2) {
 			// PiggyBank 회전
-			piggyRotationY += deltaX * rotationSpeed;
-			piggyRotationX += deltaY * rotationSpeed;
-			printf("Rotating Piggy: X=%.1f, Y=%.1f\n", piggyRotationX, piggyRotationY);
+			piggyTransform.rotate(deltaY * rotationSpeed, deltaX * rotationSpeed);
+			printf("Rotating Piggy: X=%.1f, Y=%.1f\n", piggyTransform.rotationX(), piggyTransform.rotationY());
 		}
 		else {
 			// 카메라 회전 (빈 공간 클릭 시)
@@ -799,6 +7853,26 @@ void mouseMotion(int x, int y) {
 	}
 }
 
+// 화면 크기에 맞는 LOD를 고르고 원본 LOD면 meshlet 컬링 (절두체 밖 / 전부 뒷면). LOD가 없으면 0, visibleMeshlets는 비어 있음
+int selectLODAndCullMeshlets(const vector<MeshLOD>& lods, const vector<Meshlet>& meshlets, const glm::mat4& Model, const glm::mat4& MVP,
+                             const glm::vec3& minBound, const glm::vec3& maxBound, const CameraState& camera, vector<char>& visibleMeshlets) {
+	visibleMeshlets.clear();
+	if (lods.empty()) return 0;
+	int level = selectLOD(lods, MVP, minBound, maxBound, viewportHeight);
+	if (level == 0 && cullMeshletsEnabled && !meshlets.empty()) {
+		glm::vec3 cameraPosition = worldToModel(Model, camera.position);
+		cullMeshlets(meshlets, MVP, cameraPosition, visibleMeshlets);
+	}
+	return level;
+}
+
+// 창 크기가 바뀌면 viewport와 픽킹 / LOD 기준 크기를 같이 갱신
+void reshape(int width, int height) {
+	viewportWidth = max(width, 1);
+	viewportHeight = max(height, 1);
+	glViewport(0, 0, viewportWidth, viewportHeight);
+}
+
 void renderScene(void)
 {
 	//Clear all pixels
@@ -811,172 +7885,210 @@ void renderScene(void)
 	printf("Camera rotation: (%.2f, %.2f)\n", cameraRotationX, cameraRotationY);
 	printf("Camera distance: %.2f\n", cameraDistance);
 	printf("ProgramID: %d\n", programID);
+	static bool firstFrame = true;
+	if (firstFrame) {
+		printf("First frame: %.1f ms after startup (%s)\n", elapsedSeconds(startupTime) * 1e3,
+		       asyncTexturesPending() ? "textures still decoding" : "all textures uploaded");
+		firstFrame = false;
+	}
 
-	// MVP 매트릭스 계산
-	glm::mat4 Projection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 100.0f);
-	
-	// 카메라 회전 적용된 View 매트릭스
-	glm::mat4 View = glm::mat4(1.0f);
-	View = glm::rotate(View, glm::radians(cameraRotationX), glm::vec3(1, 0, 0));
-	View = glm::rotate(View, glm::radians(cameraRotationY), glm::vec3(0, 1, 0));
-	View = glm::translate(View, glm::vec3(-cameraX, -cameraY, -(cameraDistance + cameraZ)));
-
-	// Shader에 MVP 전달
-	GLuint MatrixID = glGetUniformLocation(programID, "MVP");
-	printf("Matrix ID: %d\n", MatrixID);
-
-	// Material 색상 uniform 위치 가져오기
-	GLuint MaterialColorID = glGetUniformLocation(programID, "materialColor");
-	printf("Material Color ID: %d\n", MaterialColorID);
-	
-	// 텍스처 관련 uniform 위치 가져오기
-	GLuint TextureSamplerID = glGetUniformLocation(programID, "textureSampler");
-	GLuint UseTextureID = glGetUniformLocation(programID, "useTexture");
+	// 카메라 (V, P, VP와 역행렬): 카메라 값이 바뀐 프레임에만 다시 계산
+	const CameraState& camera = updateCameraState(sceneCamera, sceneFarPlane);
+
+	// 주 셰이더 uniform 위치 (MVP, 재질, 텍스처, 인스턴싱, 정점 포맷 복원)
+	RenderUniforms renderUniforms = getRenderUniforms(programID);
+	printf("Matrix ID: %d\n", renderUniforms.MVP);
+	printf("Material Color ID: %d\n", renderUniforms.materialColor);
+
+	// 지오메트리 풀 경로에서 이번 프레임에 모을 draw (렌더 큐에는 명령 하나로 들어감)
+	vector<PoolDrawList> poolDrawLists;
+
+	// Cube / PiggyBank Model 회전적용: 모든 물체의 model / MVP를 배치로 (회전이나 카메라가 바뀐 프레임에만)
+	updateTransformBatch(sceneTransforms, camera, loaderThreadCount());
+	const glm::mat4& CubeModel = cubeTransform.model();
+	const glm::mat4& PiggyModel = piggyTransform.model();
+
+	// 물체 AABB 절두체 컬링: 월드 AABB 중 보이는 번호만 visibleObjects에 (0: cube, 1: piggy)
+	sceneBoxes.clear();
+	sceneBoxes.addTransformed(CubeModel, cubeMinBound, cubeMaxBound);
+	sceneBoxes.addTransformed(PiggyModel, piggyMinBound, piggyMaxBound);
+	cullAABBs(sceneBoxes, camera.ViewProjection, visibleObjects);
+	bool cubeVisible = false, piggyVisible = false;
+	for (size_t i = 0; i < visibleObjects.size(); i++) {
+		if (visibleObjects[i] == 0) cubeVisible = true;
+		if (visibleObjects[i] == 1) piggyVisible = true;
+	}
 
-	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);  // polygon으로 채워서 그리기
+	// 아래는 그리지 않고 sceneRenderQueue에 명령만 넣음 (맨 끝에서 정렬 후 제출)
 
-	// Cube 그리기
+	// Cube
 	printf("CubeVertices size: %zu, CubeIndices size: %zu\n", cubeVertices.size(), cubeIndices.size());
-	if (!cubeVertices.empty() && !cubeIndices.empty()) {
-		// Cube Model 회전적용
-		glm::mat4 CubeModel = glm::mat4(1.0f);
-		CubeModel = glm::rotate(CubeModel, glm::radians(cubeRotationX), glm::vec3(1, 0, 0));
-		CubeModel = glm::rotate(CubeModel, glm::radians(cubeRotationY), glm::vec3(0, 1, 0));
-		glm::mat4 CubeMVP = Projection * View * CubeModel;
-		
-		// Cube MVP 전달
-		glUniformMatrix4fv(MatrixID, 1, GL_FALSE, &CubeMVP[0][0]);
-		
-		// Cube 재질 색상 설정 (MTL에서 로딩된 색상)
-		printf("Cube color: (%.3f, %.3f, %.3f)\n", cubeActualColor.r, cubeActualColor.g, cubeActualColor.b);
-        // [클로드 도움: 색상을 전달하는 방법과 텍스처를 전달하는 방법을 물어보고 아래의 함수를 적용함]
-		glUniform3fv(MaterialColorID, 1, &cubeActualColor[0]);
-		glUniform1i(UseTextureID, 0); // 텍스처 사용 안함
-		
-		glBindBuffer(GL_ARRAY_BUFFER, CubeVertexBuffer);
-		
-		// Position attribute (location = 0)
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-		glEnableVertexAttribArray(0);
-		
-		// Texture coordinate attribute (location = 1)
-		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-		glEnableVertexAttribArray(1);
+	if (!cubeVertices.empty() && !cubeIndices.empty() && cubeVisible) {
+		const glm::mat4& CubeMVP = cubeTransform.MVP();
+		float cubeDepth = renderDepth(CubeMVP, cubeMinBound, cubeMaxBound, camera.farPlane);
 
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, CubeIndexBuffer);
-		glDrawElements(GL_TRIANGLES, (GLsizei)cubeIndices.size(), GL_UNSIGNED_INT, 0);
-		printf("Draw call completed\n");
-	} else {
+		// 화면 크기에 맞는 LOD, 원본 LOD면 meshlet 컬링
+		vector<char> visibleMeshlets;
+		int level = selectLODAndCullMeshlets(cubeLODs, cubeMeshlets, CubeModel, CubeMVP, cubeMinBound, cubeMaxBound, camera, visibleMeshlets);
+
+		if (geometryPoolReady) {
+			// 풀 경로: 명령만 기록하고 아래에서 한 번에 제출
+			appendPoolDraws(poolDrawLists, cubePoolMesh, cubeLODs.empty() ? cubeSubMeshes : cubeLODs[level].submeshes, 0, CubeMVP,
+			                &cubeMeshlets, visibleMeshlets.empty() ? nullptr : &visibleMeshlets);
+		} else {
+			// Cube 재질 색상 (MTL에서 로딩된 색상), 재질 구간이 있으면 구간마다 Kd 색상
+			printf("Cube color: (%.3f, %.3f, %.3f)\n", cubeActualColor.r, cubeActualColor.g, cubeActualColor.b);
+			RenderCommand command;
+			command.vertexBuffer = CubeVertexBuffer;
+			command.indexBuffer = CubeIndexBuffer;
+			command.layout = &cubeVertexLayout;
+			command.MVP = CubeMVP;
+			command.color = cubeActualColor;
+			if (!cubeLODs.empty()) {
+				// 화면 크기에 맞는 LOD를 재질별로 한 번씩 (usemtl 그룹마다 Kd 색상)
+				queueSubMeshes(sceneRenderQueue, command, cubeLODs[level].submeshes, 0, cubeDepth,
+				               &cubeMeshlets, visibleMeshlets.empty() ? nullptr : &visibleMeshlets);
+			} else if (!cubeSubMeshes.empty()) {
+				queueSubMeshes(sceneRenderQueue, command, cubeSubMeshes, 0, cubeDepth);
+			} else {
+				command.count = (GLsizei)cubeIndices.size();
+				pushRenderCommand(sceneRenderQueue, command, cubeDepth);
+			}
+		}
+	} else if (cubeVertices.empty() || cubeIndices.empty()) {
 		printf("No vertices or indices to draw!\n");
 	}
 
-	// PiggyBank OBJ 모델 그리기
-	if (!piggyVertices.empty() && !piggyIndices.empty()) {
-		// PiggyBank Model 회전적용
-		glm::mat4 PiggyModel = glm::mat4(1.0f);
-		PiggyModel = glm::rotate(PiggyModel, glm::radians(piggyRotationX), glm::vec3(1, 0, 0));
-		PiggyModel = glm::rotate(PiggyModel, glm::radians(piggyRotationY), glm::vec3(0, 1, 0));
-		glm::mat4 PiggyMVP = Projection * View * PiggyModel;
-		
-		// PiggyBank MVP 전달
-		glUniformMatrix4fv(MatrixID, 1, GL_FALSE, &PiggyMVP[0][0]);
-		
-		// PiggyBank 텍스처 및 재질 설정
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, piggyTextureID);
-        // [클로드 도움: 텍스처 설정 관련 함수 물어보고 아래처럼 적용]
-		glUniform1i(TextureSamplerID, 0); // 텍스처 유닛 0 사용
-		glUniform1i(UseTextureID, 1); // 텍스처 사용
-		glUniform3f(MaterialColorID, 1.0f, 1.0f, 1.0f); // 흰색으로 텍스처 원본 색상 유지
-
-		glBindBuffer(GL_ARRAY_BUFFER, PiggyVertexBuffer);
-		
-		// Position attribute (location = 0)
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-		glEnableVertexAttribArray(0);
-		
-		// Texture coordinate attribute (location = 1)
-		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-		glEnableVertexAttribArray(1);
-		
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, PiggyIndexBuffer);
-		glDrawElements(GL_TRIANGLES, (GLsizei)piggyIndices.size(), GL_UNSIGNED_INT, 0);
-	} else {
+	// PiggyBank OBJ 모델 (스트리밍으로 올렸으면 페이지 단위로)
+	if (((!piggyVertices.empty() && !piggyIndices.empty()) || !piggyStreamedMesh.indexCounts.empty()) && piggyVisible) {
+		const glm::mat4& PiggyMVP = piggyTransform.MVP();
+		float piggyDepth = renderDepth(PiggyMVP, piggyMinBound, piggyMaxBound, camera.farPlane);
+
+		// PiggyBank 텍스처, 흰색으로 텍스처 원본 색상 유지
+		RenderCommand command;
+		command.vertexBuffer = PiggyVertexBuffer;
+		command.indexBuffer = PiggyIndexBuffer;
+		command.layout = &piggyVertexLayout;
+		command.MVP = PiggyMVP;
+		command.texture = piggyTextureID;
+
+		if (!piggyStreamedMesh.indexCounts.empty()) {
+			command.type = RENDER_STREAMED;
+			command.streamed = &piggyStreamedMesh;
+			pushRenderCommand(sceneRenderQueue, command, piggyDepth);
+		} else if (geometryPoolReady) {
+			// 풀 경로: LOD 선택 + meshlet 컬링 후 명령만 기록
+			vector<char> visibleMeshlets;
+			int level = selectLODAndCullMeshlets(piggyLODs, piggyMeshlets, PiggyModel, PiggyMVP, piggyMinBound, piggyMaxBound, camera, visibleMeshlets);
+			appendPoolDraws(poolDrawLists, piggyPoolMesh, piggyLODs.empty() ? piggySubMeshes : piggyLODs[level].submeshes, piggyTextureID, PiggyMVP,
+			                &piggyMeshlets, visibleMeshlets.empty() ? nullptr : &visibleMeshlets);
+		} else if (!piggyLODs.empty()) {
+			// 화면 크기에 맞는 LOD를 재질별로 한 번씩, 원본 LOD면 meshlet 단위 컬링
+			vector<char> visibleMeshlets;
+			int level = selectLODAndCullMeshlets(piggyLODs, piggyMeshlets, PiggyModel, PiggyMVP, piggyMinBound, piggyMaxBound, camera, visibleMeshlets);
+			queueSubMeshes(sceneRenderQueue, command, piggyLODs[level].submeshes, piggyTextureID, piggyDepth,
+			               &piggyMeshlets, visibleMeshlets.empty() ? nullptr : &visibleMeshlets);
+		} else if (!piggySubMeshes.empty()) {
+			// 재질별로 한 번씩 (map_Kd가 없는 재질은 piggyTextureID 사용)
+			queueSubMeshes(sceneRenderQueue, command, piggySubMeshes, piggyTextureID, piggyDepth);
+		} else {
+			command.count = (GLsizei)piggyIndices.size();
+			pushRenderCommand(sceneRenderQueue, command, piggyDepth);
+		}
+	} else if ((piggyVertices.empty() || piggyIndices.empty()) && piggyStreamedMesh.indexCounts.empty()) {
 		printf("No piggy vertices or indices to draw!\n");
 	}
 
-	// 좌표축 그리기 (고정된 위치)
+	// PiggyBank 인스턴스 (--instances): 보이는 것만 LOD별로 모아서 LOD당 재질 구간마다 명령 하나
+	if (!piggyInstances.empty() && PiggyInstanceBuffer != 0 && !piggyLODs.empty()) {
+		size_t levelStarts[MAX_LOD_LEVELS + 1];
+		gatherVisibleInstances(piggyInstances, piggyInstanceBounds, piggyInstanceBoxes, piggyLODs, camera, viewportHeight,
+		                       piggyVisibleInstances, levelStarts, nullptr, occlusionCullingEnabled ? &piggyOcclusion : nullptr);
+
+		const glm::mat4& ViewProjection = camera.ViewProjection; // 인스턴스 model은 셰이더에서 곱함
+
+		// 이전 프레임이 쓰던 저장소는 버리고(orphan) 새로 채움
+		glBindBuffer(GL_ARRAY_BUFFER, PiggyInstanceBuffer);
+		glBufferData(GL_ARRAY_BUFFER, piggyInstances.size() * sizeof(InstanceData), NULL, GL_STREAM_DRAW);
+		if (!piggyVisibleInstances.empty())
+			glBufferSubData(GL_ARRAY_BUFFER, 0, piggyVisibleInstances.size() * sizeof(InstanceData), &piggyVisibleInstances[0]);
+
+		for (size_t level = 0; level < piggyLODs.size(); level++) {
+			size_t count = levelStarts[level + 1] - levelStarts[level];
+			if (count == 0) continue;
+			if (geometryPoolReady) {
+				// 풀 경로: LOD마다 인스턴스 명령 (baseInstance = 그 LOD 인스턴스의 시작)
+				appendPoolDraws(poolDrawLists, piggyPoolMesh, piggyLODs[level].submeshes, piggyTextureID, ViewProjection,
+				                nullptr, nullptr, (GLuint)count, (GLuint)levelStarts[level]);
+				continue;
+			}
+			RenderCommand command;
+			command.vertexBuffer = PiggyVertexBuffer;
+			command.indexBuffer = PiggyIndexBuffer;
+			command.layout = &piggyVertexLayout;
+			command.MVP = ViewProjection;
+			command.instanceBuffer = PiggyInstanceBuffer;
+			command.instanceCount = (GLsizei)count;
+			command.firstInstance = levelStarts[level];
+			// 인스턴스 묶음의 깊이는 LOD 단계로 대신함 (LOD가 낮을수록 가까움)
+			queueSubMeshes(sceneRenderQueue, command, piggyLODs[level].submeshes, piggyTextureID, (float)level / MAX_LOD_LEVELS);
+		}
+	}
+
+	// 풀에 기록한 메시 draw는 명령 하나로 (텍스처 하나면 GL 호출 한 번)
+	if (geometryPoolReady && !poolDrawLists.empty()) {
+		RenderCommand command;
+		command.type = RENDER_POOL;
+		command.poolDraws = &poolDrawLists;
+		command.instanceBuffer = PiggyInstanceBuffer;
+		pushRenderCommand(sceneRenderQueue, command, 0.0f);
+	}
+
+	// 좌표축 (고정된 위치, Identity model): X 빨강, Y 초록, Z 파랑
 	if (!axisVertices.empty()) {
-		// 좌표축은 Identity 1.0f
-		glm::mat4 AxisModel = glm::mat4(1.0f);
-		glm::mat4 AxisMVP = Projection * View * AxisModel;
-		glUniformMatrix4fv(MatrixID, 1, GL_FALSE, &AxisMVP[0][0]);
-		
-		glBindBuffer(GL_ARRAY_BUFFER, AxisVertexBuffer);
-		
-		// Position attribute (location = 0)
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-		glEnableVertexAttribArray(0);
-		
-		// Texture coordinate attribute (location = 1)
-		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
-		glEnableVertexAttribArray(1);
-		
-		// 좌표축은 텍스처 사용 안함
-		glUniform1i(UseTextureID, 0);
-		
-		// X축 그리기 (빨간색)
-		glUniform3f(MaterialColorID, 1.0f, 0.0f, 0.0f);
-		glDrawArrays(GL_LINES, 0, 2);
-		
-		// Y축 그리기 (초록색)
-		glUniform3f(MaterialColorID, 0.0f, 1.0f, 0.0f);
-		glDrawArrays(GL_LINES, 2, 2);
-		
-		// Z축 그리기 (파란색)
-		glUniform3f(MaterialColorID, 0.0f, 0.0f, 1.0f);
-		glDrawArrays(GL_LINES, 4, 2);
-		
-		printf("Coordinate axes drawn\n");
+		RenderCommand command;
+		command.type = RENDER_ARRAYS;
+		command.pass = RENDER_PASS_LINES;
+		command.primitive = GL_LINES;
+		command.vertexBuffer = AxisVertexBuffer;
+		command.MVP = camera.ViewProjection;
+		command.count = 2;
+		const glm::vec3 axisColors[3] = { glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f) };
+		for (int axis = 0; axis < 3; axis++) {
+			command.first = axis * 2;
+			command.color = axisColors[axis];
+			pushRenderCommand(sceneRenderQueue, command, 0.0f);
+		}
 	}
 
-	// 바운딩 박스 그리기
-	glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-	
-	// Cube 바운딩 박스 그리기
+	// 바운딩 박스 (선, 청록색)
+	RenderCommand boxCommand;
+	boxCommand.type = RENDER_ARRAYS;
+	boxCommand.pass = RENDER_PASS_LINES;
+	boxCommand.primitive = GL_LINES;
+	boxCommand.color = glm::vec3(0.0f, 1.0f, 1.0f);
 	if (!cubeBBoxVertices.empty()) {
-		glm::mat4 CubeModel = glm::mat4(1.0f);
-		CubeModel = glm::rotate(CubeModel, glm::radians(cubeRotationX), glm::vec3(1, 0, 0));
-		CubeModel = glm::rotate(CubeModel, glm::radians(cubeRotationY), glm::vec3(0, 1, 0));
-		glm::mat4 CubeBBoxMVP = Projection * View * CubeModel;
-		
-		glUniformMatrix4fv(MatrixID, 1, GL_FALSE, &CubeBBoxMVP[0][0]);
-		glUniform1i(UseTextureID, 0); // 텍스처 사용 안함
-		glUniform3f(MaterialColorID, 0.0f, 1.0f, 1.0f);
-		
-		glBindBuffer(GL_ARRAY_BUFFER, CubeBBoxVertexBuffer);
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-		glEnableVertexAttribArray(0);
-		glDrawArrays(GL_LINES, 0, cubeBBoxVertices.size() / 5);
-		printf("Cube bounding box drawn\n");
+		boxCommand.vertexBuffer = CubeBBoxVertexBuffer;
+		boxCommand.MVP = cubeTransform.MVP();
+		boxCommand.count = (GLsizei)(cubeBBoxVertices.size() / 5);
+		pushRenderCommand(sceneRenderQueue, boxCommand, 0.0f);
 	}
-	
-	// Piggy 바운딩 박스 그리기
 	if (!piggyBBoxVertices.empty()) {
-		glm::mat4 PiggyModel = glm::mat4(1.0f);
-		PiggyModel = glm::rotate(PiggyModel, glm::radians(piggyRotationX), glm::vec3(1, 0, 0));
-		PiggyModel = glm::rotate(PiggyModel, glm::radians(piggyRotationY), glm::vec3(0, 1, 0));
-		glm::mat4 PiggyBBoxMVP = Projection * View * PiggyModel;
-		
-		glUniformMatrix4fv(MatrixID, 1, GL_FALSE, &PiggyBBoxMVP[0][0]);
-		glUniform1i(UseTextureID, 0); // 텍스처 사용 안함
-		glUniform3f(MaterialColorID, 0.0f, 1.0f, 1.0f);
-		
-		glBindBuffer(GL_ARRAY_BUFFER, PiggyBBoxVertexBuffer);
-		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-		glEnableVertexAttribArray(0);
-		glDrawArrays(GL_LINES, 0, piggyBBoxVertices.size() / 5);
-		printf("Piggy bounding box drawn\n");
+		boxCommand.vertexBuffer = PiggyBBoxVertexBuffer;
+		boxCommand.MVP = piggyTransform.MVP();
+		boxCommand.count = (GLsizei)(piggyBBoxVertices.size() / 5);
+		pushRenderCommand(sceneRenderQueue, boxCommand, 0.0f);
+	}
+
+	// 키 정렬 후 제출. --render-stats 이면 넣은 순서대로 그렸을 때와 바뀐 상태 수 비교
+	if (printRenderQueueStats) {
+		RenderStateStats unsortedStats = countUnsortedStateChanges(sceneRenderQueue);
+		RenderStateStats sortedStats = submitRenderQueue(sceneRenderQueue, renderUniforms);
+		printf("Render queue: %zu commands, %zu state changes (%zu in submission order): program %zu, polygon mode %zu, texture %zu, buffer %zu, uniform %zu\n",
+		       sortedStats.commands, sortedStats.total(), unsortedStats.total(), sortedStats.programChanges, sortedStats.polygonModeChanges,
+		       sortedStats.textureChanges, sortedStats.bufferChanges, sortedStats.uniformChanges);
+	} else {
+		submitRenderQueue(sceneRenderQueue, renderUniforms);
 	}
 
 	//Double buffer
@@ -1004,6 +8116,112 @@ void init()
 
 int main(int argc, char **argv)
 {
+	startupTime = chrono::high_resolution_clock::now();
+
+	// 벤치마크 모드 (창 없이 실행 후 종료)
+	if (argc > 1 && strcmp(argv[1], "--bench-obj") == 0) {
+		runOBJBenchmark(argc > 2 ? atoll(argv[2]) : 10000000LL, argc > 3 ? atoi(argv[3]) : loaderThreadCount());
+		return 0;
+	}
+	if (argc > 1 && strcmp(argv[1], "--bench-dedup") == 0) {
+		runDedupBenchmark(argc > 2 ? atoll(argv[2]) : 10000000LL);
+		return 0;
+	}
+	if (argc > 1 && strcmp(argv[1], "--bench-stream") == 0) {
+		runStreamBenchmark(argc > 2 ? atoll(argv[2]) : 10000000LL, argc > 3 ? (size_t)atoll(argv[3]) : 256);
+		return 0;
+	}
+	if (argc > 1 && strcmp(argv[1], "--bench-vcache") == 0) {
+		runVertexCacheBenchmark(argc > 2 ? atoll(argv[2]) : 1000000LL);
+		return 0;
+	}
+	if (argc > 1 && strcmp(argv[1], "--bench-meshlet") == 0) {
+		runMeshletBenchmark(argc > 2 ? argv[2] : "./PiggyBank.obj", argc > 3 ? atoi(argv[3]) : 64);
+		return 0;
+	}
+	if (argc > 1 && strcmp(argv[1], "--bench-cull") == 0) {
+		runCullBenchmark(argc > 2 ? atoll(argv[2]) : 1000000LL);
+		return 0;
+	}
+	if (argc > 1 && strcmp(argv[1], "--bench-mipmap") == 0) {
+		runMipmapBenchmark(argc > 2 ? argv[2] : "./PiggyBankUVTex.png", argc > 3 ? max(atoi(argv[3]), 8) : 256);
+		return 0;
+	}
+	if (argc > 1 && strcmp(argv[1], "--bench-bc") == 0) {
+		runBlockCompressionBenchmark(argc > 2 ? argv[2] : "./PiggyBankUVTex.png");
+		return 0;
+	}
+	if (argc > 1 && strcmp(argv[1], "--bench-texcache") == 0) {
+		runTextureCacheBenchmark(argc > 2 ? argv[2] : "./PiggyBankUVTex.png");
+		return 0;
+	}
+	if (argc > 1 && strcmp(argv[1], "--bench-atlas") == 0) {
+		runAtlasBenchmark(argc > 2 ? min(max(atoi(argv[2]), 2), 4096) : 64);
+		return 0;
+	}
+	if (argc > 1 && strcmp(argv[1], "--bench-transforms") == 0) {
+		runTransformBenchmark(argc > 2 ? (size_t)max(atoll(argv[2]), 1LL) : 100000, argc > 3 ? atoi(argv[3]) : loaderThreadCount());
+		return 0;
+	}
+	if (argc > 1 && strcmp(argv[1], "--bench-sortkeys") == 0) {
+		runRenderQueueBenchmark(argc > 2 ? min((size_t)max(atoll(argv[2]), 1LL), RENDER_QUEUE_MAX_COMMANDS) : 100000);
+		return 0;
+	}
+	if (argc > 1 && strcmp(argv[1], "--bench-occlusion") == 0) {
+		runOcclusionBenchmark(argc > 3 ? argv[3] : "./PiggyBank.obj", argc > 2 ? min(max(atoi(argv[2]), 1), MAX_INSTANCES) : MAX_INSTANCES);
+		return 0;
+	}
+	if (argc > 1 && strcmp(argv[1], "--bench-instances") == 0) {
+		runInstancingBenchmark(argc > 3 ? argv[3] : "./PiggyBank.obj", argc > 2 ? min(max(atoi(argv[2]), 1), MAX_INSTANCES) : MAX_INSTANCES);
+		return 0;
+	}
+	if (argc > 1 && strcmp(argv[1], "--bench-lod") == 0) {
+		runLODBenchmark(argc > 2 ? argv[2] : "./PiggyBank.obj");
+		return 0;
+	}
+	if (argc > 1 && strcmp(argv[1], "--bench-quantize") == 0) {
+		runQuantizationBenchmark(argc > 2 ? atoll(argv[2]) : 1000000LL);
+		return 0;
+	}
+	// 정점 포맷 옵션: --vertex-format float32 | snorm16 | half
+	for (int i = 1; i + 1 < argc; i++) {
+		if (strcmp(argv[i], "--vertex-format") != 0) continue;
+		if (strcmp(argv[i + 1], SNORM16_VERTEX_FORMAT.name) == 0) meshVertexFormat = &SNORM16_VERTEX_FORMAT;
+		else if (strcmp(argv[i + 1], HALF_VERTEX_FORMAT.name) == 0) meshVertexFormat = &HALF_VERTEX_FORMAT;
+		else meshVertexFormat = &FLOAT_VERTEX_FORMAT;
+	}
+	// 텍스처 블록 압축: --texture-format none | bc1 | bc3 | bc7 (기본은 알파 유무로 BC1 / BC3)
+	for (int i = 1; i + 1 < argc; i++) {
+		if (strcmp(argv[i], "--texture-format") != 0) continue;
+		for (int format = TEXTURE_UNCOMPRESSED; format <= TEXTURE_BC7; format++)
+			if (strcmp(argv[i + 1], TEXTURE_COMPRESSION_NAMES[format]) == 0) textureCompression = (TextureCompression)format;
+	}
+	// 인스턴싱 데모: --instances N (PiggyBank N개, 최대 MAX_INSTANCES)
+	for (int i = 1; i + 1 < argc; i++) {
+		if (strcmp(argv[i], "--instances") == 0) piggyInstanceCount = min(max(atoi(argv[i + 1]), 0), MAX_INSTANCES);
+	}
+	// 지오메트리 풀 켜기 (multi-draw indirect), 오클루전 컬링 끄기, mip 체인 끄기, 텍스처 디코드를 메인 스레드에서, 스테이징 링 끄기,
+	// 텍스처 배열 아틀라스 끄기, 오버드로 순서 최적화 켜기, 렌더 큐 통계 출력
+	bool syncTextures = false;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--geometry-pool") == 0) useGeometryPool = true;
+		if (strcmp(argv[i], "--no-occlusion") == 0) occlusionCullingEnabled = false;
+		if (strcmp(argv[i], "--no-mipmaps") == 0) generateMipmaps = false;
+		if (strcmp(argv[i], "--sync-textures") == 0) syncTextures = true;
+		if (strcmp(argv[i], "--no-staging-ring") == 0) useStagingRing = false;
+		if (strcmp(argv[i], "--no-texture-atlas") == 0) useTextureAtlas = false;
+		if (strcmp(argv[i], "--optimize-overdraw") == 0) optimizeOverdrawEnabled = true;
+		if (strcmp(argv[i], "--render-stats") == 0) printRenderQueueStats = true;
+	}
+	if (argc > 1 && strcmp(argv[1], "--bench-overdraw") == 0) {
+		runOverdrawBenchmark(argc > 2 ? argv[2] : "./PiggyBank.obj", argc > 3 ? atoi(argv[3]) : 16);
+		return 0;
+	}
+
+	// 장면 물체 변환 (둘 다 원점에서 회전만)
+	cubeTransform = Transform(sceneTransforms, sceneTransforms.add(0.0f, 0.0f, glm::vec3(0.0f)));
+	piggyTransform = Transform(sceneTransforms, sceneTransforms.add(0.0f, 0.0f, glm::vec3(0.0f)));
+
 	//init GLUT and create Window
 	//initialize the GLUT
 	glutInit(&argc, argv);
@@ -1015,13 +8233,41 @@ int main(int argc, char **argv)
 #endif
 	//These two functions are used to define the position and size of the window. 
 	glutInitWindowPosition(200, 200);
-	glutInitWindowSize(480, 480);
+	glutInitWindowSize(viewportWidth, viewportHeight);
 	//This is used to define the name of the window.
 	glutCreateWindow("Simple OpenGL Window");
 
 	//call initization function
 	init();
 
+	// 텍스처 / 정적 버퍼 업로드용 persistent mapped 링 (GL 4.4 또는 ARB_buffer_storage)
+	if (useStagingRing && stagingRingSupported()) createStagingRing(stagingRing, STAGING_RING_BYTES);
+
+	// 이제부터 loadMTL이 map_Kd를 찾으면 바로 작업 스레드에서 디코드 시작
+	asyncTextureDecode = !syncTextures;
+
+	// 두 모델의 map_Kd는 OBJ 파싱 전에 미리 찾아서 디코드를 시작 (파싱, 메시 최적화와 겹침)
+	vector<string> prefetchTexturePaths;
+	collectOBJTexturePaths("./cube.obj", prefetchTexturePaths);
+	collectOBJTexturePaths("./PiggyBank.obj", prefetchTexturePaths);
+	if (useTextureAtlas) planTextureAtlas(textureAtlas, prefetchTexturePaths); // 아틀라스 멤버를 먼저 정하고 나머지만 비동기로
+	for (size_t i = 0; i < prefetchTexturePaths.size(); i++) requestTextureDecode(prefetchTexturePaths[i]);
+
+	// 통합 지오메트리 풀 (GL 4.3 + ARB_shader_draw_parameters, 풀 셰이더가 링크돼야 사용)
+	if (useGeometryPool && geometryPoolSupported()) {
+		poolProgramID = LoadShaders("PoolVertexShader.txt", "PoolFragmentShader.txt", instanceShaderDefines());
+		GLint linked = GL_FALSE;
+		glGetProgramiv(poolProgramID, GL_LINK_STATUS, &linked);
+		geometryPoolReady = linked == GL_TRUE;
+		if (geometryPoolReady) {
+			glUseProgram(poolProgramID);
+			glUniform1i(glGetUniformLocation(poolProgramID, "textureSampler"), 0);
+			glUniform1i(glGetUniformLocation(poolProgramID, "atlasSampler"), 1);
+			glUniform3fv(glGetUniformLocation(poolProgramID, "instancePalette"), INSTANCE_PALETTE_SIZE, &INSTANCE_PALETTE[0][0]);
+		}
+	}
+	printf("Static meshes: %s\n", geometryPoolReady ? "geometry pool + glMultiDrawElementsIndirect" : "per-mesh buffers");
+
 	//1.
 	//Generate VAO
 	GLuint VertexArrayID;
@@ -1035,14 +8281,18 @@ int main(int argc, char **argv)
 	if (!axisVertices.empty()) {
 		glGenBuffers(1, &AxisVertexBuffer);
 		glBindBuffer(GL_ARRAY_BUFFER, AxisVertexBuffer);
-		glBufferData(GL_ARRAY_BUFFER, axisVertices.size() * sizeof(float), &axisVertices[0], GL_STATIC_DRAW);
+		uploadStaticBuffer(GL_ARRAY_BUFFER, &axisVertices[0], axisVertices.size() * sizeof(float));
 		printf("Axis buffer created successfully\n");
 	}
 
 	// Load Cube OBJ file and setup buffers
-	if (loadOBJ("./cube.obj", cubeVertices, cubeIndices, cubeActualColor)) {
+	if (loadMesh("./cube.obj", cubeVertices, cubeIndices, cubeActualColor, nullptr, &cubeSubMeshes)) {
 		printf("Successfully loaded Cube OBJ file\n");
 		printf("Cube: %zu vertices, %zu indices\n", cubeVertices.size(), cubeIndices.size());
+		optimizeMesh("Cube", cubeVertices, cubeIndices, cubeSubMeshes);
+		buildMeshlets(cubeVertices, cubeIndices, cubeSubMeshes, cubeMeshlets);
+		printf("Cube: %zu meshlets, uploaded ACMR %.3f\n", cubeMeshlets.size(), measureVertexCache(cubeIndices, cubeVertices.size() / 5).acmr);
+		buildMeshLODs(cubeVertices, cubeIndices, cubeSubMeshes, cubeActualColor, cubeLODs);
 		
 		// 첫 몇 개 정점 출력
 		printf("First few vertices: ");
@@ -1051,19 +8301,19 @@ int main(int argc, char **argv)
 		}
 		printf("\n");
 		
-		// 정점 버퍼 생성
-		glGenBuffers(1, &CubeVertexBuffer);
-		glBindBuffer(GL_ARRAY_BUFFER, CubeVertexBuffer);
-		glBufferData(GL_ARRAY_BUFFER, cubeVertices.size() * sizeof(float), &cubeVertices[0],
-			GL_STATIC_DRAW);
-
-		// 인덱스 버퍼 생성
-		glGenBuffers(1, &CubeIndexBuffer);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, CubeIndexBuffer);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, cubeIndices.size() * sizeof(unsigned int),
-			&cubeIndices[0], GL_STATIC_DRAW);
-		printf("Cube buffers created successfully\n");
-		
+		if (geometryPoolReady) {
+			// 풀에 이어 붙이기 (Piggy까지 모은 뒤 한 번에 업로드)
+			addMeshToPool(geometryPool, "Cube", cubeVertices, cubeIndices, cubePoolMesh);
+		} else {
+			// 정점 버퍼 생성 (meshVertexFormat으로 양자화)
+			uploadVertexBuffer("Cube", cubeVertices, CubeVertexBuffer, cubeVertexLayout);
+
+			// 인덱스 버퍼 생성
+			glGenBuffers(1, &CubeIndexBuffer);
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, CubeIndexBuffer);
+			uploadStaticBuffer(GL_ELEMENT_ARRAY_BUFFER, &cubeIndices[0], cubeIndices.size() * sizeof(unsigned int));
+			printf("Cube buffers created successfully\n");
+		}
 		// Cube 바운딩 박스 생성 및 저장
 		calculateBoundingBox(cubeVertices, cubeMinBound, cubeMaxBound);
 		createBoundingBoxLines(cubeMinBound, cubeMaxBound, cubeBBoxVertices);
@@ -1071,7 +8321,7 @@ int main(int argc, char **argv)
 		if (!cubeBBoxVertices.empty()) {
 			glGenBuffers(1, &CubeBBoxVertexBuffer);
 			glBindBuffer(GL_ARRAY_BUFFER, CubeBBoxVertexBuffer);
-			glBufferData(GL_ARRAY_BUFFER, cubeBBoxVertices.size() * sizeof(float), &cubeBBoxVertices[0], GL_STATIC_DRAW);
+			uploadStaticBuffer(GL_ARRAY_BUFFER, &cubeBBoxVertices[0], cubeBBoxVertices.size() * sizeof(float));
 			printf("Cube bounding box buffer created\n");
 		}
 	}
@@ -1080,49 +8330,123 @@ int main(int argc, char **argv)
 	}
 
 	// Load Piggy OBJ file and setup buffers
-	if (loadOBJ("./PiggyBank.obj", piggyVertices, piggyIndices, piggyActualColor)) {
+	// 메모리에 다 올리기 힘든 크기면 페이지 단위로 바로 GPU 버퍼에 올림 (최종 배열 / 전체 중복 제거 테이블 없이)
+	// 스트리밍이 실패하면 (메모리 상한 초과 등) 전체를 메모리에 올리는 loadMesh로 다시 시도하지 않음: 이미 올린 페이지를 지우고 실패로 처리
+	bool piggyStreamed = false, piggyStreamFailed = false;
+	if (fileSizeOf("./PiggyBank.obj") > (long long)streamingThresholdBytes) {
+		OBJStreamSettings streamSettings;
+		OBJStreamStats streamStats;
+		piggyStreamed = streamOBJ("./PiggyBank.obj", streamSettings, uploadMeshPage, &piggyStreamedMesh, piggyActualColor, streamStats);
+		if (piggyStreamed) {
+			piggyMinBound = streamStats.minBound;
+			piggyMaxBound = streamStats.maxBound;
+		} else {
+			printf("Streaming Piggy OBJ failed after %zu pages, not falling back to in-memory loading\n", piggyStreamedMesh.indexCounts.size());
+			deleteStreamedMesh(piggyStreamedMesh);
+			piggyStreamFailed = true;
+		}
+	}
+
+	bool piggyLoaded = piggyStreamed ||
+	                   (!piggyStreamFailed && loadMesh("./PiggyBank.obj", piggyVertices, piggyIndices, piggyActualColor, nullptr, &piggySubMeshes));
+	if (piggyLoaded) {
 		printf("Successfully loaded Piggy OBJ file\n");
 		printf("Piggy: %zu vertices, %zu indices\n", piggyVertices.size(), piggyIndices.size());
 		
-		// 정점 버퍼 생성
-		glGenBuffers(1, &PiggyVertexBuffer);
-		glBindBuffer(GL_ARRAY_BUFFER, PiggyVertexBuffer);
-		glBufferData(GL_ARRAY_BUFFER, piggyVertices.size() * sizeof(float), &piggyVertices[0],
-			GL_STATIC_DRAW);
-
-		// 인덱스 버퍼 생성
-		glGenBuffers(1, &PiggyIndexBuffer);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, PiggyIndexBuffer);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, piggyIndices.size() * sizeof(unsigned int),
-			&piggyIndices[0], GL_STATIC_DRAW);
-		printf("Piggy buffers created successfully\n");
+		if (!piggyStreamed) {
+			optimizeMesh("Piggy", piggyVertices, piggyIndices, piggySubMeshes);
+			buildMeshlets(piggyVertices, piggyIndices, piggySubMeshes, piggyMeshlets);
+			printf("Piggy: %zu meshlets, uploaded ACMR %.3f\n", piggyMeshlets.size(), measureVertexCache(piggyIndices, piggyVertices.size() / 5).acmr);
+			buildMeshLODs(piggyVertices, piggyIndices, piggySubMeshes, piggyActualColor, piggyLODs);
+			for (size_t i = 0; i < piggyLODs.size(); i++)
+				printf("Piggy LOD %zu: %zu triangles, error %.4f\n", i, piggyLODs[i].triangleCount, piggyLODs[i].error);
+
+			if (geometryPoolReady) {
+				addMeshToPool(geometryPool, "Piggy", piggyVertices, piggyIndices, piggyPoolMesh);
+			} else {
+				// 정점 버퍼 생성 (meshVertexFormat으로 양자화)
+				uploadVertexBuffer("Piggy", piggyVertices, PiggyVertexBuffer, piggyVertexLayout);
+
+				// 인덱스 버퍼 생성
+				glGenBuffers(1, &PiggyIndexBuffer);
+				glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, PiggyIndexBuffer);
+				uploadStaticBuffer(GL_ELEMENT_ARRAY_BUFFER, &piggyIndices[0], piggyIndices.size() * sizeof(unsigned int));
+				printf("Piggy buffers created successfully\n");
+			}
+
+			// Piggy 바운딩 박스 계산
+			calculateBoundingBox(piggyVertices, piggyMinBound, piggyMaxBound);
+		}
 		
+		// 인스턴싱 데모 격자 (LOD 체인이 있어야 LOD별로 묶을 수 있음)
+		if (!piggyStreamed && piggyInstanceCount > 0) {
+			float extent = createInstanceGrid(piggyInstanceCount, piggyMinBound, piggyMaxBound, piggyInstances, piggyInstanceBounds, piggyInstanceBoxes);
+			buildOccluderMesh(piggyVertices, piggyIndices, piggySubMeshes, piggyLODs, piggyOcclusion.occluder);
+			printf("Piggy occluder: %zu triangles\n", piggyOcclusion.occluder.indices.size() / 3);
+			sceneFarPlane = max(sceneFarPlane, 2.0f * extent);
+			glGenBuffers(1, &PiggyInstanceBuffer);
+			glBindBuffer(GL_ARRAY_BUFFER, PiggyInstanceBuffer);
+			glBufferData(GL_ARRAY_BUFFER, piggyInstances.size() * sizeof(InstanceData), NULL, GL_STREAM_DRAW);
+			printf("Piggy instances: %zu (%.1f MB instance buffer)\n", piggyInstances.size(),
+			       piggyInstances.size() * sizeof(InstanceData) / (1024.0 * 1024.0));
+		}
+
 		// Piggy 바운딩 박스 생성 및 저장
-		calculateBoundingBox(piggyVertices, piggyMinBound, piggyMaxBound);
 		createBoundingBoxLines(piggyMinBound, piggyMaxBound, piggyBBoxVertices);
 		
 		if (!piggyBBoxVertices.empty()) {
 			glGenBuffers(1, &PiggyBBoxVertexBuffer);
 			glBindBuffer(GL_ARRAY_BUFFER, PiggyBBoxVertexBuffer);
-			glBufferData(GL_ARRAY_BUFFER, piggyBBoxVertices.size() * sizeof(float), &piggyBBoxVertices[0], GL_STATIC_DRAW);
+			uploadStaticBuffer(GL_ARRAY_BUFFER, &piggyBBoxVertices[0], piggyBBoxVertices.size() * sizeof(float));
 			printf("Piggy bounding box buffer created\n");
 		}
-		
-		// Piggy 텍스처 로딩
-		piggyTextureID = loadTexture("./PiggyBankUVTex.png");
-		if (piggyTextureID == 0) {
-			printf("Failed to load Piggy texture, using default color\n");
-		}
 	}
 	else {
 		printf("Failed to load Piggy OBJ file\n");
 	}
 
+	// 텍스처 로딩은 두 모델의 MTL을 다 읽은 뒤: 작은 map_Kd 여러 개는 텍스처 배열 아틀라스 하나로, 나머지는 재질마다
+	// (미리 못 찾은 map_Kd도 후보에 더함. 이미 비동기 디코드를 시작한 것은 빼서 두 번 디코드하지 않음)
+	if (useTextureAtlas) {
+		vector<string> texturePaths;
+		for (map<string, Material>::iterator it = materials.begin(); it != materials.end(); ++it)
+			if (!it->second.texture_map.empty() && asyncTextures.find(it->second.texture_map) == asyncTextures.end() &&
+			    find(texturePaths.begin(), texturePaths.end(), it->second.texture_map) == texturePaths.end())
+				texturePaths.push_back(it->second.texture_map);
+		planTextureAtlas(textureAtlas, texturePaths);
+		buildTextureAtlas(textureAtlas, loaderThreadCount());
+	}
+	loadSubMeshTextures(cubeSubMeshes);
+	for (size_t i = 0; i < cubeLODs.size(); i++) loadSubMeshTextures(cubeLODs[i].submeshes);
+
+	if (piggyLoaded) {
+		// Piggy 텍스처 로딩 (MTL의 map_Kd 우선, 없으면 기본 텍스처 파일). piggyTextureID는 map_Kd가 없는 재질용이라 아틀라스가 아닌 것만
+		loadSubMeshTextures(piggySubMeshes);
+		for (size_t i = 0; i < piggyLODs.size(); i++) loadSubMeshTextures(piggyLODs[i].submeshes);
+		for (size_t i = 0; i < piggySubMeshes.size() && piggyTextureID == 0; i++)
+			if (piggySubMeshes[i].atlasLayer < 0) piggyTextureID = piggySubMeshes[i].textureID;
+		if (piggyTextureID == 0)
+			piggyTextureID = loadTextureCached("./PiggyBankUVTex.png");
+		if (piggyTextureID == 0) {
+			printf("Failed to load Piggy texture, using default color\n");
+		}
+	}
+
+	// 모은 정적 메시를 풀 버퍼 하나씩으로 업로드
+	if (geometryPoolReady) uploadGeometryPool(geometryPool);
+
 	//3. 
-	programID = LoadShaders("VertexShader.txt", "FragmentShader.txt");
+	programID = LoadShaders("VertexShader.txt", "FragmentShader.txt", instanceShaderDefines());
 	glUseProgram(programID);
+	glUniform1i(glGetUniformLocation(programID, "atlasSampler"), 1); // textureSampler(0)와 다른 unit이어야 함
+
+	if (stagingRing.mapped)
+		printf("Staging ring: %zu uploads, %.2f MB staged, %zu fallbacks (ring busy)\n", stagingRing.uploads, stagingRing.stagedBytes / (1024.0 * 1024.0),
+			stagingRing.fallbacks);
 
 	glutDisplayFunc(renderScene);
+	glutReshapeFunc(reshape);
+	if (asyncTexturesPending()) glutIdleFunc(asyncTextureIdle); // 디코드 중인 텍스처가 끝나면 올리고 다시 그림
 	
 	glutKeyboardFunc(keyboard);  // 키보드 콜백
 	glutMouseFunc(mouse);        // 마우스 클릭 콜백
@@ -1140,6 +8464,11 @@ int main(int argc, char **argv)
 	glDeleteBuffers(1, &AxisVertexBuffer);
 	glDeleteBuffers(1, &CubeBBoxVertexBuffer);
 	glDeleteBuffers(1, &PiggyBBoxVertexBuffer);
+	glDeleteBuffers(1, &PiggyInstanceBuffer);
+	deleteGeometryPool(geometryPool);
+	deleteStreamedMesh(piggyStreamedMesh);
+	if (textureAtlas.textureID) glDeleteTextures(1, &textureAtlas.textureID);
+	if (stagingRing.buffer) glDeleteBuffers(1, &stagingRing.buffer);
 
 	glDeleteVertexArrays(1, &VertexArrayID);
 	